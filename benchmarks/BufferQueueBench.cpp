@@ -0,0 +1,217 @@
+#include <include/BufferQueue.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// End-to-end BufferQueue benchmark: N producer processes, each with its own named queue
+// (the ring is single-producer), and M consumer processes that attach by name and read
+// every queue. Sweeps message sizes and queue capacities and reports delivered msgs/s,
+// GB/s, drops and the p50/p99/p999 of the latency stamped into each message.
+// Run it before and after touching SharedBufferQueue/BufferQueue.
+// Usage: BufferQueueBench [producers] [consumers] [messages_per_producer] [pin] [backpressure]
+//   pin           pins every process to its own core (round robin over the online cores)
+//   backpressure  producers wait for the slowest consumer instead of lapping it
+
+static int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void* sharedMap(size_t size) {
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? nullptr : memory;
+}
+
+static void pinTo(unsigned index) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % std::max(1u, std::thread::hardware_concurrency()), &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+// Log-linear latency histogram (32 buckets per power of two, ~3% resolution), small and
+// mergeable so consumers can fill it in shared memory.
+struct Histogram {
+    static constexpr unsigned SUB_BITS = 5;
+    static constexpr size_t BUCKETS = 64 << SUB_BITS;
+    uint64_t m_arrCounts[BUCKETS];
+
+    static size_t bucket(uint64_t value) {
+        if (value < (1u << SUB_BITS)) return value;
+        const unsigned shift = 63 - __builtin_clzll(value) - SUB_BITS;
+        return ((shift + 1) << SUB_BITS) + ((value >> shift) & ((1u << SUB_BITS) - 1));
+    }
+    static uint64_t lowerBound(size_t index) {
+        if (index < (1u << SUB_BITS)) return index;
+        const unsigned shift = (index >> SUB_BITS) - 1;
+        return ((1ull << SUB_BITS) + (index & ((1u << SUB_BITS) - 1))) << shift;
+    }
+
+    void add(uint64_t value) { m_arrCounts[bucket(value)]++; }
+    void merge(const Histogram& other) {
+        for (size_t i = 0; i < BUCKETS; i++) m_arrCounts[i] += other.m_arrCounts[i];
+    }
+    uint64_t percentile(double p) const {
+        uint64_t total = 0;
+        for (uint64_t count : m_arrCounts) total += count;
+        const uint64_t rank = static_cast<uint64_t>(total * p);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += m_arrCounts[i];
+            if (seen > rank) return lowerBound(i);
+        }
+        return 0;
+    }
+};
+
+struct ConsumerResult {
+    uint64_t m_uReceived;
+    uint64_t m_uBytes;
+    uint64_t m_uDropped;
+    Histogram m_hLatency;
+};
+
+struct Control {
+    std::atomic<unsigned> m_atuReady;
+    std::atomic<unsigned> m_atuProducersDone;
+    std::atomic<bool> m_atbStart;
+};
+
+struct Options {
+    unsigned m_uProducers;
+    unsigned m_uConsumers;
+    uint64_t m_uMessages;
+    bool m_bPin;
+    bool m_bBackpressure;
+};
+
+static std::string queueName(unsigned producer) {
+    return "/voxel_bqbench_" + std::to_string(getpid()) + "_" + std::to_string(producer);
+}
+
+static void produce(const Options& options, Control* control, const std::string& name, size_t capacity, size_t size) {
+    std::string queueNameCopy = name, err;
+    BufferQueue queue(capacity, queueNameCopy, err);
+    std::vector<char> message(size, 'x');
+    control->m_atuReady.fetch_add(1);
+    while (!control->m_atbStart.load()) sched_yield();
+
+    for (uint64_t i = 0; i < options.m_uMessages; i++) {
+        const int64_t sent = nowNs();
+        std::memcpy(message.data(), &sent, sizeof(sent));
+        if (options.m_bBackpressure) queue.write(message.data(), size, WAIT_FOREVER);
+        else queue.write(message.data(), size);
+    }
+    control->m_atuProducersDone.fetch_add(1);
+}
+
+static void consume(const Options& options, Control* control, std::vector<std::string> names, size_t capacity, ConsumerResult* result) {
+    std::string err;
+    std::vector<std::unique_ptr<BufferQueue>> queues;
+    std::vector<char> message;
+    for (std::string& name : names) {
+        queues.push_back(std::make_unique<BufferQueue>(capacity, name, err));
+        // The first read takes a consumer slot, so backpressure sees us from the start.
+        queues.back()->try_read(message);
+    }
+    control->m_atuReady.fetch_add(1);
+    while (!control->m_atbStart.load()) sched_yield();
+
+    for (;;) {
+        const bool producersDone = control->m_atuProducersDone.load() == options.m_uProducers;
+        bool any = false;
+        for (auto& queue : queues) {
+            while (queue->try_read(message)) {
+                int64_t sent;
+                std::memcpy(&sent, message.data(), sizeof(sent));
+                result->m_hLatency.add(nowNs() - sent);
+                result->m_uReceived++;
+                result->m_uBytes += message.size();
+                any = true;
+            }
+        }
+        // Checked before the last pass, so nothing published is missed.
+        if (!any && producersDone) break;
+        if (!any) sched_yield();
+    }
+    for (auto& queue : queues) result->m_uDropped += queue->getDropped();
+}
+
+static void run(const Options& options, size_t capacity, size_t size) {
+    auto* control = new (sharedMap(sizeof(Control))) Control{};
+    auto* results = static_cast<ConsumerResult*>(sharedMap(sizeof(ConsumerResult) * options.m_uConsumers));
+
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<BufferQueue>> queues;
+    std::string err;
+    for (unsigned p = 0; p < options.m_uProducers; p++) {
+        names.push_back(queueName(p));
+        BufferQueue::unlink(names.back());
+        queues.push_back(std::make_unique<BufferQueue>(capacity, names.back(), err));
+    }
+
+    std::vector<pid_t> children;
+    for (unsigned i = 0; i < options.m_uProducers + options.m_uConsumers; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            if (options.m_bPin) pinTo(i);
+            if (i < options.m_uProducers) produce(options, control, names[i], capacity, size);
+            else consume(options, control, names, capacity, &results[i - options.m_uProducers]);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+
+    while (control->m_atuReady.load() != children.size()) usleep(100);
+    const int64_t begin = nowNs();
+    control->m_atbStart.store(true);
+    for (pid_t pid : children) waitpid(pid, nullptr, 0);
+    const double seconds = (nowNs() - begin) / 1e9;
+
+    Histogram latency{};
+    uint64_t received = 0, bytes = 0, dropped = 0;
+    for (unsigned c = 0; c < options.m_uConsumers; c++) {
+        latency.merge(results[c].m_hLatency);
+        received += results[c].m_uReceived;
+        bytes += results[c].m_uBytes;
+        dropped += results[c].m_uDropped;
+    }
+    printf("%8zu %10zu %12.3f %10.3f %10llu %10.2f %10.2f %10.2f\n", size, capacity, received / seconds / 1e6, bytes / seconds / 1e9,
+           (unsigned long long)dropped, latency.percentile(0.5) / 1e3, latency.percentile(0.99) / 1e3, latency.percentile(0.999) / 1e3);
+
+    queues.clear();
+    for (const std::string& name : names) BufferQueue::unlink(name);
+    munmap(control, sizeof(Control));
+    munmap(results, sizeof(ConsumerResult) * options.m_uConsumers);
+}
+
+int main(int argc, char* argv[]) {
+    Options options{ 1, 1, 200000, false, false };
+    if (argc > 1) options.m_uProducers = std::max(1ul, std::stoul(argv[1]));
+    if (argc > 2) options.m_uConsumers = std::max(1ul, std::stoul(argv[2]));
+    if (argc > 3) options.m_uMessages = std::stoull(argv[3]);
+    for (int i = 4; i < argc; i++) {
+        options.m_bPin |= std::strcmp(argv[i], "pin") == 0;
+        options.m_bBackpressure |= std::strcmp(argv[i], "backpressure") == 0;
+    }
+
+    printf("%u producer(s), %u consumer(s), %llu msgs per producer%s%s\n", options.m_uProducers, options.m_uConsumers,
+           (unsigned long long)options.m_uMessages, options.m_bPin ? ", pinned" : "", options.m_bBackpressure ? ", backpressure" : "");
+    printf("%8s %10s %12s %10s %10s %10s %10s %10s\n", "size", "capacity", "Mmsg/s", "GB/s", "dropped", "p50(us)", "p99(us)", "p999(us)");
+    // Sizes include the 8-byte send timestamp.
+    for (size_t capacity : { size_t(1) << 16, size_t(1) << 20 })
+        for (size_t size : { 16, 256, 4096 })
+            if (size <= capacity / 4) run(options, capacity, size);
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include <include/SeqlockRing.hpp>
+#include <include/SharedBufferQueue.hpp>
+#include <include/LockGuard.hpp>
+#include <include/Semaphore.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Cross-process queue benchmark: one producer process, N consumer processes, the
+// lock-free seqlock ring against the previous SpinLock/Semaphore protocol, then the wake-up
+// latency and idle CPU of a blocking (futex) consumer against a busy-polling one.
+// Usage: IPComQueueBench [messages] [consumers] [queue_length]
+
+struct Message {
+    uint64_t m_uSeq;
+    int64_t m_iSentNs;
+    char m_carrPayload[48];
+};
+
+static int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void* sharedMap(size_t size) {
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? nullptr : memory;
+}
+
+// The protocol SharedBufferQueue used before the seqlock ring: a global operation lock
+// around the indexes, a writer lock and a reader count per cell. Cells trail the header
+// so it works across processes.
+class LegacyQueue {
+public:
+    struct Cell {
+        SpinLock m_lWriterLock;
+        Semaphore m_sSem;
+        Message m_mData;
+    };
+    struct Cursor { int64_t m_iRead_idx = 0; };
+
+    static size_t segmentSize(uint32_t length) { return sizeof(LegacyQueue) + sizeof(Cell) * length; }
+    explicit LegacyQueue(uint32_t length) : m_uLength(length) {
+        for (uint32_t i = 0; i < length; i++) new (&cells()[i]) Cell();
+    }
+
+    void write(const Message& message) {
+        for (;;) {
+            Cell& cell = cells()[m_atiWrite_idx % m_uLength];
+            if (cell.m_sSem.isZero()) {
+                LockGuard cellLock(cell.m_lWriterLock);
+                cell.m_mData = message;
+                LockGuard lock(m_lOperationLock);
+                ++m_atiWrite_idx;
+                if (m_atiWrite_idx - m_atiFarthest_Read_idx > (int64_t)m_uLength) m_atiFarthest_Read_idx++;
+                return;
+            }
+            usleep(1000);
+        }
+    }
+
+    bool tryRead(Cursor& cursor, Message& out) {
+        Cell* cell;
+        {
+            LockGuard lock(m_lOperationLock);
+            if (cursor.m_iRead_idx >= m_atiWrite_idx) return false;
+            if (cursor.m_iRead_idx < m_atiFarthest_Read_idx) cursor.m_iRead_idx = m_atiFarthest_Read_idx;
+            cell = &cells()[cursor.m_iRead_idx % m_uLength];
+            cell->m_sSem.increase();
+            if (!cell->m_lWriterLock.tryLock()) {
+                cell->m_sSem.decrease();
+                return false;
+            }
+            cell->m_lWriterLock.unLock();
+            ++cursor.m_iRead_idx;
+        }
+        out = cell->m_mData;
+        cell->m_sSem.decrease();
+        return true;
+    }
+
+    int64_t getWriteIdx() { return m_atiWrite_idx; }
+
+private:
+    Cell* cells() { return reinterpret_cast<Cell*>(this + 1); }
+
+    uint32_t m_uLength;
+    std::atomic<int64_t> m_atiWrite_idx{ 0 };
+    std::atomic<int64_t> m_atiFarthest_Read_idx{ 0 };
+    SpinLock m_lOperationLock;
+};
+
+// Per-consumer results, written by the children into shared memory.
+struct Result {
+    uint64_t m_uReceived;
+    double m_dSeconds;
+    int64_t m_iP50Ns;
+    int64_t m_iP99Ns;
+    int64_t m_iMaxNs;
+};
+
+template <class Queue>
+static void run(const char* name, uint64_t messages, unsigned consumers, uint32_t length) {
+    Queue* queue = new (sharedMap(Queue::segmentSize(length))) Queue(length);
+    Result* results = static_cast<Result*>(sharedMap(sizeof(Result) * consumers));
+    auto* ready = static_cast<std::atomic<unsigned>*>(sharedMap(sizeof(std::atomic<unsigned>)));
+    new (ready) std::atomic<unsigned>(0);
+
+    std::vector<pid_t> children;
+    for (unsigned c = 0; c < consumers; c++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            typename Queue::Cursor cursor;
+            std::vector<int64_t> latencies;
+            latencies.reserve(messages);
+            Message message;
+            ready->fetch_add(1);
+            int64_t begin = 0;
+            uint64_t last = 0;
+            while (last + 1 < messages) {
+                if (!queue->tryRead(cursor, message)) continue;
+                if (begin == 0) begin = nowNs();
+                latencies.push_back(nowNs() - message.m_iSentNs);
+                last = message.m_uSeq;
+            }
+            const int64_t end = nowNs();
+            std::sort(latencies.begin(), latencies.end());
+            results[c] = Result{ latencies.size(), (end - begin) / 1e9,
+                                 latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], latencies.back() };
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+
+    while (ready->load() != consumers) usleep(100);
+    const int64_t begin = nowNs();
+    Message message{};
+    for (uint64_t i = 0; i < messages; i++) {
+        message.m_uSeq = i;
+        message.m_iSentNs = nowNs();
+        queue->write(message);
+    }
+    const double writeSeconds = (nowNs() - begin) / 1e9;
+    for (pid_t pid : children) waitpid(pid, nullptr, 0);
+
+    printf("\n%s: %llu msgs, %u consumer(s), queue %u, producer %.2f Mmsg/s\n", name,
+           (unsigned long long)messages, consumers, length, messages / writeSeconds / 1e6);
+    printf("%10s %12s %10s %10s %10s %10s\n", "consumer", "Mmsg/s", "received", "p50(us)", "p99(us)", "max(us)");
+    for (unsigned c = 0; c < consumers; c++)
+        printf("%10u %12.3f %10llu %10.2f %10.2f %10.2f\n", c, results[c].m_uReceived / results[c].m_dSeconds / 1e6,
+               (unsigned long long)results[c].m_uReceived, results[c].m_iP50Ns / 1e3, results[c].m_iP99Ns / 1e3, results[c].m_iMaxNs / 1e3);
+
+    munmap(queue, Queue::segmentSize(length));
+    munmap(results, sizeof(Result) * consumers);
+    munmap(ready, sizeof(std::atomic<unsigned>));
+}
+
+// Sparse traffic: one message every 'gapUs', consumer either blocks in wait() or polls.
+static void runWakeup(const char* name, uint64_t messages, unsigned gapUs, bool blocking) {
+    constexpr size_t capacity = 1 << 16;
+    SharedBufferQueue* queue = new (sharedMap(SharedBufferQueue::segmentSize(capacity))) SharedBufferQueue(capacity);
+    Result* result = static_cast<Result*>(sharedMap(sizeof(Result)));
+
+    pid_t consumer = fork();
+    if (consumer == 0) {
+        SharedBufferQueue::Cursor cursor;
+        AdaptiveSpin spin;
+        std::vector<char> message;
+        std::vector<int64_t> latencies;
+        while (latencies.size() < messages) {
+            if (!queue->tryRead(cursor, message)) {
+                if (blocking) queue->wait(cursor, WAIT_FOREVER, spin);
+                continue;
+            }
+            const int64_t received = nowNs();
+            int64_t sent;
+            std::memcpy(&sent, message.data(), sizeof(sent));
+            latencies.push_back(received - sent);
+        }
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        std::sort(latencies.begin(), latencies.end());
+        // m_dSeconds carries the consumer's CPU time here.
+        *result = Result{ latencies.size(), usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6,
+                          latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], latencies.back() };
+        _exit(0);
+    }
+
+    const int64_t begin = nowNs();
+    for (uint64_t i = 0; i < messages; i++) {
+        usleep(gapUs);
+        const int64_t sent = nowNs();
+        queue->write(&sent, sizeof(sent));
+    }
+    waitpid(consumer, nullptr, 0);
+    const double wall = (nowNs() - begin) / 1e9;
+
+    printf("%-24s %10.2f %10.2f %10.2f %11.1f%%\n", name, result->m_iP50Ns / 1e3, result->m_iP99Ns / 1e3,
+           result->m_iMaxNs / 1e3, 100.0 * result->m_dSeconds / wall);
+    munmap(queue, SharedBufferQueue::segmentSize(capacity));
+    munmap(result, sizeof(Result));
+}
+
+int main(int argc, char* argv[]) {
+    const uint64_t messages = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    const unsigned consumers = argc > 2 ? std::stoul(argv[2]) : 1;
+    const uint32_t length = argc > 3 ? std::stoul(argv[3]) : 1024;
+
+    run<SeqlockRing<Message>>("seqlock ring", messages, consumers, length);
+    run<LegacyQueue>("legacy SpinLock queue", messages, consumers, length);
+
+    printf("\nwake-up, one message every 200us\n%-24s %10s %10s %10s %12s\n", "consumer", "p50(us)", "p99(us)", "max(us)", "consumer CPU");
+    runWakeup("blocking (spin + futex)", 5000, 200, true);
+    runWakeup("busy poll", 5000, 200, false);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <include/Matrix.hpp>
+#include <include/ThreadPool.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+// Strong-scaling benchmark for the parallel Matrix kernels: fixed problem sizes,
+// growing thread counts. Usage: MatrixScalingBench [max_threads] [gemm_size]
+
+using namespace voxel;
+using Clock = std::chrono::steady_clock;
+
+template <class Fn>
+static double medianMs(Fn &&fn, int repetitions)
+{
+	std::vector<double> samples;
+	for (int r = 0; r < repetitions; r++)
+	{
+		auto begin = Clock::now();
+		fn();
+		samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+	}
+	std::sort(samples.begin(), samples.end());
+	return samples[samples.size() / 2];
+}
+
+template <class Fn>
+static void scale(const char *name, unsigned maxThreads, int repetitions, Fn &&fn)
+{
+	printf("\n%-28s %8s %12s %9s %11s\n", name, "threads", "median(ms)", "speedup", "efficiency");
+	double serial = 0;
+	for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		ThreadPool::instance().resize(threads - 1);
+		fn(); // Warm-up.
+		const double ms = medianMs(fn, repetitions);
+		if (threads == 1)
+			serial = ms;
+		printf("%-28s %8u %12.3f %8.2fx %10.1f%%\n", "", threads, ms, serial / ms, 100.0 * serial / ms / threads);
+		if (threads < maxThreads && threads * 2 > maxThreads)
+			threads = maxThreads / 2;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const unsigned maxThreads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+	const unsigned n = argc > 2 ? std::stoul(argv[2]) : 1024;
+	srand(42);
+
+	Matrix<float> a(n, n), b(n, n);
+	a.randomize();
+	b.randomize();
+
+	scale(("dot " + std::to_string(n) + "^3").c_str(), maxThreads, 5, [&]()
+		  { Matrix<float> c = Matrix<float>::dot(a, b); });
+
+	// Layer-shaped GEMV: one sample through a wide fully connected layer.
+	Matrix<float> weights(4 * n, 4 * n), input(4 * n, 1);
+	weights.randomize();
+	input.randomize();
+	scale(("dot layer " + std::to_string(4 * n) + "x" + std::to_string(4 * n) + " * x").c_str(), maxThreads, 21, [&]()
+		  { Matrix<float> c = Matrix<float>::dot(weights, input); });
+
+	Matrix<float> big(4 * n, 4 * n);
+	big.randomize();
+	scale(("transpose " + std::to_string(4 * n) + "^2").c_str(), maxThreads, 11, [&]()
+		  { Matrix<float> t = Matrix<float>::transpose(big); });
+
+	scale(("hadamard " + std::to_string(4 * n) + "^2").c_str(), maxThreads, 11, [&]()
+		  { Matrix<float> h = Matrix<float>::hadamardProduct(big, weights); });
+
+	// XOR-sized problem: must stay serial and never pay for the pool.
+	Matrix<float> xorWeights(4, 2);
+	std::vector<float> xorInput = {1.0f, 0.0f};
+	scale("dot 4x2 (below threshold)", maxThreads, 101, [&]()
+		  {
+			for (int i = 0; i < 10000; i++)
+			{
+				Matrix<float> c = Matrix<float>::dot(xorWeights, xorInput);
+			} });
+
+	ThreadPool::instance().resize(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	return 0;
+}
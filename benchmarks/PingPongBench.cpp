@@ -0,0 +1,146 @@
+#include <include/SharedBufferQueue.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Cross-core cache line benchmark for the shared queue layout:
+//  - ping-pong of one line between two pinned processes (the cost every shared write pays),
+//  - two processes bumping private counters placed 8, 64 and 128 bytes apart (false sharing),
+//  - round trips through a pair of SharedBufferQueues, which is what the header layout buys.
+// Usage: PingPongBench [core_a] [core_b] [iterations]
+
+static int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void* sharedMap(size_t size) {
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? nullptr : memory;
+}
+
+static void pinTo(unsigned core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+// Busy wait that still lets the other side run when both are pinned to the same core.
+static void backOff(uint32_t& spins) {
+    if (++spins % 256 == 0) sched_yield();
+    else cpuRelax();
+}
+
+// Runs 'child' pinned to core_b in a forked process while 'parent' runs pinned to core_a.
+template <class Parent, class Child>
+static void onTwoCores(unsigned coreA, unsigned coreB, Parent&& parent, Child&& child) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        pinTo(coreB);
+        child();
+        _exit(0);
+    }
+    pinTo(coreA);
+    parent();
+    waitpid(pid, nullptr, 0);
+}
+
+static void percentiles(const char* name, std::vector<int64_t>& samples) {
+    std::sort(samples.begin(), samples.end());
+    printf("%-28s %10.0f %10.0f %10.0f\n", name, double(samples[samples.size() / 2]), double(samples[samples.size() * 99 / 100]),
+           double(samples[samples.size() * 999 / 1000]));
+}
+
+static void lineRoundTrip(unsigned coreA, unsigned coreB, uint64_t iterations) {
+    auto* word = new (sharedMap(sizeof(std::atomic<uint64_t>))) std::atomic<uint64_t>(0);
+    std::vector<int64_t> samples;
+    samples.reserve(iterations);
+    onTwoCores(coreA, coreB, [&]() {
+        for (uint64_t i = 0; i < iterations; i++) {
+            const int64_t begin = nowNs();
+            word->store(2 * i + 1, std::memory_order_release);
+            uint32_t spins = 0;
+            while (word->load(std::memory_order_acquire) != 2 * i + 2) backOff(spins);
+            samples.push_back(nowNs() - begin);
+        }
+    }, [&]() {
+        for (uint64_t i = 0; i < iterations; i++) {
+            uint32_t spins = 0;
+            while (word->load(std::memory_order_acquire) != 2 * i + 1) backOff(spins);
+            word->store(2 * i + 2, std::memory_order_release);
+        }
+    });
+    percentiles("cache line round trip", samples);
+    munmap(word, sizeof(std::atomic<uint64_t>));
+}
+
+static void falseSharing(unsigned coreA, unsigned coreB, uint64_t iterations) {
+    printf("\n%-28s %14s\n", "counters apart (bytes)", "ns/increment");
+    for (size_t distance : { sizeof(uint64_t), CACHE_LINE_SIZE, FALSE_SHARING_SIZE }) {
+        char* block = static_cast<char*>(sharedMap(2 * FALSE_SHARING_SIZE));
+        auto* first = new (block) std::atomic<uint64_t>(0);
+        auto* second = new (block + distance) std::atomic<uint64_t>(0);
+        auto bump = [iterations](std::atomic<uint64_t>* counter) {
+            for (uint64_t i = 0; i < iterations; i++) counter->fetch_add(1, std::memory_order_relaxed);
+        };
+        const int64_t begin = nowNs();
+        onTwoCores(coreA, coreB, [&]() { bump(first); }, [&]() { bump(second); });
+        printf("%-28zu %14.2f\n", distance, double(nowNs() - begin) / iterations);
+        munmap(block, 2 * FALSE_SHARING_SIZE);
+    }
+}
+
+static void queueRoundTrip(unsigned coreA, unsigned coreB, uint64_t iterations) {
+    constexpr size_t capacity = 1 << 16;
+    auto* ping = new (sharedMap(SharedBufferQueue::segmentSize(capacity))) SharedBufferQueue(capacity);
+    auto* pong = new (sharedMap(SharedBufferQueue::segmentSize(capacity))) SharedBufferQueue(capacity);
+    std::vector<int64_t> samples;
+    samples.reserve(iterations);
+    char payload[64] = {};
+
+    onTwoCores(coreA, coreB, [&]() {
+        SharedBufferQueue::Cursor cursor;
+        std::vector<char> message;
+        for (uint64_t i = 0; i < iterations; i++) {
+            const int64_t begin = nowNs();
+            ping->write(payload, sizeof(payload));
+            uint32_t spins = 0;
+            while (!pong->tryRead(cursor, message)) backOff(spins);
+            samples.push_back(nowNs() - begin);
+        }
+    }, [&]() {
+        SharedBufferQueue::Cursor cursor;
+        std::vector<char> message;
+        for (uint64_t i = 0; i < iterations; i++) {
+            uint32_t spins = 0;
+            while (!ping->tryRead(cursor, message)) backOff(spins);
+            pong->write(message.data(), message.size());
+        }
+    });
+    percentiles("queue round trip (64 B)", samples);
+    munmap(ping, SharedBufferQueue::segmentSize(capacity));
+    munmap(pong, SharedBufferQueue::segmentSize(capacity));
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned coreA = argc > 1 ? std::stoul(argv[1]) : 0;
+    const unsigned coreB = argc > 2 ? std::stoul(argv[2]) : 1;
+    const uint64_t iterations = argc > 3 ? std::stoull(argv[3]) : 100000;
+
+    printf("cores %u and %u, %llu iterations\n%-28s %10s %10s %10s\n", coreA, coreB, (unsigned long long)iterations,
+           "", "p50(ns)", "p99(ns)", "p999(ns)");
+    lineRoundTrip(coreA, coreB, iterations);
+    queueRoundTrip(coreA, coreB, iterations);
+    falseSharing(coreA, coreB, iterations * 100);
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <include/InferencePipeline.hpp>
+#include <include/BufferQueue.hpp>
+#include <include/SerialPort.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Receive-to-prediction latency of InferencePipeline, a sensor streaming length prefixed
+// float records at a steady rate over a pty into a SerialPort, for a few batching settings:
+// bigger batches cost the first record of each some waiting, and save the network calls.
+// Usage: PipelineBench [records] [records_per_second] [features]
+
+static void run(size_t records, size_t rate, size_t features, size_t maxBatch, std::chrono::microseconds window) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("pty");
+        return;
+    }
+    const std::string device = ptsname(master);
+    const std::string name = PortUtils::shMemPortNameParser(device, "/");
+    BufferQueue::unlink(name);
+
+    constexpr size_t OUTPUTS = 4;
+    std::vector<uint_fast64_t> hidden = { 64, 32 };
+    DeepNeuralNetwork<float> network(features, hidden, OUTPUTS);
+    std::string stream;
+    std::vector<float> record(features);
+    for (size_t i = 0; i < records; i++) {
+        for (size_t j = 0; j < features; j++) record[j] = float((i + j) % 97) / 97.0f - 0.5f;
+        stream += char((features * sizeof(float)) >> 8);
+        stream += char(features * sizeof(float));
+        stream.append(reinterpret_cast<const char*>(record.data()), features * sizeof(float));
+    }
+
+    InferencePipeline::Stats stats;
+    size_t predicted = 0;
+    {
+        SerialPort port(device);
+        if (port.connect() != 0) {
+            close(master);
+            return;
+        }
+        InferencePipeline::Options options;
+        options.maxBatch = maxBatch;
+        options.batchWindow = window;
+        InferencePipeline pipeline(network, features, OUTPUTS, InferencePipeline::fromSerialPort(port), options);
+        if (!pipeline.start()) {
+            close(master);
+            return;
+        }
+        // Bursts of 16 records, each sent when it is due.
+        std::thread sensor([&]() {
+            const size_t size = 2 + features * sizeof(float), burst = 16;
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t sent = 0; sent < records; sent += burst) {
+                std::this_thread::sleep_until(start + std::chrono::nanoseconds(int64_t(sent * 1000000000ull / rate)));
+                const size_t length = std::min(burst, records - sent) * size;
+                for (size_t at = sent * size; at < sent * size + length;) {
+                    const ssize_t n = ::write(master, stream.data() + at, sent * size + length - at);
+                    if (n <= 0) return;
+                    at += size_t(n);
+                }
+            }
+        });
+        InferencePipeline::Prediction prediction;
+        while (predicted < records && pipeline.nextPrediction(prediction, std::chrono::seconds(2))) predicted++;
+        sensor.join();
+        pipeline.stop();
+        stats = pipeline.getStats();
+    }
+    BufferQueue::unlink(name);
+    close(master);
+
+    std::printf("batch %3zu window %4lld us: %zu predicted, %6.1f per batch, latency p50 %7.1f us  p99 %7.1f us  max %7.1f us,"
+                " %llu dropped\n",
+                maxBatch, (long long)window.count(), predicted,
+                stats.batches != 0 ? double(stats.predictions) / double(stats.batches) : 0.0,
+                double(stats.latencyP50.count()) / 1e3, double(stats.latencyP99.count()) / 1e3,
+                double(stats.latencyMax.count()) / 1e3, (unsigned long long)stats.dropped);
+}
+
+int main(int argc, char** argv) {
+    const size_t records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const size_t rate = std::max<size_t>(1, argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000);
+    const size_t features = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 16;
+
+    std::printf("%zu records of %zu features over a pty, %zu per second\n", records, features, rate);
+    run(records, rate, features, 1, std::chrono::microseconds(0));
+    run(records, rate, features, 32, std::chrono::microseconds(0));
+    run(records, rate, features, 32, std::chrono::microseconds(200));
+    run(records, rate, features, 256, std::chrono::microseconds(0));
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include <include/EventLoop.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+// epoll against io_uring for the IOPorts stream path, over a pty pair standing in for a
+// high-baud device:
+//  - throughput: the far end streams into the pty, the loop reads it (bytes per callback
+//    shows how much each wake-up carries, CPU time what the I/O costs),
+//  - latency: one byte round trips, echoed by the loop through EventLoop::write().
+// Usage: SerialIoBench [megabytes] [round_trips]
+
+static int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int64_t cpuNs() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000LL +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000LL;
+}
+
+static bool openPty(int& master, int& slave) {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return false;
+    slave = open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    termios tty;
+    if (slave < 0 || tcgetattr(slave, &tty) != 0) return false;
+    cfmakeraw(&tty);
+    return tcsetattr(slave, TCSANOW, &tty) == 0;
+}
+
+static const char* name(EventLoop::Backend backend) {
+    return backend == EventLoop::Backend::IO_URING ? "io_uring" : "epoll";
+}
+
+static void throughput(EventLoop::Backend backend, size_t bytes) {
+    EventLoop loop(backend);
+    int master, slave;
+    if (!openPty(master, slave)) {
+        perror("pty");
+        return;
+    }
+
+    std::atomic<size_t> received{ 0 };
+    std::atomic<size_t> callbacks{ 0 };
+    loop.addReader(slave, [&](std::span<const char> data) {
+        received.fetch_add(data.size(), std::memory_order_relaxed);
+        callbacks.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    std::vector<char> chunk(4096, 'x');
+    const int64_t cpu = cpuNs(), start = nowNs();
+    for (size_t sent = 0; sent < bytes;) {
+        const ssize_t n = ::write(master, chunk.data(), std::min(chunk.size(), bytes - sent));
+        if (n > 0) sent += size_t(n);
+    }
+    while (received.load() < bytes) std::this_thread::yield();
+    const double seconds = double(nowNs() - start) / 1e9;
+    const double cpuSeconds = double(cpuNs() - cpu) / 1e9;
+
+    std::printf("%-9s %8.1f MB/s  %7zu callbacks  %6.0f B/callback  %6.1f ns CPU/byte\n", name(loop.getBackend()),
+                double(bytes) / seconds / 1e6, callbacks.load(), double(bytes) / double(callbacks.load()),
+                cpuSeconds * 1e9 / double(bytes));
+    loop.remove(slave);
+    close(slave);
+    close(master);
+}
+
+static void latency(EventLoop::Backend backend, int roundTrips) {
+    EventLoop loop(backend);
+    int master, slave;
+    if (!openPty(master, slave)) {
+        perror("pty");
+        return;
+    }
+    loop.addReader(slave, [&](std::span<const char> data) { loop.write(slave, data); });
+
+    std::vector<int64_t> samples;
+    samples.reserve(size_t(roundTrips));
+    pollfd ready = { master, POLLIN, 0 };
+    char byte = 'p';
+    for (int i = 0; i < roundTrips; i++) {
+        const int64_t start = nowNs();
+        if (::write(master, &byte, 1) != 1) break;
+        if (poll(&ready, 1, 1000) <= 0 || ::read(master, &byte, 1) != 1) break;
+        samples.push_back(nowNs() - start);
+    }
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) { return double(samples[size_t(q * double(samples.size() - 1))]) / 1e3; };
+    std::printf("%-9s round trip p50 %7.1f us  p99 %7.1f us  max %7.1f us\n", name(loop.getBackend()), at(0.5),
+                at(0.99), at(1.0));
+    loop.remove(slave);
+    close(slave);
+    close(master);
+}
+
+int main(int argc, char** argv) {
+    const size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    const int roundTrips = argc > 2 ? std::atoi(argv[2]) : 10000;
+
+    std::printf("pty throughput, %zu MB in 4 KiB writes\n", megabytes);
+    for (EventLoop::Backend backend : { EventLoop::Backend::EPOLL, EventLoop::Backend::IO_URING })
+        throughput(backend, megabytes << 20);
+    std::printf("pty latency, %d one byte round trips\n", roundTrips);
+    for (EventLoop::Backend backend : { EventLoop::Backend::EPOLL, EventLoop::Backend::IO_URING })
+        latency(backend, roundTrips);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <include/SpinLock.hpp>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Lock contention benchmark: 1..N threads, then 1..N processes, hammering one lock that
+// guards a short critical section in shared memory. Compares the spin/backoff/futex
+// SpinLock, the same lock parking straight away, and the previous usleep(50) lock.
+// Usage: SpinLockBench [max_workers] [ops_per_worker]
+
+static int64_t nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// The lock SpinLock replaced: test_and_set, sleep 50us on failure.
+class SleepingLock {
+public:
+    void lock() { while (m_afFlag.test_and_set(std::memory_order_acquire)) usleep(50); }
+    void unLock() { m_afFlag.clear(std::memory_order_release); }
+private:
+    std::atomic_flag m_afFlag = ATOMIC_FLAG_INIT;
+};
+
+// Shared between the workers; the counters are what the lock protects.
+template <class Lock>
+struct Shared {
+    Lock m_lLock;
+    uint64_t m_arrCounters[8];
+};
+
+template <class Lock>
+static void work(Shared<Lock>* shared, uint64_t ops) {
+    for (uint64_t i = 0; i < ops; i++) {
+        shared->m_lLock.lock();
+        for (uint64_t& counter : shared->m_arrCounters) counter++;
+        shared->m_lLock.unLock();
+    }
+}
+
+template <class Lock, class... Args>
+static double run(unsigned workers, bool processes, uint64_t ops, Args... args) {
+    void* memory = mmap(nullptr, sizeof(Shared<Lock>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    auto* shared = new (memory) Shared<Lock>{ Lock(args...), {} };
+
+    const int64_t begin = nowNs();
+    if (processes) {
+        std::vector<pid_t> children;
+        for (unsigned w = 0; w < workers; w++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                work(shared, ops);
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        for (pid_t pid : children) waitpid(pid, nullptr, 0);
+    } else {
+        std::vector<std::thread> threads;
+        for (unsigned w = 0; w < workers; w++) threads.emplace_back([&]() { work(shared, ops); });
+        for (auto& thread : threads) thread.join();
+    }
+    const double seconds = (nowNs() - begin) / 1e9;
+
+    if (shared->m_arrCounters[0] != workers * ops) printf("lost updates: %llu\n", (unsigned long long)shared->m_arrCounters[0]);
+    munmap(memory, sizeof(Shared<Lock>));
+    return workers * ops / seconds / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned maxWorkers = argc > 1 ? std::stoul(argv[1]) : std::max(2u, std::thread::hardware_concurrency());
+    const uint64_t ops = argc > 2 ? std::stoull(argv[2]) : 200000;
+
+    for (bool processes : { false, true }) {
+        printf("\n%-10s %16s %16s %16s   (Mlock/s)\n", processes ? "processes" : "threads", "spin+futex", "futex only", "usleep(50)");
+        for (unsigned workers = 1; workers <= maxWorkers; workers *= 2) {
+            printf("%-10u %16.3f %16.3f %16.3f\n", workers, run<SpinLock>(workers, processes, ops),
+                   run<SpinLock>(workers, processes, ops, 0u), run<SleepingLock>(workers, processes, ops));
+            if (workers < maxWorkers && workers * 2 > maxWorkers) workers = maxWorkers / 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <include/Matrix.hpp>
+#include <include/Transpose.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+// Transpose benchmark: the previous column-strided loop against the cache-oblivious
+// SIMD kernel, the pooled Matrix::transpose and the in-place square path.
+// Usage: TransposeBench [n] (default 4096, i.e. 4K x 4K floats).
+
+using namespace voxel;
+using Clock = std::chrono::steady_clock;
+
+template <class Fn>
+static void report(const char *name, uint_fast64_t n, int repetitions, Fn &&fn)
+{
+	fn(); // Warm-up, faults the pages in.
+	std::vector<double> samples;
+	for (int r = 0; r < repetitions; r++)
+	{
+		auto begin = Clock::now();
+		fn();
+		samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+	}
+	std::sort(samples.begin(), samples.end());
+	const double ms = samples[samples.size() / 2];
+	// One read and one write per element.
+	const double gbs = 2.0 * n * n * sizeof(float) / (ms * 1e6);
+	printf("%-34s %10.2f ms %8.2f GB/s\n", name, ms, gbs);
+}
+
+int main(int argc, char *argv[])
+{
+	const uint_fast64_t n = argc > 1 ? std::stoul(argv[1]) : 4096;
+	printf("transpose %llux%llu float, SIMD micro tile %llux%llu, %u threads\n\n",
+		   (unsigned long long)n, (unsigned long long)n,
+		   (unsigned long long)Transposer<float>::MICRO, (unsigned long long)Transposer<float>::MICRO,
+		   ThreadPool::instance().getThreadCount());
+
+	Matrix<float> source(n, n), target(n, n);
+	source.randomize();
+
+	report("naive (column-strided writes)", n, 5, [&]()
+		   { Transposer<float>::naive(target, source); });
+	report("cache-oblivious SIMD (1 thread)", n, 5, [&]()
+		   { Transposer<float>::blocked(target, source); });
+	report("Matrix::transpose (pooled)", n, 5, [&]()
+		   { Matrix<float>::transpose(target, source); });
+	report("Matrix::transpose() in place", n, 5, [&]()
+		   { source.transpose(); });
+	return 0;
+}
@@ -35,7 +35,11 @@ public:
 protected:
 	AbstractPort(){};
 	virtual ~AbstractPort(){};
+
+	// Shared byte ring the port publishes received data to, and the most read per call.
+	static constexpr size_t BUFFER_QUEUE_CAPACITY = 1 << 20;
+	static constexpr size_t READ_CHUNK_SIZE = 4096;
 	BufferQueue* m_bqBuffer;
 
 	std::string m_sError;
-};
\ No newline at end of file
+};
\ No newline at end of file
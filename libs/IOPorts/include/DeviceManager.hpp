@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../platform.hpp"
+#include <include/SerialPort.hpp>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Device manager class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+// Keeps track of the serial devices in a directory (/dev) as they come and go: inotify on the
+// directory wakes the event loop, nothing polls. Matching devices are opened, configured and
+// probed in the background (SerialPort::connectAsync), and every step is published to the
+// subscribers, on the I/O thread (EventLoop::instance(), the one the ports run on too). A
+// directory of symlinks to ptys makes a fake device tree.
+LIBEXP class DeviceManager {
+public:
+    struct Event {
+        enum Type {
+            ADDED,   // Appeared (or was there at start()).
+            READY,   // Opened, configured and probed; getPort() has it.
+            FAILED,  // Could not be opened; retried when its permissions change (udev).
+            REMOVED  // Gone, its port closed.
+        };
+        Type type;
+        std::string path;
+    };
+    using EventCallback = std::function<void(const Event& event)>;
+
+    struct Options {
+        std::string directory = "/dev";
+        // Devices are the entries starting with one of these.
+        std::vector<std::string> prefixes = { "ttyUSB", "ttyACM" };
+        // Without it devices are only reported, not opened.
+        bool autoOpen = true;
+        PortUtils::Serial::PortConfig config;
+        SerialPort::ReadinessProbe probe;
+    };
+
+    explicit DeviceManager(Options options);
+    // Must not run on the loop's thread: it waits for ports still being brought up.
+    ~DeviceManager();
+    DeviceManager(const DeviceManager&) = delete;
+    DeviceManager& operator=(const DeviceManager&) = delete;
+
+    // Starts watching, then reports the devices already there as ADDED.
+    bool start(std::string& err_message);
+
+    // Returns an id for unsubscribe().
+    int subscribe(EventCallback callback);
+    void unsubscribe(int id);
+
+    std::vector<std::string> getDevices() const;
+    // The open port of a READY device, nullptr otherwise.
+    std::shared_ptr<SerialPort> getPort(const std::string& path) const;
+
+private:
+    enum class State { PRESENT, OPENING, READY, FAILED };
+    struct Device {
+        State state = State::PRESENT;
+        std::shared_ptr<SerialPort> port;
+        // Tells a bring-up finishing late from one of the device plugged in again.
+        uint64_t generation = 0;
+    };
+
+    // I/O thread.
+    void onNotify();
+    void scan();
+    void added(const std::string& name);
+    void removed(const std::string& name);
+    void open(const std::string& path);
+    void connected(const std::string& path, uint64_t generation, bool ready);
+    void publish(Event::Type type, const std::string& path);
+    bool matches(const std::string& name) const;
+
+    static constexpr int FD_UNAVAILABLE = -1;
+
+    Options m_oOptions;
+    int m_iNotifyFd = FD_UNAVAILABLE;
+    bool m_bStopping = false;
+    uint64_t m_uGeneration = 0;
+
+    mutable std::mutex m_mxLock;
+    std::unordered_map<std::string, Device> m_umDevices;
+    std::unordered_map<int, std::shared_ptr<EventCallback>> m_umSubscribers;
+    int m_iNextSubscriber = 0;
+    // Bring-ups in flight, waited for on destruction.
+    std::list<std::future<void>> m_lPending;
+};
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// End Device manager class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "../platform.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class IoUring;
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Event loop class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+// Single-threaded reactor: one epoll instance multiplexing any number of file descriptors
+// and timers, dispatched on a dedicated I/O thread. Callbacks run on that thread one at a
+// time, so they need no locking among themselves but must not block. Every port of the
+// process shares instance(), instead of a process per port.
+//
+// Streams registered with addReader()/write() go through io_uring when the kernel has it:
+// one multishot read per fd fills provided buffers with no syscall per chunk, and writes
+// queued during an iteration are handed over in a single submission at its end. Without
+// io_uring (or for an fd that refuses multishot reads) the same calls run on epoll.
+LIBEXP class EventLoop {
+public:
+    // Same values as the epoll flags, so they pass straight through.
+    enum Events : uint32_t {
+        READABLE = 0x001,
+        WRITABLE = 0x004,
+        ERROR = 0x008,
+        HANGUP = 0x010,
+        // Report readiness once per change; the callback must drain the fd until EAGAIN.
+        EDGE_TRIGGERED = 1u << 31
+    };
+
+    enum class Backend { EPOLL, IO_URING };
+
+    using IoCallback = std::function<void(uint32_t events)>;
+    // Bytes read from a stream; valid only during the call. Empty on end of file or error,
+    // after which the fd is not read again.
+    using ReadCallback = std::function<void(std::span<const char> data)>;
+    // Where the epoll path reads the next chunk to, so bytes can land where their reader
+    // keeps them; an empty span means the loop's own buffer.
+    using ReadBuffer = std::function<std::span<char>()>;
+    using Task = std::function<void()>;
+
+    // Starts the I/O thread. IO_URING falls back to EPOLL when the kernel refuses it.
+    explicit EventLoop(Backend backend = Backend::IO_URING);
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // The process-wide loop serving every port.
+    static EventLoop& instance();
+
+    // Watches 'fd' for 'events' until remove(). False if epoll refused it.
+    bool add(int fd, uint32_t events, IoCallback callback);
+    bool modify(int fd, uint32_t events);
+    // Once this returns the callback is not running and will not run again, so the caller
+    // may close the fd or destroy whatever the callback uses. Queued writes not yet handed
+    // to the kernel are dropped.
+    void remove(int fd);
+
+    // Reads the non-blocking stream 'fd' as data arrives until remove().
+    bool addReader(int fd, ReadCallback callback);
+    // Same, reading into 'buffer' when the fd is served by epoll; 'callback' then sees a
+    // view of it. io_uring fills its own provided buffers, so there it is not called.
+    bool addReader(int fd, ReadCallback callback, ReadBuffer buffer);
+    // Queues a copy of 'data' for 'fd', in order with earlier writes. Writes queued before
+    // the I/O thread gets to them are coalesced into one. The fd must not be watched with
+    // add(); one seen first here is registered for writing only.
+    void write(int fd, std::span<const char> data);
+
+    Backend getBackend() const { return m_pRing ? Backend::IO_URING : Backend::EPOLL; }
+
+    // Calls 'callback' on the I/O thread after 'delay', then every 'delay' if 'repeat'.
+    // Returns an id for cancelTimer(), -1 on failure.
+    int addTimer(std::chrono::nanoseconds delay, Task callback, bool repeat = true);
+    void cancelTimer(int timer);
+
+    // Runs 'task' on the I/O thread, soon.
+    void post(Task task);
+    // Runs 'task' on the I/O thread and waits for it (runs it inline on the I/O thread).
+    void runSync(Task task);
+
+    bool isLoopThread() const { return std::this_thread::get_id() == m_tThread.get_id(); }
+
+private:
+    // A stream served by addReader()/write(), owned by the I/O thread but for 'outbound'.
+    struct Channel {
+        int fd;
+        ReadCallback onRead;
+        ReadBuffer readBuffer;
+        // Appended by write() under m_mxLock, swapped into 'inflight' by the I/O thread.
+        std::vector<char> outbound;
+        std::vector<char> inflight;
+        size_t written = 0;
+        // io_uring requests in flight, 0 when none.
+        uint64_t readToken = 0;
+        uint64_t writeToken = 0;
+        bool polled = false;
+        bool dirty = false;
+        bool closed = false;
+    };
+
+    void run();
+    void wakeUp();
+    void runPosted();
+
+    // Under m_mxLock.
+    std::shared_ptr<Channel> channelOf(int fd);
+    // Takes what write() queued since the last batch. False if there was nothing.
+    bool nextBatch(Channel& channel);
+    void endOfStream(Channel& channel);
+    void flushWrites();
+
+    // epoll path.
+    bool watch(const std::shared_ptr<Channel>& channel);
+    void onChannelEvent(Channel& channel, uint32_t events);
+    void drain(Channel& channel);
+    void writeNow(Channel& channel);
+
+    // io_uring path.
+    bool armRead(const std::shared_ptr<Channel>& channel);
+    void startWrite(const std::shared_ptr<Channel>& channel);
+    bool submitWrite(const std::shared_ptr<Channel>& channel);
+    void onCompletions();
+    void onReadStopped(const std::shared_ptr<Channel>& channel, int result);
+    void onWritten(const std::shared_ptr<Channel>& channel, int result);
+
+    static constexpr int FD_UNAVAILABLE = -1;
+    static constexpr unsigned MAX_EVENTS = 64;
+    static constexpr unsigned RING_ENTRIES = 256;
+    static constexpr uint16_t RING_BUFFERS = 64;
+    static constexpr uint32_t RING_BUFFER_SIZE = 4096;
+
+    int m_iEpollFd = FD_UNAVAILABLE;
+    // eventfd that interrupts epoll_wait for posted tasks and shutdown.
+    int m_iWakeFd = FD_UNAVAILABLE;
+
+    std::mutex m_mxLock;
+    std::unordered_map<int, std::shared_ptr<IoCallback>> m_umHandlers;
+    std::vector<Task> m_vPosted;
+    std::unordered_map<int, std::shared_ptr<Channel>> m_umChannels;
+    std::vector<std::shared_ptr<Channel>> m_vDirty;
+
+    // I/O thread only.
+    std::unique_ptr<IoUring> m_pRing;
+    struct Request { std::shared_ptr<Channel> channel; bool write; };
+    std::unordered_map<uint64_t, Request> m_umRequests;
+    uint64_t m_uNextToken = 1;
+    std::vector<char> m_vScratch;
+
+    std::atomic<bool> m_atbStop{ false };
+    std::thread m_tThread;
+};
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// End Event loop class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
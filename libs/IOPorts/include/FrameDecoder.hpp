@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../platform.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Frame decoder class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+// Streaming decoder turning the bytes of a serial link into frames, for delimiter, length
+// prefix, COBS and SLIP framing. Frames that arrive whole inside one feed() are handed out
+// as views of the caller's bytes; only a frame split across feeds is copied, into a buffer
+// sized once from maxFrameSize. Delimiters are found with memchr, which libc vectorizes.
+// No allocation after construction.
+LIBEXP class FrameDecoder {
+public:
+    struct Framing {
+        enum Kind { DELIMITER, LENGTH_PREFIX, COBS, SLIP };
+        Kind kind = DELIMITER;
+        // DELIMITER: ends every frame, not part of it.
+        char delimiter = '\n';
+        // LENGTH_PREFIX: 1, 2, 4 or 8 byte payload length ahead of every frame.
+        uint8_t lengthBytes = 2;
+        bool bigEndian = true;
+        // Longer frames are dropped and counted as errors.
+        size_t maxFrameSize = 4096;
+    };
+
+    // The view is valid only during the call.
+    using FrameCallback = std::function<void(std::string_view frame)>;
+
+    // An invalid framing is logged and leaves a decoder that takes nothing, see isValid().
+    FrameDecoder(Framing framing, FrameCallback onFrame);
+
+    bool isValid() const { return m_bValid; }
+    // Decodes what 'data' completes, keeps the rest for the next call. Returns frames emitted;
+    // an invalid decoder emits none and counts every feed as an error.
+    size_t feed(std::span<const char> data);
+    // Forgets a partial frame, e.g. after the port was flushed.
+    void reset();
+
+    uint64_t getFrames() const { return m_uFrames; }
+    // Oversized or malformed frames.
+    uint64_t getErrors() const { return m_uErrors; }
+
+    // Encoders for the sending side, appending one framed 'payload' to 'out'.
+    static void encodeCobs(std::span<const char> payload, std::vector<char>& out);
+    static void encodeSlip(std::span<const char> payload, std::vector<char>& out);
+
+    static constexpr char SLIP_END = char(0xC0);
+    static constexpr char SLIP_ESC = char(0xDB);
+    static constexpr char SLIP_ESC_END = char(0xDC);
+    static constexpr char SLIP_ESC_ESC = char(0xDD);
+
+private:
+    void feedDelimited(const char* at, const char* end);
+    void feedLengthPrefixed(const char* at, const char* end);
+    // Keeps bytes of a frame that continues in a later feed().
+    void keep(const char* at, size_t length);
+    // Unframes a delimited frame (COBS, SLIP) and emits it.
+    void emitDelimited(std::string_view frame);
+    void emit(std::string_view frame);
+    size_t readLength(const char* header) const;
+
+    Framing m_fFraming;
+    FrameCallback m_fnOnFrame;
+    bool m_bValid = true;
+
+    // The partial frame, and scratch space for COBS/SLIP decoding.
+    std::vector<char> m_vPending;
+    size_t m_uPending = 0;
+    std::vector<char> m_vDecoded;
+    // Dropping an oversized frame until its end.
+    bool m_bDiscarding = false;
+    size_t m_uSkip = 0;
+    size_t m_uExpected = 0;
+
+    uint64_t m_uFrames = 0;
+    uint64_t m_uErrors = 0;
+};
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// End Frame decoder class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
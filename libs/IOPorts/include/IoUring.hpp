@@ -0,0 +1,95 @@
+#pragma once
+
+#include "../platform.hpp"
+
+#ifdef LINUX_PLATFORM
+
+#include <atomic>
+#include <cstdint>
+#include <linux/io_uring.h>
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// io_uring class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+// Minimal io_uring on the raw syscalls (no liburing): submission and completion rings plus
+// one provided buffer ring the kernel picks read buffers from. Not thread safe, the owner
+// (the event loop thread) is the only one to touch it.
+LIBEXP class IoUring {
+public:
+    // Multishot read, kernel 6.7+, missing from older uapi headers.
+    static constexpr uint8_t OP_READ_MULTISHOT = 49;
+
+    // 'entries' submission slots, and 'buffers' provided buffers of 'bufferSize' bytes.
+    IoUring(unsigned entries, uint16_t buffers, uint32_t bufferSize);
+    ~IoUring();
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // False if the kernel (or a seccomp policy) refused the ring or the buffer ring.
+    bool isValid() const { return m_bValid; }
+    // Readable while completions are waiting, so the ring can sit in an epoll set.
+    int getFd() const { return m_iFd; }
+
+    // Next free submission entry, zeroed; submits what is queued first if the ring is full.
+    io_uring_sqe* getSqe();
+    // Hands queued entries to the kernel in one syscall. Returns how many, or -errno.
+    int submit();
+    bool hasPending() const { return m_uQueued != 0; }
+
+    // Calls 'onCompletion(const io_uring_cqe&)' for every completion waiting, returns the count.
+    template <class OnCompletion>
+    unsigned reap(OnCompletion&& onCompletion) {
+        unsigned head = *m_puCqHead;
+        const unsigned tail = __atomic_load_n(m_puCqTail, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        for (; head != tail; head++, count++) onCompletion(m_pCqes[head & *m_puCqMask]);
+        __atomic_store_n(m_puCqHead, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    // Provided buffers, group BUFFER_GROUP: reads with IOSQE_BUFFER_SELECT land in one of
+    // them and the completion names it; hand it back with recycleBuffer() once consumed.
+    static constexpr uint16_t BUFFER_GROUP = 0;
+    const char* getBuffer(uint16_t id) const { return m_pBuffers + size_t(id) * m_uBufferSize; }
+    void recycleBuffer(uint16_t id);
+
+private:
+    bool setup(unsigned entries);
+    bool setupBufferRing(uint16_t buffers, uint32_t bufferSize);
+
+    int m_iFd = -1;
+    bool m_bValid = false;
+
+    // Submission ring.
+    void* m_pSqRing = nullptr;
+    size_t m_uSqRingSize = 0;
+    unsigned* m_puSqHead = nullptr;
+    unsigned* m_puSqTail = nullptr;
+    unsigned* m_puSqMask = nullptr;
+    unsigned* m_puSqArray = nullptr;
+    io_uring_sqe* m_pSqes = nullptr;
+    size_t m_uSqesSize = 0;
+    unsigned m_uQueued = 0;
+
+    // Completion ring (may share the submission ring mapping).
+    void* m_pCqRing = nullptr;
+    size_t m_uCqRingSize = 0;
+    unsigned* m_puCqHead = nullptr;
+    unsigned* m_puCqTail = nullptr;
+    unsigned* m_puCqMask = nullptr;
+    io_uring_cqe* m_pCqes = nullptr;
+
+    // Provided buffer ring and the buffers behind it.
+    io_uring_buf_ring* m_pBufRing = nullptr;
+    size_t m_uBufRingSize = 0;
+    char* m_pBuffers = nullptr;
+    uint16_t m_uBufferCount = 0;
+    uint32_t m_uBufferSize = 0;
+};
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// End io_uring class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+#endif // LINUX_PLATFORM.
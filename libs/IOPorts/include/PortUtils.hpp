@@ -1,5 +1,6 @@
 #pragma once
 #include "../platform.hpp"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <filesystem>
@@ -35,22 +36,22 @@ namespace PortUtils {
 	#elif defined(LINUX_PLATFORM) // LINUX_PLATFORM.
 
 	constexpr std::string_view PortTypeName[] = {
-    	[PortType::SERIAL] = "ttyUSB"
+    	"ttyUSB" // PortType::SERIAL
 	};
 
 	////////////////////////////////////////////////
 	#elif defined(APPLE_PLATFORM) // APPLE_PLATFORM	
 
 	constexpr std::string_view PortTypeName[] = {
-    	[PortType::SERIAL] = "cu",
+    	"cu", // PortType::SERIAL
 	};
 
 	#endif
 
-	LIBEXP static std::vector<std::string> getAvailablePortsName(PortType type, std::string deviceDirPath) {
+	LIBEXP inline std::vector<std::string> getAvailablePortsName(PortType type, std::string deviceDirPath) {
 	    std::vector<std::string> ports;
 	    for(const auto& entry : std::filesystem::directory_iterator(deviceDirPath)) {
-	        if(entry.path().string().find(PortTypeName[PortType::SERIAL]) != std::string::npos) {
+	        if(entry.path().string().find(PortTypeName[type]) != std::string::npos) {
 	            ports.push_back(entry.path());
 	            LINFO("%s", entry.path().string().c_str());
 	        }
@@ -59,7 +60,7 @@ namespace PortUtils {
 	}
 
 	// Generate an appropriate name for the shared memory id based of the com port name.
-	LIBEXP static std::string shMemPortNameParser(std::string name, std::string delimiter) {
+	LIBEXP inline std::string shMemPortNameParser(std::string name, std::string delimiter) {
 		std::vector<char*> vec;
     	char* token = strtok(const_cast<char*>(name.c_str()), delimiter.c_str());
     	while (token != nullptr) {
@@ -78,37 +79,93 @@ namespace PortUtils {
 			SS_Stopped
 		} SerialState;
 
-		LIBEXP typedef enum BaudRate {
-    		B50 = 50,
-    		B75 = 75,
-    		B110 = 110,
-    		B134 = 134,
-    		B150 = 150,
-    		B200 = 200,
-    		B300 = 300,
-    		B600 = 600,
-    		B1200 = 1200,
-    		B1800 = 1800,
-    		B2400 = 2400,
-    		B4800 = 4800,
-    		B9600 = 9600,
-    		B19200 = 19200,
-    		B38400 = 38400
+		// Values are the rate in baud. Any other rate the UART can generate may be cast in,
+		// it is set through termios2/BOTHER on Linux.
+		LIBEXP typedef enum BaudRate : uint32_t {
+    		BAUD_50 = 50,
+    		BAUD_75 = 75,
+    		BAUD_110 = 110,
+    		BAUD_134 = 134,
+    		BAUD_150 = 150,
+    		BAUD_200 = 200,
+    		BAUD_300 = 300,
+    		BAUD_600 = 600,
+    		BAUD_1200 = 1200,
+    		BAUD_1800 = 1800,
+    		BAUD_2400 = 2400,
+    		BAUD_4800 = 4800,
+    		BAUD_9600 = 9600,
+    		BAUD_19200 = 19200,
+    		BAUD_38400 = 38400,
+    		BAUD_57600 = 57600,
+    		BAUD_115200 = 115200,
+    		BAUD_230400 = 230400,
+    		BAUD_460800 = 460800,
+    		BAUD_500000 = 500000,
+    		BAUD_576000 = 576000,
+    		BAUD_921600 = 921600,
+    		BAUD_1000000 = 1000000,
+    		BAUD_1152000 = 1152000,
+    		BAUD_1500000 = 1500000,
+    		BAUD_2000000 = 2000000,
+    		BAUD_2500000 = 2500000,
+    		BAUD_3000000 = 3000000,
+    		BAUD_3500000 = 3500000,
+    		BAUD_4000000 = 4000000,
+    		// Former names, kept for existing code; they collide with the <termios.h> macros.
+    		B50 = BAUD_50,
+    		B75 = BAUD_75,
+    		B110 = BAUD_110,
+    		B134 = BAUD_134,
+    		B150 = BAUD_150,
+    		B200 = BAUD_200,
+    		B300 = BAUD_300,
+    		B600 = BAUD_600,
+    		B1200 = BAUD_1200,
+    		B1800 = BAUD_1800,
+    		B2400 = BAUD_2400,
+    		B4800 = BAUD_4800,
+    		B9600 = BAUD_9600,
+    		B19200 = BAUD_19200,
+    		B38400 = BAUD_38400
 		} SerialBaudRate;
 
-		LIBEXP constexpr SerialBaudRate DEFAULT_COM_RATE = BaudRate::B9600;
+		// Scoped: <windows.h> and <termios.h> define PARITY_* macros. Each backend maps these
+		// to its own constants.
+		enum class Parity : uint8_t {
+			None,
+			Odd,
+			Even,
+			Mark,
+			Space
+		};
+		typedef Parity SerialParity;
+
+		LIBEXP constexpr SerialBaudRate DEFAULT_COM_RATE = BaudRate::BAUD_9600;
 		LIBEXP constexpr int DEFAULT_COM_BITS = 8;
-		LIBEXP constexpr int DEFAULT_PARITY_BITS = 1;
+		LIBEXP constexpr int DEFAULT_STOP_BITS = 1;
+		LIBEXP constexpr SerialParity DEFAULT_PARITY = Parity::None;
 
 		LIBEXP typedef struct PortConfig {
 			SerialBaudRate nComRate = DEFAULT_COM_RATE;
+			// 5 to 8.
 			unsigned nComBits = DEFAULT_COM_BITS;
-			unsigned byStopBits;
-			unsigned parity = DEFAULT_PARITY_BITS;
+			// 1 or 2.
+			unsigned byStopBits = DEFAULT_STOP_BITS;
+			SerialParity parity = DEFAULT_PARITY;
 		} SerialPortConfig;
+
+		#if defined(LINUX_PLATFORM) || defined(APPLE_PLATFORM)
+		// Puts the open tty 'fd' in raw mode with 'config': data bits, parity, stop bits, and any
+		// speed, standard or not (termios2/BOTHER on Linux, IOSSIOSPEED on MacOS, which has no
+		// mark or space parity). False with 'err_message' set on failure.
+		LIBEXP bool applyConfig(int fd, const PortConfig& config, std::string& err_message);
+		// The speed the driver actually set, in baud (it may round custom rates). 0 on error.
+		LIBEXP uint32_t getBaudRate(int fd);
+		#endif
 	};
 }
 
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 // End port utility namespace.
-//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
\ No newline at end of file
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
\ No newline at end of file
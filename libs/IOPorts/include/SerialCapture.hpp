@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../platform.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Capture file: a header, then one record per chunk received, packed:
+//     header  "IOCAPT01"          8 bytes
+//     record  timestamp (ns)      8 bytes, CLOCK_MONOTONIC_RAW, little endian
+//             length              4 bytes, little endian
+//             data                'length' bytes
+namespace SerialCapture {
+    inline constexpr char MAGIC[8] = { 'I', 'O', 'C', 'A', 'P', 'T', '0', '1' };
+    inline constexpr size_t RECORD_HEADER_SIZE = 12;
+
+    struct Record {
+        uint64_t timestamp;
+        std::span<const char> data;
+    };
+
+    // Nanoseconds on CLOCK_MONOTONIC_RAW: no NTP slewing between two records.
+    LIBEXP uint64_t now();
+}
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Capture writer class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+// Appends records to a capture file without ever waiting on the disk: record() copies into
+// a buffer that a thread of its own writes out in large batches, swapping buffers so both
+// sides keep going. Made to be called from the I/O thread.
+LIBEXP class CaptureWriter {
+public:
+    CaptureWriter(const std::string& path, std::string& err_message);
+    // Writes out everything recorded.
+    ~CaptureWriter();
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // False if the record was dropped: not open, or the disk is MAX_BACKLOG behind.
+    bool record(std::span<const char> data, uint64_t timestamp = SerialCapture::now());
+    // Waits until everything recorded so far is in the file.
+    void flush();
+
+    bool isOpen() const { return m_iFd != FD_UNAVAILABLE; }
+    uint64_t getRecords() const;
+    uint64_t getDropped() const;
+
+private:
+    void run();
+
+    static constexpr int FD_UNAVAILABLE = -1;
+    // A batch worth a write(); the writer wakes up for less only every FLUSH_INTERVAL.
+    static constexpr size_t BATCH_SIZE = 256 * 1024;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{ 100 };
+    static constexpr size_t MAX_BACKLOG = 64 * 1024 * 1024;
+
+    int m_iFd = FD_UNAVAILABLE;
+    std::thread m_tWriter;
+    mutable std::mutex m_mxLock;
+    std::condition_variable m_cvWork;
+    std::condition_variable m_cvWritten;
+    // record() fills one, the writer thread empties the other.
+    std::vector<char> m_vFilling;
+    std::vector<char> m_vWriting;
+    // Bytes recorded and written so far, for flush().
+    uint64_t m_uRecorded = 0;
+    uint64_t m_uWritten = 0;
+    uint64_t m_uRecords = 0;
+    uint64_t m_uDropped = 0;
+    bool m_bFlushing = false;
+    bool m_bStopping = false;
+};
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// End Capture writer class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Capture reader class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+// Walks a capture file mapped in memory; records point into the mapping. replay() plays it
+// back into a file descriptor, typically the master side of a pty that the code under test
+// opens as its serial port.
+LIBEXP class CaptureReader {
+public:
+    CaptureReader(const std::string& path, std::string& err_message);
+    ~CaptureReader();
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    // The next record, false at the end. A record cut short (capture killed) ends the file.
+    bool next(SerialCapture::Record& record);
+    void rewind() { m_uOffset = sizeof(SerialCapture::MAGIC); }
+
+    // Writes the records from the current one on into 'fd', keeping their original spacing
+    // divided by 'speed' (1 real time, 100 a hundred times faster, 0 back to back). Returns
+    // the bytes written, -1 on error.
+    int64_t replay(int fd, double speed, std::string& err_message);
+
+    bool isOpen() const { return m_pData != nullptr; }
+
+private:
+    const char* m_pData = nullptr;
+    size_t m_uSize = 0;
+    size_t m_uOffset = 0;
+};
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// End Capture reader class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
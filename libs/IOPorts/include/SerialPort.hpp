@@ -2,7 +2,11 @@
 
 #include <include/AbstractPort.hpp>
 #include <include/PortUtils.hpp>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
+#include <span>
 #include <../platform.hpp>
 class SerialPort : public AbstractPort {
 public:
@@ -12,8 +16,32 @@ public:
 
     LIBEXP void flush() override;
     LIBEXP int connect() override;
+
+    // Device specific check that the port is ready once connected, see the factories below.
+    using ReadinessProbe = std::function<bool(SerialPort& port)>;
+    // connect() and then 'probe' on a thread of their own, so ports come up in parallel; leave
+    // the port alone until the future is ready. It holds 0 once the port is ready, -1 if either
+    // step failed, in which case the port is closed again.
+    LIBEXP std::future<int> connectAsync(ReadinessProbe probe = nullptr);
+    // Pulses DTR low, which resets many boards. Fails on ports without modem lines.
+    LIBEXP static ReadinessProbe dtrReset(std::chrono::milliseconds pulse);
+    // Waits for 'banner' (consuming everything up to it), at most 'timeout'.
+    LIBEXP static ReadinessProbe waitForBanner(std::string banner, std::chrono::milliseconds timeout);
+    LIBEXP bool setDtr(bool on);
     LIBEXP std::string read() override;
     LIBEXP std::size_t write(void *data, std::size_t data_len) override;
+
+    // Received bytes, for one reading thread. read() moves up to out.size() of them into
+    // 'out', waiting up to 'timeout' for the first; readUntil() fills 'line' with the bytes
+    // up to and including 'delimiter', and leaves them unread if that does not arrive in time.
+    LIBEXP std::size_t read(std::span<char> out, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
+    LIBEXP bool readUntil(std::string& line, char delimiter, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
+    // Bytes lost because the reader fell a whole inbound buffer behind.
+    LIBEXP std::size_t getOverruns() const;
+    // Records every chunk received, timestamped, into the capture file 'path' (SerialCapture.hpp)
+    // until stopCapture(); CaptureReader::replay() plays it back. Replaces a running capture.
+    LIBEXP bool startCapture(const std::string& path, std::string& err_message);
+    LIBEXP void stopCapture();
     LIBEXP static std::vector<std::string> getAvailablePorts();
 
 private: 
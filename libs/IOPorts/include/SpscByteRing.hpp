@@ -0,0 +1,165 @@
+#pragma once
+
+#include "../platform.hpp"
+#include <include/Futex.hpp>
+#include <include/SharedMessage.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// SPSC byte ring class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+// Lock-free single-producer / single-consumer byte stream, in process memory. The producer
+// (the I/O thread) never blocks: it copies in what fits. The consumer may sleep on a futex
+// until bytes arrive; the producer only pays for the wake-up when somebody is asleep.
+class SpscByteRing {
+public:
+    static constexpr size_t npos = size_t(-1);
+
+    // 'capacity' is rounded up to a power of two.
+    explicit SpscByteRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        m_uMask = size - 1;
+        m_pData = std::make_unique<char[]>(size);
+    }
+    SpscByteRing(const SpscByteRing&) = delete;
+    SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+    size_t capacity() const { return m_uMask + 1; }
+
+    //###############################################################################################
+    // Producer.
+    //###############################################################################################
+
+    // Copies in as much of 'data' as fits and returns how much that was.
+    size_t write(std::span<const char> data) {
+        const size_t tail = m_atuTail.load(std::memory_order_relaxed);
+        const size_t head = m_atuHead.load(std::memory_order_acquire);
+        const size_t length = std::min(data.size(), capacity() - (tail - head));
+        copyIn(tail, data.data(), length);
+        // seq_cst pairs with the consumer's store to m_atuWaiting: either it sees the bytes
+        // or we see it asleep.
+        m_atuTail.store(tail + length, std::memory_order_seq_cst);
+        if (length != 0 && m_atuWaiting.load(std::memory_order_seq_cst)) wake();
+        return length;
+    }
+
+    // Wakes a consumer blocked in wait() and makes it return, with or without data (shutdown).
+    void signal() {
+        m_atuSignals.fetch_add(1, std::memory_order_release);
+        wake();
+    }
+
+    // No more bytes will come (hang-up): every wait() from now on returns at once, true while
+    // bytes are left to read. Sticky until reopen().
+    void close() {
+        m_atbClosed.store(true, std::memory_order_release);
+        signal();
+    }
+
+    void reopen() { m_atbClosed.store(false, std::memory_order_release); }
+    bool isClosed() const { return m_atbClosed.load(std::memory_order_acquire); }
+
+    //###############################################################################################
+    // Consumer.
+    //###############################################################################################
+
+    size_t available() const {
+        return m_atuTail.load(std::memory_order_acquire) - m_atuHead.load(std::memory_order_relaxed);
+    }
+
+    // Moves up to out.size() bytes out and returns how many.
+    size_t read(std::span<char> out) {
+        const size_t head = m_atuHead.load(std::memory_order_relaxed);
+        const size_t length = std::min(out.size(), available());
+        copyOut(head, out.data(), length);
+        m_atuHead.store(head + length, std::memory_order_release);
+        return length;
+    }
+
+    // Offset of the first 'delimiter' among the readable bytes from offset 'from' on, npos if
+    // there is none.
+    size_t find(char delimiter, size_t from = 0) const {
+        const size_t head = m_atuHead.load(std::memory_order_relaxed);
+        const size_t length = available();
+        for (size_t offset = from; offset < length;) {
+            // Up to the end of the ring, then from its start.
+            const size_t index = (head + offset) & m_uMask;
+            const size_t chunk = std::min(length - offset, capacity() - index);
+            if (const void* at = std::memchr(m_pData.get() + index, delimiter, chunk))
+                return offset + size_t(static_cast<const char*>(at) - (m_pData.get() + index));
+            offset += chunk;
+        }
+        return npos;
+    }
+
+    // Drops everything readable.
+    void clear() { m_atuHead.store(m_atuTail.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Sleeps until more than 'have' bytes are readable, signal(), close() or 'timeout'. True if
+    // there are.
+    bool wait(size_t have, std::chrono::nanoseconds timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        // Only signal() ends the wait early: a wake for bytes this consumer already took
+        // (its flag was still up from the previous wait) just goes back to sleep.
+        const uint32_t signals = m_atuSignals.load(std::memory_order_acquire);
+        while (available() <= have) {
+            const uint32_t signal = m_atuSignal.load(std::memory_order_acquire);
+            m_atuWaiting.store(1, std::memory_order_seq_cst);
+            if (available() > have || isClosed()) break;
+            std::chrono::nanoseconds left = WAIT_FOREVER;
+            if (timeout.count() >= 0) {
+                left = deadline - std::chrono::steady_clock::now();
+                if (left.count() <= 0) break;
+            }
+            Futex::wait(m_atuSignal, signal, left);
+            if (m_atuSignals.load(std::memory_order_acquire) != signals || isClosed()) break;
+        }
+        m_atuWaiting.store(0, std::memory_order_relaxed);
+        return available() > have;
+    }
+
+private:
+    void wake() {
+        m_atuSignal.fetch_add(1, std::memory_order_release);
+        Futex::wake(m_atuSignal);
+    }
+
+    // Copies to and from the ring at 'position', wrapping around its end.
+    void copyIn(size_t position, const char* bytes, size_t length) {
+        const size_t offset = position & m_uMask;
+        const size_t first = std::min(length, capacity() - offset);
+        std::memcpy(m_pData.get() + offset, bytes, first);
+        std::memcpy(m_pData.get(), bytes + first, length - first);
+    }
+
+    void copyOut(size_t position, char* bytes, size_t length) const {
+        const size_t offset = position & m_uMask;
+        const size_t first = std::min(length, capacity() - offset);
+        std::memcpy(bytes, m_pData.get() + offset, first);
+        std::memcpy(bytes + first, m_pData.get(), length - first);
+    }
+
+    size_t m_uMask = 0;
+    std::unique_ptr<char[]> m_pData;
+
+    // The consumer writes the first line, the producer the second, the producer and
+    // signal() / close() the third.
+    alignas(FALSE_SHARING_SIZE) std::atomic<size_t> m_atuHead{ 0 };
+    std::atomic<uint32_t> m_atuWaiting{ 0 };
+    alignas(FALSE_SHARING_SIZE) std::atomic<size_t> m_atuTail{ 0 };
+    alignas(FALSE_SHARING_SIZE) std::atomic<uint32_t> m_atuSignal{ 0 };
+    std::atomic<uint32_t> m_atuSignals{ 0 };
+    std::atomic<bool> m_atbClosed{ false };
+};
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// End SPSC byte ring class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
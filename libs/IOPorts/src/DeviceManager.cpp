@@ -0,0 +1,225 @@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Device manager Linux implementation (inotify).
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+#include "../platform.hpp"
+
+#ifdef LINUX_PLATFORM
+
+#include <include/DeviceManager.hpp>
+#include <include/EventLoop.hpp>
+#include <include/Logger.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+DeviceManager::DeviceManager(Options options) : m_oOptions(std::move(options)) {}
+
+DeviceManager::~DeviceManager() {
+    EventLoop::instance().runSync([this]() {
+        m_bStopping = true;
+        if (m_iNotifyFd != FD_UNAVAILABLE) EventLoop::instance().remove(m_iNotifyFd);
+    });
+    // Their results are dropped now that m_bStopping is set.
+    for (std::future<void>& pending : m_lPending) pending.wait();
+    if (m_iNotifyFd != FD_UNAVAILABLE) close(m_iNotifyFd);
+    std::lock_guard<std::mutex> lock(m_mxLock);
+    m_umDevices.clear();
+}
+
+bool DeviceManager::start(std::string& err_message) {
+    if (m_iNotifyFd != FD_UNAVAILABLE) return true;
+    m_iNotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_iNotifyFd < 0) {
+        m_iNotifyFd = FD_UNAVAILABLE;
+        err_message = std::string("DeviceManager|inotify: ") + strerror(errno);
+        return false;
+    }
+    // Device nodes come and go as links and nodes created, deleted or renamed in place;
+    // IN_ATTRIB catches udev fixing the permissions of one we could not open yet.
+    const uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_ATTRIB | IN_ONLYDIR;
+    if (inotify_add_watch(m_iNotifyFd, m_oOptions.directory.c_str(), mask) < 0 ||
+        !EventLoop::instance().add(m_iNotifyFd, EventLoop::READABLE, [this](uint32_t) { onNotify(); })) {
+        err_message = "DeviceManager|watch " + m_oOptions.directory + ": " + strerror(errno);
+        close(m_iNotifyFd);
+        m_iNotifyFd = FD_UNAVAILABLE;
+        return false;
+    }
+    // Watching first, so a device showing up during the scan is not missed (added() ignores
+    // the one it already knows).
+    EventLoop::instance().post([this]() { scan(); });
+    return true;
+}
+
+int DeviceManager::subscribe(EventCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mxLock);
+    m_umSubscribers.emplace(m_iNextSubscriber, std::make_shared<EventCallback>(std::move(callback)));
+    return m_iNextSubscriber++;
+}
+
+void DeviceManager::unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(m_mxLock);
+    m_umSubscribers.erase(id);
+}
+
+std::vector<std::string> DeviceManager::getDevices() const {
+    std::lock_guard<std::mutex> lock(m_mxLock);
+    std::vector<std::string> devices;
+    devices.reserve(m_umDevices.size());
+    for (const auto& [path, device] : m_umDevices) devices.push_back(path);
+    return devices;
+}
+
+std::shared_ptr<SerialPort> DeviceManager::getPort(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(m_mxLock);
+    const auto found = m_umDevices.find(path);
+    if (found == m_umDevices.end() || found->second.state != State::READY) return nullptr;
+    return found->second.port;
+}
+
+//###################################################################################################
+// I/O thread.
+//###################################################################################################
+
+void DeviceManager::onNotify() {
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;) {
+        const ssize_t length = read(m_iNotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            if (length < 0 && errno != EAGAIN && errno != EINTR) LERROR("DeviceManager|inotify read: %s", strerror(errno));
+            if (length < 0 && errno == EINTR) continue;
+            return;
+        }
+        for (const char* at = buffer; at < buffer + length;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(at);
+            at += sizeof(struct inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost: the directory itself tells what is there now.
+                LINFO("DeviceManager|inotify queue overflow, rescanning %s.", m_oOptions.directory.c_str());
+                scan();
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                LERROR("DeviceManager|%s is no longer watched.", m_oOptions.directory.c_str());
+                continue;
+            }
+            if (event->len == 0 || !matches(event->name)) continue;
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM)) removed(event->name);
+            else added(event->name);
+        }
+    }
+}
+
+void DeviceManager::scan() {
+    std::error_code error;
+    std::vector<std::string> present;
+    for (const auto& entry : std::filesystem::directory_iterator(m_oOptions.directory, error)) {
+        const std::string name = entry.path().filename().string();
+        if (matches(name)) present.push_back(name);
+    }
+    if (error) LERROR("DeviceManager|scan %s: %s", m_oOptions.directory.c_str(), error.message().c_str());
+
+    // Gone while the queue overflowed.
+    std::vector<std::string> gone;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        for (const auto& [path, device] : m_umDevices) {
+            const std::string name = std::filesystem::path(path).filename().string();
+            if (std::find(present.begin(), present.end(), name) == present.end()) gone.push_back(name);
+        }
+    }
+    for (const std::string& name : gone) removed(name);
+    for (const std::string& name : present) added(name);
+}
+
+void DeviceManager::added(const std::string& name) {
+    if (m_bStopping) return;
+    const std::string path = m_oOptions.directory + "/" + name;
+    std::unique_lock<std::mutex> lock(m_mxLock);
+    const auto [found, inserted] = m_umDevices.try_emplace(path);
+    Device& device = found->second;
+    if (inserted) {
+        device.generation = ++m_uGeneration;
+        lock.unlock();
+        publish(Event::ADDED, path);
+        if (m_oOptions.autoOpen) open(path);
+    } else if (device.state == State::FAILED) {
+        // Changed attributes (or a link replaced): maybe it opens now.
+        lock.unlock();
+        open(path);
+    }
+}
+
+void DeviceManager::removed(const std::string& name) {
+    const std::string path = m_oOptions.directory + "/" + name;
+    std::shared_ptr<SerialPort> port;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        const auto found = m_umDevices.find(path);
+        if (found == m_umDevices.end()) return;
+        port = std::move(found->second.port);
+        m_umDevices.erase(found);
+    }
+    // Closed here unless still being brought up: then by its bring-up, when done.
+    port.reset();
+    publish(Event::REMOVED, path);
+}
+
+void DeviceManager::open(const std::string& path) {
+    // Built without m_mxLock, which getPort() and getDevices() callers wait on: a port sets
+    // up its shared memory queue. Dropped, also unlocked, if the device is busy already.
+    auto port = std::make_shared<SerialPort>(path, m_oOptions.config);
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        const auto found = m_umDevices.find(path);
+        if (found == m_umDevices.end() || found->second.state == State::OPENING || found->second.state == State::READY) return;
+        found->second.state = State::OPENING;
+        found->second.port = port;
+        generation = found->second.generation;
+    }
+    // Only ever touched on the I/O thread, and by the destructor once it is done with it.
+    m_lPending.remove_if([](const std::future<void>& pending) {
+        return pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+    m_lPending.push_back(std::async(std::launch::async,
+        [this, path, generation, port]() {
+            const bool ready = port->connectAsync(m_oOptions.probe).get() == 0;
+            EventLoop::instance().runSync([&]() { connected(path, generation, ready); });
+        }));
+}
+
+void DeviceManager::connected(const std::string& path, uint64_t generation, bool ready) {
+    if (m_bStopping) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        const auto found = m_umDevices.find(path);
+        // Unplugged meanwhile, maybe plugged in again.
+        if (found == m_umDevices.end() || found->second.generation != generation) return;
+        found->second.state = ready ? State::READY : State::FAILED;
+        if (!ready) found->second.port.reset();
+    }
+    publish(ready ? Event::READY : Event::FAILED, path);
+}
+
+void DeviceManager::publish(Event::Type type, const std::string& path) {
+    // Subscribers may (un)subscribe or query from their callback.
+    std::vector<std::shared_ptr<EventCallback>> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        for (const auto& [id, callback] : m_umSubscribers) subscribers.push_back(callback);
+    }
+    const Event event = { type, path };
+    for (const auto& callback : subscribers) (*callback)(event);
+}
+
+bool DeviceManager::matches(const std::string& name) const {
+    for (const std::string& prefix : m_oOptions.prefixes)
+        if (name.compare(0, prefix.size(), prefix) == 0) return true;
+    return false;
+}
+
+#endif // LINUX_PLATFORM.
@@ -0,0 +1,476 @@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Event loop Linux implementation (epoll, timerfd, eventfd, io_uring).
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+#include "../platform.hpp"
+
+#ifdef LINUX_PLATFORM
+
+#include <include/EventLoop.hpp>
+#include <include/IoUring.hpp>
+#include <include/Logger.hpp>
+#include <algorithm>
+#include <future>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+static_assert(uint32_t(EventLoop::READABLE) == EPOLLIN && uint32_t(EventLoop::WRITABLE) == EPOLLOUT &&
+              uint32_t(EventLoop::ERROR) == EPOLLERR && uint32_t(EventLoop::HANGUP) == EPOLLHUP &&
+              uint32_t(EventLoop::EDGE_TRIGGERED) == EPOLLET, "Events mirror the epoll flags.");
+
+//###################################################################################################
+// Construction and shutdown.
+//###################################################################################################
+
+EventLoop::EventLoop(Backend backend) : m_vScratch(RING_BUFFER_SIZE) {
+    m_iEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_iWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_iEpollFd < 0 || m_iWakeFd < 0) {
+        LERROR("EventLoop|epoll/eventfd: %s", strerror(errno));
+        return;
+    }
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = m_iWakeFd;
+    epoll_ctl(m_iEpollFd, EPOLL_CTL_ADD, m_iWakeFd, &event);
+
+    // The ring's fd turns readable with completions, so epoll stays the one place to wait.
+    if (backend == Backend::IO_URING) {
+        auto ring = std::make_unique<IoUring>(RING_ENTRIES, RING_BUFFERS, RING_BUFFER_SIZE);
+        if (ring->isValid() && add(ring->getFd(), READABLE, [this](uint32_t) { onCompletions(); }))
+            m_pRing = std::move(ring);
+        else
+            LINFO("EventLoop|io_uring unavailable, streams use epoll.");
+    }
+    m_tThread = std::thread(&EventLoop::run, this);
+}
+
+EventLoop::~EventLoop() {
+    m_atbStop.store(true);
+    wakeUp();
+    if (m_tThread.joinable()) m_tThread.join();
+    // Before the buffers of the requests still in flight go away.
+    m_pRing.reset();
+    if (m_iWakeFd != FD_UNAVAILABLE) close(m_iWakeFd);
+    if (m_iEpollFd != FD_UNAVAILABLE) close(m_iEpollFd);
+}
+
+EventLoop& EventLoop::instance() {
+    static EventLoop loop;
+    return loop;
+}
+
+//###################################################################################################
+// File descriptors.
+//###################################################################################################
+
+bool EventLoop::add(int fd, uint32_t events, IoCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        m_umHandlers[fd] = std::make_shared<IoCallback>(std::move(callback));
+    }
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(m_iEpollFd, EPOLL_CTL_ADD, fd, &event) == 0) return true;
+
+    LERROR("EventLoop|add fd %d: %s", fd, strerror(errno));
+    std::lock_guard<std::mutex> lock(m_mxLock);
+    m_umHandlers.erase(fd);
+    return false;
+}
+
+bool EventLoop::modify(int fd, uint32_t events) {
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(m_iEpollFd, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void EventLoop::remove(int fd) {
+    // Done on the I/O thread, between two callbacks, so none of them can still be running.
+    runSync([this, fd]() {
+        epoll_ctl(m_iEpollFd, EPOLL_CTL_DEL, fd, nullptr);
+        std::shared_ptr<Channel> channel;
+        {
+            std::lock_guard<std::mutex> lock(m_mxLock);
+            m_umHandlers.erase(fd);
+            auto it = m_umChannels.find(fd);
+            if (it == m_umChannels.end()) return;
+            channel = std::move(it->second);
+            m_umChannels.erase(it);
+        }
+        // Requests still in flight keep the channel (and their buffers) alive until they
+        // complete, but nothing reaches the callback any more.
+        channel->closed = true;
+        if (!m_pRing || !channel->readToken) return;
+        if (io_uring_sqe* sqe = m_pRing->getSqe()) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = channel->readToken;
+            m_pRing->submit();
+        }
+    });
+}
+
+//###################################################################################################
+// Streams.
+//###################################################################################################
+
+std::shared_ptr<EventLoop::Channel> EventLoop::channelOf(int fd) {
+    std::shared_ptr<Channel>& channel = m_umChannels[fd];
+    if (!channel) {
+        channel = std::make_shared<Channel>();
+        channel->fd = fd;
+    }
+    return channel;
+}
+
+bool EventLoop::addReader(int fd, ReadCallback callback) {
+    return addReader(fd, std::move(callback), nullptr);
+}
+
+bool EventLoop::addReader(int fd, ReadCallback callback, ReadBuffer buffer) {
+    bool reading = false;
+    runSync([&]() {
+        std::shared_ptr<Channel> channel;
+        {
+            std::lock_guard<std::mutex> lock(m_mxLock);
+            channel = channelOf(fd);
+        }
+        if (channel->onRead) {
+            LERROR("EventLoop|fd %d already has a reader.", fd);
+            return;
+        }
+        channel->onRead = std::move(callback);
+        channel->readBuffer = std::move(buffer);
+        // A kernel without multishot reads fails the request itself, onCompletions() then
+        // moves the channel to epoll.
+        reading = (m_pRing && armRead(channel)) || watch(channel);
+        if (reading) return;
+
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        m_umChannels.erase(fd);
+        channel->closed = true;
+    });
+    return reading;
+}
+
+void EventLoop::write(int fd, std::span<const char> data) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        std::shared_ptr<Channel> channel = channelOf(fd);
+        channel->outbound.insert(channel->outbound.end(), data.begin(), data.end());
+        if (!channel->dirty) {
+            channel->dirty = true;
+            m_vDirty.push_back(std::move(channel));
+            wake = !isLoopThread();
+        }
+    }
+    // From a callback the write goes out at the end of the current iteration anyway.
+    if (wake) wakeUp();
+}
+
+bool EventLoop::watch(const std::shared_ptr<Channel>& channel) {
+    const uint32_t events = WRITABLE | EDGE_TRIGGERED | (channel->onRead ? uint32_t(READABLE) : 0u);
+    if (channel->polled) return modify(channel->fd, events);
+    channel->polled = add(channel->fd, events, [this, channel](uint32_t ready) { onChannelEvent(*channel, ready); });
+    return channel->polled;
+}
+
+void EventLoop::onChannelEvent(Channel& channel, uint32_t events) {
+    if (channel.onRead && (events & (READABLE | HANGUP | ERROR))) drain(channel);
+    if (!m_pRing && !channel.closed && (events & WRITABLE)) writeNow(channel);
+}
+
+void EventLoop::drain(Channel& channel) {
+    // Edge triggered: read until EAGAIN.
+    while (!channel.closed) {
+        std::span<char> into = channel.readBuffer ? channel.readBuffer() : std::span<char>();
+        if (into.empty()) into = m_vScratch;
+        const ssize_t length = ::read(channel.fd, into.data(), into.size());
+        if (length > 0) {
+            channel.onRead(std::span<const char>(into.data(), size_t(length)));
+            continue;
+        }
+        if (length < 0 && errno == EINTR) continue;
+        if (length < 0 && errno == EAGAIN) return;
+        if (length < 0) LDEBUG("EventLoop|read fd %d: %s", channel.fd, strerror(errno));
+        endOfStream(channel);
+        return;
+    }
+}
+
+void EventLoop::endOfStream(Channel& channel) {
+    // Told once; the callback may well remove() the fd from in there.
+    ReadCallback onRead = std::move(channel.onRead);
+    channel.onRead = nullptr;
+    channel.readBuffer = nullptr;
+    if (onRead && !channel.closed) onRead({});
+}
+
+bool EventLoop::nextBatch(Channel& channel) {
+    channel.inflight.clear();
+    channel.written = 0;
+    std::lock_guard<std::mutex> lock(m_mxLock);
+    channel.inflight.swap(channel.outbound);
+    return !channel.inflight.empty();
+}
+
+void EventLoop::flushWrites() {
+    std::vector<std::shared_ptr<Channel>> dirty;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        dirty.swap(m_vDirty);
+        for (std::shared_ptr<Channel>& channel : dirty) channel->dirty = false;
+    }
+    for (std::shared_ptr<Channel>& channel : dirty) {
+        if (channel->closed) continue;
+        if (m_pRing) {
+            startWrite(channel);
+            continue;
+        }
+        // An fd only ever written to joins the epoll set here, for EPOLLOUT.
+        if (channel->polled || watch(channel)) writeNow(*channel);
+    }
+}
+
+void EventLoop::writeNow(Channel& channel) {
+    for (;;) {
+        if (channel.written == channel.inflight.size() && !nextBatch(channel)) return;
+        const ssize_t length = ::write(channel.fd, channel.inflight.data() + channel.written,
+                                       channel.inflight.size() - channel.written);
+        if (length > 0) {
+            channel.written += size_t(length);
+            continue;
+        }
+        if (length < 0 && errno == EINTR) continue;
+        // The next EPOLLOUT picks up from here.
+        if (length < 0 && errno == EAGAIN) return;
+        LERROR("EventLoop|write fd %d: %s", channel.fd, strerror(errno));
+        channel.written = channel.inflight.size();
+    }
+}
+
+//###################################################################################################
+// io_uring requests.
+//###################################################################################################
+
+bool EventLoop::armRead(const std::shared_ptr<Channel>& channel) {
+    io_uring_sqe* sqe = m_pRing->getSqe();
+    if (!sqe) return false;
+    // One request keeps delivering into provided buffers until it fails or runs dry.
+    sqe->opcode = IoUring::OP_READ_MULTISHOT;
+    sqe->fd = channel->fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = IoUring::BUFFER_GROUP;
+    sqe->off = uint64_t(-1);
+    sqe->user_data = channel->readToken = m_uNextToken++;
+    m_umRequests[channel->readToken] = Request{ channel, false };
+    return true;
+}
+
+void EventLoop::startWrite(const std::shared_ptr<Channel>& channel) {
+    // One write in flight per channel keeps them in order; the rest waits in 'outbound'.
+    if (channel->writeToken || !nextBatch(*channel)) return;
+    if (!submitWrite(channel)) LERROR("EventLoop|write fd %d: submission ring full.", channel->fd);
+}
+
+bool EventLoop::submitWrite(const std::shared_ptr<Channel>& channel) {
+    io_uring_sqe* sqe = m_pRing->getSqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = channel->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(channel->inflight.data() + channel->written);
+    sqe->len = uint32_t(channel->inflight.size() - channel->written);
+    sqe->off = uint64_t(-1);
+    sqe->user_data = channel->writeToken = m_uNextToken++;
+    m_umRequests[channel->writeToken] = Request{ channel, true };
+    return true;
+}
+
+void EventLoop::onCompletions() {
+    m_pRing->reap([this](const io_uring_cqe& cqe) {
+        const bool buffered = cqe.flags & IORING_CQE_F_BUFFER;
+        const uint16_t buffer = uint16_t(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        auto it = m_umRequests.find(cqe.user_data);
+        if (it == m_umRequests.end()) {
+            // Cancellations, and nothing else, carry unknown tokens.
+            if (buffered) m_pRing->recycleBuffer(buffer);
+            return;
+        }
+        const std::shared_ptr<Channel> channel = it->second.channel;
+        const bool write = it->second.write;
+        if (!write) {
+            if (buffered) {
+                if (cqe.res > 0 && !channel->closed && channel->onRead)
+                    channel->onRead(std::span<const char>(m_pRing->getBuffer(buffer), size_t(cqe.res)));
+                m_pRing->recycleBuffer(buffer);
+            }
+            if (cqe.flags & IORING_CQE_F_MORE) return;
+        }
+        m_umRequests.erase(it);
+        if (write) onWritten(channel, cqe.res);
+        else onReadStopped(channel, cqe.res);
+    });
+}
+
+void EventLoop::onReadStopped(const std::shared_ptr<Channel>& channel, int result) {
+    channel->readToken = 0;
+    if (channel->closed || !channel->onRead) return;
+    // Out of provided buffers, or the kernel ended the multishot early: carry on.
+    if (result > 0 || result == -ENOBUFS) {
+        armRead(channel);
+        return;
+    }
+    // Kernel or file without multishot reads.
+    if ((result == -EINVAL || result == -EBADFD || result == -EOPNOTSUPP) && watch(channel)) {
+        LDEBUG("EventLoop|fd %d: no multishot read, polling it.", channel->fd);
+        return;
+    }
+    if (result < 0) LDEBUG("EventLoop|read fd %d: %s", channel->fd, strerror(-result));
+    endOfStream(*channel);
+}
+
+void EventLoop::onWritten(const std::shared_ptr<Channel>& channel, int result) {
+    channel->writeToken = 0;
+    if (channel->closed) return;
+    if (result > 0) {
+        channel->written += size_t(result);
+    } else if (result != -EAGAIN && result != -EINTR) {
+        LERROR("EventLoop|write fd %d: %s", channel->fd, strerror(-result));
+        channel->written = channel->inflight.size();
+    }
+    // Short writes resubmit the rest, then whatever was queued meanwhile goes out.
+    if (channel->written < channel->inflight.size()) {
+        if (!submitWrite(channel)) LERROR("EventLoop|write fd %d: submission ring full.", channel->fd);
+        return;
+    }
+    startWrite(channel);
+}
+
+//###################################################################################################
+// Timers.
+//###################################################################################################
+
+int EventLoop::addTimer(std::chrono::nanoseconds delay, Task callback, bool repeat) {
+    int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer < 0) return -1;
+
+    // A zero it_value would disarm the timer.
+    const int64_t ns = std::max<int64_t>(delay.count(), 1);
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = ns / 1000000000;
+    spec.it_value.tv_nsec = ns % 1000000000;
+    if (repeat) spec.it_interval = spec.it_value;
+    timerfd_settime(timer, 0, &spec, nullptr);
+
+    const bool added = add(timer, READABLE, [this, timer, repeat, callback = std::move(callback)](uint32_t) {
+        uint64_t expirations;
+        if (::read(timer, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+        callback();
+        if (!repeat) cancelTimer(timer);
+    });
+    if (!added) {
+        close(timer);
+        return -1;
+    }
+    return timer;
+}
+
+void EventLoop::cancelTimer(int timer) {
+    remove(timer);
+    close(timer);
+}
+
+//###################################################################################################
+// Cross-thread tasks.
+//###################################################################################################
+
+void EventLoop::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        m_vPosted.push_back(std::move(task));
+    }
+    wakeUp();
+}
+
+void EventLoop::runSync(Task task) {
+    // Inline when already on the loop, or when there is no loop left to run it.
+    if (isLoopThread() || !m_tThread.joinable() || m_atbStop.load()) {
+        task();
+        return;
+    }
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    post([&]() {
+        task();
+        done.set_value();
+    });
+    finished.wait();
+}
+
+void EventLoop::wakeUp() {
+    const uint64_t one = 1;
+    if (m_iWakeFd != FD_UNAVAILABLE) (void)!::write(m_iWakeFd, &one, sizeof(one));
+}
+
+void EventLoop::runPosted() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        tasks.swap(m_vPosted);
+    }
+    for (Task& task : tasks) task();
+}
+
+//###################################################################################################
+// I/O thread.
+//###################################################################################################
+
+void EventLoop::run() {
+    struct epoll_event events[MAX_EVENTS];
+    while (!m_atbStop.load()) {
+        const int n = epoll_wait(m_iEpollFd, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LERROR("EventLoop|epoll_wait: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            const int fd = events[i].data.fd;
+            if (fd == m_iWakeFd) {
+                uint64_t count;
+                (void)!::read(m_iWakeFd, &count, sizeof(count));
+                continue;
+            }
+
+            // An earlier callback of this batch may have removed it.
+            std::shared_ptr<IoCallback> callback;
+            {
+                std::lock_guard<std::mutex> lock(m_mxLock);
+                auto it = m_umHandlers.find(fd);
+                if (it == m_umHandlers.end()) continue;
+                callback = it->second;
+            }
+            (*callback)(events[i].events);
+        }
+        runPosted();
+        // Everything this iteration queued, writes and re-armed reads, in one syscall.
+        flushWrites();
+        if (m_pRing && m_pRing->hasPending()) {
+            const int submitted = m_pRing->submit();
+            if (submitted < 0) LERROR("EventLoop|io_uring submit: %s", strerror(-submitted));
+        }
+    }
+    // Nobody waits forever on a task posted during shutdown.
+    runPosted();
+}
+
+#endif // LINUX_PLATFORM.
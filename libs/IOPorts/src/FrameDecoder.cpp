@@ -0,0 +1,240 @@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Frame decoder implementation.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+#include <include/FrameDecoder.hpp>
+#include <include/Logger.hpp>
+#include <algorithm>
+#include <cstring>
+
+FrameDecoder::FrameDecoder(Framing framing, FrameCallback onFrame) : m_fFraming(framing), m_fnOnFrame(std::move(onFrame)) {
+    if (m_fFraming.kind == Framing::COBS) m_fFraming.delimiter = '\0';
+    if (m_fFraming.kind == Framing::SLIP) m_fFraming.delimiter = SLIP_END;
+    const bool prefixed = m_fFraming.kind == Framing::LENGTH_PREFIX;
+    const uint8_t lengthBytes = m_fFraming.lengthBytes;
+    if (prefixed && lengthBytes != 1 && lengthBytes != 2 && lengthBytes != 4 && lengthBytes != 8) {
+        LERROR("FrameDecoder|invalid length prefix of %u bytes, expected 1, 2, 4 or 8.", unsigned(lengthBytes));
+        m_bValid = false;
+        return;
+    }
+    m_vPending.resize(m_fFraming.maxFrameSize + (prefixed ? m_fFraming.lengthBytes : 0));
+    if (!prefixed && m_fFraming.kind != Framing::DELIMITER) m_vDecoded.resize(m_fFraming.maxFrameSize);
+}
+
+size_t FrameDecoder::feed(std::span<const char> data) {
+    if (!m_bValid) {
+        if (!data.empty()) m_uErrors++;
+        return 0;
+    }
+    const uint64_t before = m_uFrames;
+    if (m_fFraming.kind == Framing::LENGTH_PREFIX) feedLengthPrefixed(data.data(), data.data() + data.size());
+    else feedDelimited(data.data(), data.data() + data.size());
+    return size_t(m_uFrames - before);
+}
+
+void FrameDecoder::reset() {
+    m_uPending = 0;
+    m_bDiscarding = false;
+    m_uSkip = 0;
+    m_uExpected = 0;
+}
+
+void FrameDecoder::emit(std::string_view frame) {
+    m_uFrames++;
+    m_fnOnFrame(frame);
+}
+
+void FrameDecoder::keep(const char* at, size_t length) {
+    if (m_bDiscarding) return;
+    if (m_uPending + length > m_vPending.size()) {
+        // Too long: drop it, up to the next delimiter.
+        m_uErrors++;
+        m_bDiscarding = true;
+        m_uPending = 0;
+        return;
+    }
+    std::memcpy(m_vPending.data() + m_uPending, at, length);
+    m_uPending += length;
+}
+
+//###################################################################################################
+// Delimited framings (delimiter, COBS, SLIP).
+//###################################################################################################
+
+void FrameDecoder::feedDelimited(const char* at, const char* end) {
+    while (at < end) {
+        const char* stop = static_cast<const char*>(std::memchr(at, m_fFraming.delimiter, size_t(end - at)));
+        if (stop == nullptr) {
+            keep(at, size_t(end - at));
+            return;
+        }
+        // The common case, a frame inside this feed, goes out in place.
+        if (m_uPending == 0 && !m_bDiscarding) {
+            if (size_t(stop - at) <= m_fFraming.maxFrameSize) emitDelimited(std::string_view(at, size_t(stop - at)));
+            else m_uErrors++;
+        } else {
+            keep(at, size_t(stop - at));
+            if (!m_bDiscarding) emitDelimited(std::string_view(m_vPending.data(), m_uPending));
+        }
+        m_uPending = 0;
+        m_bDiscarding = false;
+        at = stop + 1;
+    }
+}
+
+void FrameDecoder::emitDelimited(std::string_view frame) {
+    switch (m_fFraming.kind) {
+    case Framing::COBS: {
+        // Empty frames are just back-to-back delimiters. Every block is a run of bytes copied
+        // whole, then an implied zero unless it was a full 254 byte block.
+        if (frame.empty()) return;
+        size_t in = 0, out = 0;
+        while (in < frame.size()) {
+            const size_t code = uint8_t(frame[in++]);
+            if (code == 0 || in + code - 1 > frame.size()) {
+                m_uErrors++;
+                return;
+            }
+            std::memcpy(m_vDecoded.data() + out, frame.data() + in, code - 1);
+            in += code - 1;
+            out += code - 1;
+            if (code != 0xFF && in < frame.size()) m_vDecoded[out++] = '\0';
+        }
+        emit(std::string_view(m_vDecoded.data(), out));
+        return;
+    }
+    case Framing::SLIP: {
+        // A leading END only flushes line noise. Frames without escapes go out as they are.
+        if (frame.empty()) return;
+        const char* escape = static_cast<const char*>(std::memchr(frame.data(), SLIP_ESC, frame.size()));
+        if (escape == nullptr) {
+            emit(frame);
+            return;
+        }
+        const char* at = frame.data();
+        const char* end = frame.data() + frame.size();
+        size_t out = 0;
+        while (escape != nullptr) {
+            std::memcpy(m_vDecoded.data() + out, at, size_t(escape - at));
+            out += size_t(escape - at);
+            if (escape + 1 == end || (escape[1] != SLIP_ESC_END && escape[1] != SLIP_ESC_ESC)) {
+                m_uErrors++;
+                return;
+            }
+            m_vDecoded[out++] = escape[1] == SLIP_ESC_END ? SLIP_END : SLIP_ESC;
+            at = escape + 2;
+            escape = static_cast<const char*>(std::memchr(at, SLIP_ESC, size_t(end - at)));
+        }
+        std::memcpy(m_vDecoded.data() + out, at, size_t(end - at));
+        out += size_t(end - at);
+        emit(std::string_view(m_vDecoded.data(), out));
+        return;
+    }
+    default:
+        emit(frame);
+    }
+}
+
+//###################################################################################################
+// Length prefixed framing.
+//###################################################################################################
+
+size_t FrameDecoder::readLength(const char* header) const {
+    size_t length = 0;
+    for (uint8_t i = 0; i < m_fFraming.lengthBytes; i++) {
+        const uint8_t byte = uint8_t(header[m_fFraming.bigEndian ? i : m_fFraming.lengthBytes - 1 - i]);
+        length = (length << 8) | byte;
+    }
+    return length;
+}
+
+void FrameDecoder::feedLengthPrefixed(const char* at, const char* end) {
+    const size_t header = m_fFraming.lengthBytes;
+    while (at < end) {
+        // The rest of an oversized frame.
+        if (m_uSkip != 0) {
+            const size_t skipped = std::min(m_uSkip, size_t(end - at));
+            at += skipped;
+            m_uSkip -= skipped;
+            continue;
+        }
+
+        // Whole frames inside this feed go out in place.
+        if (m_uPending == 0 && size_t(end - at) >= header) {
+            const size_t length = readLength(at);
+            if (length > m_fFraming.maxFrameSize) {
+                m_uErrors++;
+                m_uSkip = length;
+                at += header;
+                continue;
+            }
+            if (size_t(end - at) - header >= length) {
+                emit(std::string_view(at + header, length));
+                at += header + length;
+                continue;
+            }
+        }
+
+        // Otherwise gather the header, then the payload.
+        const bool haveHeader = m_uPending >= header;
+        const size_t wanted = (haveHeader ? header + m_uExpected : header) - m_uPending;
+        const size_t taken = std::min(wanted, size_t(end - at));
+        std::memcpy(m_vPending.data() + m_uPending, at, taken);
+        m_uPending += taken;
+        at += taken;
+        if (!haveHeader && m_uPending == header) {
+            m_uExpected = readLength(m_vPending.data());
+            if (m_uExpected > m_fFraming.maxFrameSize) {
+                m_uErrors++;
+                m_uSkip = m_uExpected;
+                m_uPending = 0;
+                continue;
+            }
+        }
+        if (m_uPending >= header && m_uPending == header + m_uExpected) {
+            emit(std::string_view(m_vPending.data() + header, m_uExpected));
+            m_uPending = 0;
+        }
+    }
+}
+
+//###################################################################################################
+// Encoders.
+//###################################################################################################
+
+void FrameDecoder::encodeCobs(std::span<const char> payload, std::vector<char>& out) {
+    // Each block: its length code, then up to 254 non-zero bytes; the frame ends with a zero.
+    const char* at = payload.data();
+    const char* end = payload.data() + payload.size();
+    for (;;) {
+        const size_t limit = std::min<size_t>(254, size_t(end - at));
+        const char* zero = static_cast<const char*>(std::memchr(at, 0, limit));
+        const size_t run = zero != nullptr ? size_t(zero - at) : limit;
+        out.push_back(char(run + 1));
+        out.insert(out.end(), at, at + run);
+        at += run;
+        if (zero != nullptr) {
+            at++;
+            continue;
+        }
+        if (run == 254 && at < end) continue;
+        break;
+    }
+    out.push_back('\0');
+}
+
+void FrameDecoder::encodeSlip(std::span<const char> payload, std::vector<char>& out) {
+    out.push_back(SLIP_END);
+    for (char byte : payload) {
+        if (byte == SLIP_END) {
+            out.push_back(SLIP_ESC);
+            out.push_back(SLIP_ESC_END);
+        } else if (byte == SLIP_ESC) {
+            out.push_back(SLIP_ESC);
+            out.push_back(SLIP_ESC_ESC);
+        } else {
+            out.push_back(byte);
+        }
+    }
+    out.push_back(SLIP_END);
+}
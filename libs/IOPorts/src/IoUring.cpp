@@ -0,0 +1,141 @@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// io_uring Linux implementation.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+#include "../platform.hpp"
+
+#ifdef LINUX_PLATFORM
+
+#include <include/IoUring.hpp>
+#include <include/Logger.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+static int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ioUringEnter(int fd, unsigned submit, unsigned wait, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+}
+
+static int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, args));
+}
+
+template <class T>
+static T* at(void* base, uint32_t offset) { return reinterpret_cast<T*>(static_cast<char*>(base) + offset); }
+
+//###################################################################################################
+// Setup and teardown.
+//###################################################################################################
+
+IoUring::IoUring(unsigned entries, uint16_t buffers, uint32_t bufferSize) {
+    m_bValid = setup(entries) && setupBufferRing(buffers, bufferSize);
+    if (!m_bValid) LDEBUG("IoUring|unavailable: %s", strerror(errno));
+}
+
+IoUring::~IoUring() {
+    // Closing the ring cancels what is in flight, only then is the memory safe to unmap.
+    if (m_iFd >= 0) close(m_iFd);
+    if (m_pBuffers) munmap(m_pBuffers, size_t(m_uBufferCount) * m_uBufferSize);
+    if (m_pBufRing) munmap(m_pBufRing, m_uBufRingSize);
+    if (m_pSqes) munmap(m_pSqes, m_uSqesSize);
+    if (m_pCqRing && m_pCqRing != m_pSqRing) munmap(m_pCqRing, m_uCqRingSize);
+    if (m_pSqRing) munmap(m_pSqRing, m_uSqRingSize);
+}
+
+bool IoUring::setup(unsigned entries) {
+    io_uring_params params = {};
+    if ((m_iFd = ioUringSetup(entries, &params)) < 0) return false;
+
+    m_uSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_uCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) m_uSqRingSize = m_uCqRingSize = std::max(m_uSqRingSize, m_uCqRingSize);
+
+    m_pSqRing = mmap(nullptr, m_uSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iFd, IORING_OFF_SQ_RING);
+    if (m_pSqRing == MAP_FAILED) return m_pSqRing = nullptr, false;
+    m_pCqRing = single ? m_pSqRing : mmap(nullptr, m_uCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iFd, IORING_OFF_CQ_RING);
+    if (m_pCqRing == MAP_FAILED) return m_pCqRing = nullptr, false;
+    m_uSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, m_uSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    m_pSqes = static_cast<io_uring_sqe*>(sqes);
+
+    m_puSqHead = at<unsigned>(m_pSqRing, params.sq_off.head);
+    m_puSqTail = at<unsigned>(m_pSqRing, params.sq_off.tail);
+    m_puSqMask = at<unsigned>(m_pSqRing, params.sq_off.ring_mask);
+    m_puSqArray = at<unsigned>(m_pSqRing, params.sq_off.array);
+    m_puCqHead = at<unsigned>(m_pCqRing, params.cq_off.head);
+    m_puCqTail = at<unsigned>(m_pCqRing, params.cq_off.tail);
+    m_puCqMask = at<unsigned>(m_pCqRing, params.cq_off.ring_mask);
+    m_pCqes = at<io_uring_cqe>(m_pCqRing, params.cq_off.cqes);
+    return true;
+}
+
+bool IoUring::setupBufferRing(uint16_t buffers, uint32_t bufferSize) {
+    // The ring must be page aligned, and its size a power of two.
+    m_uBufRingSize = sizeof(io_uring_buf) * buffers;
+    void* ring = mmap(nullptr, m_uBufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) return false;
+    m_pBufRing = static_cast<io_uring_buf_ring*>(ring);
+
+    io_uring_buf_reg reg = {};
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = buffers;
+    reg.bgid = BUFFER_GROUP;
+    if (ioUringRegister(m_iFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) return false;
+
+    void* memory = mmap(nullptr, size_t(buffers) * bufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return false;
+    m_pBuffers = static_cast<char*>(memory);
+    m_uBufferCount = buffers;
+    m_uBufferSize = bufferSize;
+    for (uint16_t id = 0; id < buffers; id++) recycleBuffer(id);
+    return true;
+}
+
+//###################################################################################################
+// Submission.
+//###################################################################################################
+
+io_uring_sqe* IoUring::getSqe() {
+    unsigned tail = *m_puSqTail;
+    if (tail - __atomic_load_n(m_puSqHead, __ATOMIC_ACQUIRE) > *m_puSqMask) {
+        submit();
+        if (tail - __atomic_load_n(m_puSqHead, __ATOMIC_ACQUIRE) > *m_puSqMask) return nullptr;
+    }
+    const unsigned index = tail & *m_puSqMask;
+    io_uring_sqe* sqe = &m_pSqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    m_puSqArray[index] = index;
+    __atomic_store_n(m_puSqTail, tail + 1, __ATOMIC_RELEASE);
+    m_uQueued++;
+    return sqe;
+}
+
+int IoUring::submit() {
+    if (m_uQueued == 0) return 0;
+    const int submitted = ioUringEnter(m_iFd, m_uQueued, 0, 0);
+    if (submitted < 0) return -errno;
+    m_uQueued -= submitted;
+    return submitted;
+}
+
+void IoUring::recycleBuffer(uint16_t id) {
+    // The tail shares its slot with bufs[0].resv; the kernel reads it with acquire. Entries are
+    // indexed off the ring base: in C++ the uapi flex-array wrapper shifts 'bufs' by 8 bytes.
+    const uint16_t tail = m_pBufRing->tail;
+    io_uring_buf& buffer = reinterpret_cast<io_uring_buf*>(m_pBufRing)[tail & (m_uBufferCount - 1)];
+    buffer.addr = reinterpret_cast<uint64_t>(m_pBuffers + size_t(id) * m_uBufferSize);
+    buffer.len = m_uBufferSize;
+    buffer.bid = id;
+    __atomic_store_n(&m_pBufRing->tail, uint16_t(tail + 1), __ATOMIC_RELEASE);
+}
+
+#endif // LINUX_PLATFORM.
@@ -122,22 +122,15 @@ bool SerialBuffer::SerialBufferImpl::Read_Upto(std::string &szData, char chTerm,
 	bool abFound = false;
 	if (this->m_alBytesUnRead > 0)
 	{
-		int iActualSize = m_sb->getSize();
-		int iIncrementPos = 0;
-		for (int i = this->m_iCurPos; i < iActualSize; ++i)
-		{
-			// szData .append ( m_szInternalBuffer,i,1);
-			szData += this->m_szInternalBuffer[i];
-			this->m_alBytesUnRead -= 1;
-			if (this->m_szInternalBuffer[i] == chTerm)
-			{
-				iIncrementPos++;
-				abFound = true;
-				break;
-			}
-			iIncrementPos++;
-		}
+		// One scan and one append, not a byte at a time.
+		long iActualSize = m_sb->getSize();
+		size_t iTerm = this->m_szInternalBuffer.find(chTerm, this->m_iCurPos);
+		abFound = iTerm != std::string::npos;
+		long iIncrementPos = (abFound ? (long)iTerm + 1 : iActualSize) - this->m_iCurPos;
+		szData.append(this->m_szInternalBuffer, this->m_iCurPos, iIncrementPos);
+		this->m_alBytesUnRead -= iIncrementPos;
 		this->m_iCurPos += iIncrementPos;
+		alBytesRead = iIncrementPos;
 		if (this->m_alBytesUnRead == 0)
 		{
 			ClearAndReset();
@@ -209,4 +202,4 @@ void SerialBuffer::UnLockBuffer() { m_pimpl->UnLockBuffer(); }
 // End Base class Implementation.
 //########################################################################################
 
-#endif // ! _WIN32 || _WIN64
\ No newline at end of file
+#endif // ! _WIN32 || _WIN64
\ No newline at end of file
@@ -0,0 +1,212 @@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Serial capture and replay Linux implementation.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+#include "../platform.hpp"
+
+#ifdef LINUX_PLATFORM
+
+#include <include/SerialCapture.hpp>
+#include <include/Logger.hpp>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+    void putLittleEndian(char* at, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) at[i] = char(value >> (8 * i));
+    }
+
+    uint64_t getLittleEndian(const char* at, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = bytes; i-- > 0;) value = (value << 8) | uint8_t(at[i]);
+        return value;
+    }
+
+    // Writes all of 'data' to 'fd', blocking or not. False on error.
+    bool writeAll(int fd, const char* data, size_t length) {
+        while (length != 0) {
+            const ssize_t n = ::write(fd, data, length);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN) return false;
+                struct pollfd writable = { fd, POLLOUT, 0 };
+                poll(&writable, 1, -1);
+                continue;
+            }
+            data += n;
+            length -= size_t(n);
+        }
+        return true;
+    }
+}
+
+uint64_t SerialCapture::now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+    return uint64_t(time.tv_sec) * 1000000000u + uint64_t(time.tv_nsec);
+}
+
+//###################################################################################################
+// Capture writer.
+//###################################################################################################
+
+CaptureWriter::CaptureWriter(const std::string& path, std::string& err_message) {
+    m_iFd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_iFd < 0 || !writeAll(m_iFd, SerialCapture::MAGIC, sizeof(SerialCapture::MAGIC))) {
+        err_message = "Capture|" + path + ": " + strerror(errno);
+        if (m_iFd >= 0) close(m_iFd);
+        m_iFd = FD_UNAVAILABLE;
+        return;
+    }
+    m_vFilling.reserve(2 * BATCH_SIZE);
+    m_vWriting.reserve(2 * BATCH_SIZE);
+    m_tWriter = std::thread(&CaptureWriter::run, this);
+}
+
+CaptureWriter::~CaptureWriter() {
+    if (!isOpen()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        m_bStopping = true;
+    }
+    m_cvWork.notify_one();
+    m_tWriter.join();
+    close(m_iFd);
+}
+
+bool CaptureWriter::record(std::span<const char> data, uint64_t timestamp) {
+    if (!isOpen()) return false;
+    const size_t size = SerialCapture::RECORD_HEADER_SIZE + data.size();
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mxLock);
+        if (m_uRecorded - m_uWritten + size > MAX_BACKLOG) {
+            if (m_uDropped++ == 0) LERROR("Capture|writer too slow, records dropped.");
+            return false;
+        }
+        const size_t at = m_vFilling.size();
+        m_vFilling.resize(at + size);
+        putLittleEndian(m_vFilling.data() + at, timestamp, 8);
+        putLittleEndian(m_vFilling.data() + at + 8, data.size(), 4);
+        std::memcpy(m_vFilling.data() + at + SerialCapture::RECORD_HEADER_SIZE, data.data(), data.size());
+        m_uRecorded += size;
+        m_uRecords++;
+        // Only the record completing a batch pays for the wake-up.
+        wake = at < BATCH_SIZE && m_vFilling.size() >= BATCH_SIZE;
+    }
+    if (wake) m_cvWork.notify_one();
+    return true;
+}
+
+void CaptureWriter::flush() {
+    if (!isOpen()) return;
+    std::unique_lock<std::mutex> lock(m_mxLock);
+    const uint64_t recorded = m_uRecorded;
+    m_bFlushing = true;
+    m_cvWork.notify_one();
+    m_cvWritten.wait(lock, [&]() { return m_uWritten >= recorded; });
+}
+
+uint64_t CaptureWriter::getRecords() const {
+    std::lock_guard<std::mutex> lock(m_mxLock);
+    return m_uRecords;
+}
+
+uint64_t CaptureWriter::getDropped() const {
+    std::lock_guard<std::mutex> lock(m_mxLock);
+    return m_uDropped;
+}
+
+void CaptureWriter::run() {
+    std::unique_lock<std::mutex> lock(m_mxLock);
+    for (;;) {
+        m_cvWork.wait_for(lock, FLUSH_INTERVAL, [this]() {
+            return m_vFilling.size() >= BATCH_SIZE || m_bFlushing || m_bStopping;
+        });
+        const bool stopping = m_bStopping;
+        m_bFlushing = false;
+        if (!m_vFilling.empty()) {
+            m_vFilling.swap(m_vWriting);
+            lock.unlock();
+            if (!writeAll(m_iFd, m_vWriting.data(), m_vWriting.size()))
+                LERROR("Capture|write: %s", strerror(errno));
+            const size_t written = m_vWriting.size();
+            m_vWriting.clear();
+            lock.lock();
+            m_uWritten += written;
+        }
+        m_cvWritten.notify_all();
+        if (stopping && m_vFilling.empty()) return;
+    }
+}
+
+//###################################################################################################
+// Capture reader.
+//###################################################################################################
+
+CaptureReader::CaptureReader(const std::string& path, std::string& err_message) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) != 0) {
+        err_message = "Capture|" + path + ": " + strerror(errno);
+        if (fd >= 0) close(fd);
+        return;
+    }
+    m_uSize = size_t(status.st_size);
+    void* data = m_uSize < sizeof(SerialCapture::MAGIC) ? MAP_FAILED : mmap(nullptr, m_uSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED || std::memcmp(data, SerialCapture::MAGIC, sizeof(SerialCapture::MAGIC)) != 0) {
+        err_message = "Capture|" + path + ": not a capture file.";
+        if (data != MAP_FAILED) munmap(data, m_uSize);
+        m_uSize = 0;
+        return;
+    }
+    // Read front to back, once.
+    madvise(data, m_uSize, MADV_SEQUENTIAL);
+    m_pData = static_cast<const char*>(data);
+    rewind();
+}
+
+CaptureReader::~CaptureReader() {
+    if (m_pData != nullptr) munmap(const_cast<char*>(m_pData), m_uSize);
+}
+
+bool CaptureReader::next(SerialCapture::Record& record) {
+    if (m_pData == nullptr || m_uSize - m_uOffset < SerialCapture::RECORD_HEADER_SIZE) return false;
+    const char* header = m_pData + m_uOffset;
+    const size_t length = size_t(getLittleEndian(header + 8, 4));
+    if (m_uSize - m_uOffset - SerialCapture::RECORD_HEADER_SIZE < length) return false;
+    record.timestamp = getLittleEndian(header, 8);
+    record.data = std::span<const char>(header + SerialCapture::RECORD_HEADER_SIZE, length);
+    m_uOffset += SerialCapture::RECORD_HEADER_SIZE + length;
+    return true;
+}
+
+int64_t CaptureReader::replay(int fd, double speed, std::string& err_message) {
+    // CLOCK_MONOTONIC_RAW cannot be slept on: the spacing is replayed on the steady clock.
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t origin = 0;
+    int64_t written = 0;
+    SerialCapture::Record record;
+    for (bool first = true; next(record); first = false) {
+        if (first) origin = record.timestamp;
+        if (speed > 0) {
+            const auto offset = std::chrono::nanoseconds(int64_t(double(record.timestamp - origin) / speed));
+            std::this_thread::sleep_until(start + offset);
+        }
+        if (!writeAll(fd, record.data.data(), record.data.size())) {
+            err_message = std::string("Capture|replay: ") + strerror(errno);
+            return -1;
+        }
+        written += int64_t(record.data.size());
+    }
+    return written;
+}
+
+#endif // LINUX_PLATFORM.
@@ -0,0 +1,73 @@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Serial line configuration, Linux (termios2).
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+#include "../platform.hpp"
+
+#ifdef LINUX_PLATFORM
+
+// PortUtils first: its BaudRate enumerators share their names with the termbits macros.
+#include <include/PortUtils.hpp>
+// Its own translation unit because <asm/termbits.h> (termios2) clashes with <termios.h>.
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#include <cerrno>
+#include <cstring>
+
+bool PortUtils::Serial::applyConfig(int fd, const PortConfig& config, std::string& err_message) {
+    if (config.nComBits < 5 || config.nComBits > 8 || config.byStopBits < 1 || config.byStopBits > 2 ||
+        config.parity > Parity::Space || config.nComRate == 0) {
+        err_message = "Serial|invalid port configuration.";
+        return false;
+    }
+
+    // Reference: https://blog.mbedded.ninja/programming/operating-systems/linux/linux-serial-ports-using-c-cpp/
+    struct termios2 tty;
+    if (ioctl(fd, TCGETS2, &tty) != 0) {
+        err_message = std::string("Serial|TCGETS2: ") + strerror(errno);
+        return false;
+    }
+
+    static constexpr tcflag_t DATA_BITS[] = { CS5, CS6, CS7, CS8 };
+    tty.c_cflag &= ~(CSIZE | PARENB | PARODD | CMSPAR | CSTOPB);
+    tty.c_cflag |= DATA_BITS[config.nComBits - 5];
+    if (config.parity != Parity::None) tty.c_cflag |= PARENB;
+    if (config.parity == Parity::Odd || config.parity == Parity::Mark) tty.c_cflag |= PARODD;
+    // Mark and space: the parity bit is stuck at PARODD.
+    if (config.parity == Parity::Mark || config.parity == Parity::Space) tty.c_cflag |= CMSPAR;
+    if (config.byStopBits == 2) tty.c_cflag |= CSTOPB;
+    tty.c_cflag &= ~CRTSCTS; // Disable RTS/CTS hardware flow control (most common)
+    tty.c_cflag |= CREAD | CLOCAL; // Turn on READ & ignore ctrl lines (CLOCAL = 1)
+
+    tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ECHONL | ISIG); // Raw: no line editing, echo or signals
+    tty.c_iflag &= ~(IXON | IXOFF | IXANY); // Turn off s/w flow ctrl
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL); // Disable any special handling of received bytes
+    // Check parity on input when it is on; bad bytes still arrive (no IGNPAR), without marks.
+    if (config.parity != Parity::None) tty.c_iflag |= INPCK;
+    else tty.c_iflag &= ~INPCK;
+    tty.c_oflag &= ~(OPOST | ONLCR); // Prevent special interpretation of output bytes (e.g. newline chars)
+
+    // Non-blocking fd driven by the event loop: with VMIN 0 and VTIME 0 an empty read would
+    // return 0 (end of file) instead of EAGAIN.
+    tty.c_cc[VTIME] = 0;
+    tty.c_cc[VMIN] = 1;
+
+    // BOTHER takes the rate in baud, standard or not; the kernel maps standard ones back.
+    tty.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    tty.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    tty.c_ispeed = tty.c_ospeed = config.nComRate;
+
+    if (ioctl(fd, TCSETS2, &tty) != 0) {
+        err_message = std::string("Serial|TCSETS2: ") + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+uint32_t PortUtils::Serial::getBaudRate(int fd) {
+    struct termios2 tty;
+    if (ioctl(fd, TCGETS2, &tty) != 0) return 0;
+    return tty.c_ospeed;
+}
+
+#endif // LINUX_PLATFORM.
@@ -0,0 +1,88 @@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Serial line configuration, MacOS (termios, IOSSIOSPEED).
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+#include "../platform.hpp"
+
+#ifdef APPLE_PLATFORM
+
+// PortUtils first: its former BaudRate enumerator names are termios macros.
+#include <include/PortUtils.hpp>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <IOKit/serial/ioss.h> // IOSSIOSPEED
+#include <cerrno>
+#include <cstring>
+
+namespace {
+    // What tcsetattr() takes as is; speed_t is the rate in baud on MacOS.
+    bool isStandardRate(uint32_t rate) {
+        static constexpr uint32_t RATES[] = { 50, 75, 110, 134, 150, 200, 300, 600, 1200, 1800, 2400,
+                                              4800, 9600, 19200, 38400, 57600, 115200, 230400 };
+        for (uint32_t standard : RATES)
+            if (standard == rate) return true;
+        return false;
+    }
+}
+
+bool PortUtils::Serial::applyConfig(int fd, const PortConfig& config, std::string& err_message) {
+    // No CMSPAR here, so no mark or space parity either.
+    if (config.nComBits < 5 || config.nComBits > 8 || config.byStopBits < 1 || config.byStopBits > 2 ||
+        config.parity > Parity::Even || config.nComRate == 0) {
+        err_message = "Serial|invalid port configuration.";
+        return false;
+    }
+
+    // Reference: https://blog.mbedded.ninja/programming/operating-systems/linux/linux-serial-ports-using-c-cpp/
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0) {
+        err_message = std::string("Serial|tcgetattr: ") + strerror(errno);
+        return false;
+    }
+
+    static constexpr tcflag_t DATA_BITS[] = { CS5, CS6, CS7, CS8 };
+    tty.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB);
+    tty.c_cflag |= DATA_BITS[config.nComBits - 5];
+    if (config.parity != Parity::None) tty.c_cflag |= PARENB;
+    if (config.parity == Parity::Odd) tty.c_cflag |= PARODD;
+    if (config.byStopBits == 2) tty.c_cflag |= CSTOPB;
+    tty.c_cflag &= ~CRTSCTS; // Disable RTS/CTS hardware flow control (most common)
+    tty.c_cflag |= CREAD | CLOCAL; // Turn on READ & ignore ctrl lines (CLOCAL = 1)
+
+    tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ECHONL | ISIG); // Raw: no line editing, echo or signals
+    tty.c_iflag &= ~(IXON | IXOFF | IXANY); // Turn off s/w flow ctrl
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL); // Disable any special handling of received bytes
+    if (config.parity != Parity::None) tty.c_iflag |= INPCK;
+    else tty.c_iflag &= ~INPCK;
+    tty.c_oflag &= ~(OPOST | ONLCR); // Prevent special interpretation of output bytes (e.g. newline chars)
+
+    // Non-blocking fd read once kqueue reports data: an empty read is EAGAIN, not 0.
+    tty.c_cc[VTIME] = 0;
+    tty.c_cc[VMIN] = 1;
+
+    // tcsetattr() refuses rates it has no constant for; those go through IOSSIOSPEED
+    // afterwards, on a standard rate placeholder.
+    const bool standard = isStandardRate(config.nComRate);
+    cfsetspeed(&tty, standard ? speed_t(config.nComRate) : speed_t(9600));
+
+    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
+        err_message = std::string("Serial|tcsetattr: ") + strerror(errno);
+        return false;
+    }
+    if (!standard) {
+        speed_t speed = config.nComRate;
+        if (ioctl(fd, IOSSIOSPEED, &speed) != 0) {
+            err_message = std::string("Serial|IOSSIOSPEED: ") + strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t PortUtils::Serial::getBaudRate(int fd) {
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0) return 0;
+    return uint32_t(cfgetospeed(&tty));
+}
+
+#endif // APPLE_PLATFORM.
@@ -8,21 +8,21 @@
 
 #include <filesystem>
 #include <cstring>
+#include <thread>
 #include <include/Logger.hpp>
 #include <include/SerialPort.hpp>
-#include <include/SharedAlloc.hpp>
+#include <include/EventLoop.hpp>
+#include <include/SpscByteRing.hpp>
+#include <include/SerialCapture.hpp>
 #include <include/BufferQueue.hpp>
 #include <include/SharedMessage.hpp>
 #include <include/PortUtils.hpp>
 // Serial configuration.
-#include <signal.h>
 #include <termios.h>
-#include <unistd.h> // write(), read(), close(), fork()
+#include <sys/ioctl.h>
+#include <unistd.h> // write(), read(), close()
 #include <fcntl.h>  // Contains file controls like O_RDWR
 #include <errno.h>  // Error integer and strerror() function
-#include <sys/epoll.h>
-#include <sys/types.h>
-#include <sys/mman.h>
 
 class SerialPort::SerialPortImpl
 {
@@ -32,19 +32,37 @@ public:
     ~SerialPortImpl();
 
     void clean();
-    void clean(pid_t process);
     void flush();
     int connect();
     std::string read();
+    std::size_t read(std::span<char> out, std::chrono::nanoseconds timeout);
+    bool readUntil(std::string& line, char delimiter, std::chrono::nanoseconds timeout);
     std::size_t write(void *data, std::size_t data_len);
     std::vector<std::string> getAvailablePorts();
+    std::size_t getOverruns() const { return m_atuOverruns.load(std::memory_order_relaxed); }
+    bool setDtr(bool on);
+    bool startCapture(const std::string& path, std::string& err_message);
+    void stopCapture();
 private:
+    // Runs on the I/O thread with what the port received; empty once it hangs up.
+    void onData(std::span<const char> data);
+    // Hands the I/O thread a queue reservation to read into, so the shared queue gets the
+    // bytes without a copy.
+    std::span<char> reserveRead();
+
     SerialPort* m_spBase;
-    pid_t* m_pidChildProcess;
     static constexpr int SFD_UNAVAILABLE = -1;
-    static constexpr unsigned MAX_EVENTS = 64;
     int m_iFd = SFD_UNAVAILABLE;
-    int m_iEpollFd = SFD_UNAVAILABLE;
+    bool m_bRegistered = false;
+
+    // I/O thread to the reading thread; what does not fit is an overrun, as on a UART.
+    static constexpr size_t INBOUND_CAPACITY = 1 << 20;
+    SpscByteRing m_sbrInbound{ INBOUND_CAPACITY };
+    std::atomic<size_t> m_atuOverruns{ 0 };
+    // I/O thread only: what reserveRead() handed out, until onData() commits it.
+    std::span<char> m_spReserved;
+    // Swapped on the I/O thread, which is the one recording.
+    std::unique_ptr<CaptureWriter> m_pCapture;
 };
 
 //###################################################################################################
@@ -55,7 +73,7 @@ SerialPort::SerialPort(std::string comPort, PortUtils::Serial::BaudRate baudRate
     std::string err = "";
     std::string shmemName = PortUtils::shMemPortNameParser(comPort, "/");
 
-    m_bqBuffer = new BufferQueue(12, shmemName, err);
+    m_bqBuffer = new BufferQueue(BUFFER_QUEUE_CAPACITY, shmemName, err);
     if (err != "") LERROR(err.c_str());
     config.nComRate = baudRate;
 }
@@ -64,46 +82,91 @@ SerialPort::SerialPort(std::string comPort, PortUtils::Serial::PortConfig config
     std::string err = "";
     std::string shmemName = PortUtils::shMemPortNameParser(comPort, "/");
 
-    m_bqBuffer = new BufferQueue(12, shmemName, err);
+    m_bqBuffer = new BufferQueue(BUFFER_QUEUE_CAPACITY, shmemName, err);
     if (err != "") LERROR(err.c_str());
     this->config = config;
 }
 
-SerialPort::~SerialPort() { delete m_bqBuffer; }
+SerialPort::~SerialPort() {
+    // The I/O thread lets go of the port before the queue it publishes to goes away.
+    m_pimpl.reset();
+    delete m_bqBuffer;
+}
 int SerialPort::connect() { return pimpl()->connect(); }
 void SerialPort::flush(){ pimpl()->flush(); }
 std::size_t SerialPort::write(void *data, std::size_t data_len) { return pimpl()->write(data, data_len); }
 std::string SerialPort::read() { return pimpl()->read(); }
+std::size_t SerialPort::read(std::span<char> out, std::chrono::nanoseconds timeout) { return pimpl()->read(out, timeout); }
+bool SerialPort::readUntil(std::string& line, char delimiter, std::chrono::nanoseconds timeout) { return pimpl()->readUntil(line, delimiter, timeout); }
+std::size_t SerialPort::getOverruns() const { return pimpl()->getOverruns(); }
+bool SerialPort::setDtr(bool on) { return pimpl()->setDtr(on); }
+bool SerialPort::startCapture(const std::string& path, std::string& err_message) { return pimpl()->startCapture(path, err_message); }
+void SerialPort::stopCapture() { pimpl()->stopCapture(); }
+
+std::future<int> SerialPort::connectAsync(ReadinessProbe probe) {
+    return std::async(std::launch::async, [this, probe = std::move(probe)]() {
+        if(connect() != 0)
+            return -1;
+        if(probe && !probe(*this)) {
+            LERROR("Serial port %s: not ready.", comPort.c_str());
+            pimpl()->clean();
+            return -1;
+        }
+        return 0;
+    });
+}
+
+SerialPort::ReadinessProbe SerialPort::dtrReset(std::chrono::milliseconds pulse) {
+    return [pulse](SerialPort& port) {
+        if(!port.setDtr(false))
+            return false;
+        std::this_thread::sleep_for(pulse);
+        return port.setDtr(true);
+    };
+}
+
+SerialPort::ReadinessProbe SerialPort::waitForBanner(std::string banner, std::chrono::milliseconds timeout) {
+    return [banner = std::move(banner), timeout](SerialPort& port) {
+        // Boot noise ahead of the banner goes with it, a chunk (up to the banner's last byte) at
+        // a time. The banner may hold that byte too (several lines ending in '\n'), so the last
+        // banner.size() bytes read are kept across chunks and matched as a whole.
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::string line, tail;
+        while(!banner.empty()) {
+            const auto left = deadline - std::chrono::steady_clock::now();
+            if(left.count() <= 0 || !port.readUntil(line, banner.back(), left))
+                return false;
+            tail += line;
+            if(tail.size() > banner.size())
+                tail.erase(0, tail.size() - banner.size());
+            if(tail == banner)
+                return true;
+        }
+        return true;
+    };
+}
 
 //###################################################################################################
 // Linux platform implementation.
 //###################################################################################################
 
 void SerialPort::SerialPortImpl::clean(){
+    // Off the loop first, so no callback touches the fd once it is closed.
+    if(m_bRegistered)
+        EventLoop::instance().remove(m_iFd);
+    m_bRegistered = false;
     if(m_iFd != SFD_UNAVAILABLE)
         close(m_iFd);
-    if(m_iEpollFd != SFD_UNAVAILABLE)
-        close(m_iEpollFd);
-    if(m_pidChildProcess)
-        kill(*m_pidChildProcess, SIGTERM);
-    munmap(m_pidChildProcess, sizeof(*m_pidChildProcess));
+    m_iFd = SFD_UNAVAILABLE;
 }
 
 //###################################################################################################
 // Serial Port Initzialization. (Constructor)
 //###################################################################################################
 
-SerialPort::SerialPortImpl::SerialPortImpl(SerialPort* base, PortUtils::Serial::BaudRate baudRate): m_spBase(base) {
-    std::string err = "";
-    m_pidChildProcess = shalloc<pid_t>("child", err);
-    if(err != "") LERROR(err.c_str());
-}
+SerialPort::SerialPortImpl::SerialPortImpl(SerialPort* base, PortUtils::Serial::BaudRate): m_spBase(base) {}
 
-SerialPort::SerialPortImpl::SerialPortImpl(SerialPort* base, PortUtils::Serial::PortConfig config): m_spBase(base) {
-    std::string err = "";
-    m_pidChildProcess = shalloc<pid_t>("child", err);
-    if(err != "") LERROR(err.c_str());
-}
+SerialPort::SerialPortImpl::SerialPortImpl(SerialPort* base, PortUtils::Serial::PortConfig): m_spBase(base) {}
 
 //###################################################################################################
 // Serial Port Cleanup. (Destructor)
@@ -116,7 +179,9 @@ SerialPort::SerialPortImpl::~SerialPortImpl(){ clean(); }
 //###################################################################################################
 
 void SerialPort::SerialPortImpl::flush(){
-    LINFO("Prepend");
+    if(m_iFd != SFD_UNAVAILABLE)
+        tcflush(m_iFd, TCIOFLUSH);
+    m_sbrInbound.clear();
 }
 
 //###################################################################################################
@@ -125,93 +190,103 @@ void SerialPort::SerialPortImpl::flush(){
 
 int SerialPort::SerialPortImpl::connect() {
     LINFO("Prepend");
+    m_sbrInbound.reopen();
     if((m_iFd = open(m_spBase->comPort.c_str(), O_RDWR | O_NOCTTY | O_NDELAY)) < 0){
         LERROR("pid(%d) Error opening serial port: %s", getpid(), m_spBase->comPort.c_str());
         return -1;
     }
 
-    // Reference: https://blog.mbedded.ninja/programming/operating-systems/linux/linux-serial-ports-using-c-cpp/
-    // Create new termios struct, we call it 'tty' for convention
-    // No need for "= {0}" at the end as we'll immediately write the existing
-    // config to this struct.
-    struct termios tty;
-
-    // Read in existing settings, and handle any error
-    // NOTE: This is important! POSIX states that the struct passed to tcsetattr()
-    // must have been initialized with a call to tcgetattr() overwise behaviour
-    // is undefined.
-    if(tcgetattr(m_iFd, &tty) != 0){
-         LERROR("pid(%d) From tcgetattr: %s", getpid(), strerror(errno));
-         clean();
-         return -1;
+    // Everything PortConfig asks for, custom speeds included.
+    std::string err;
+    if(!PortUtils::Serial::applyConfig(m_iFd, m_spBase->config, err)) {
+        LERROR("pid(%d) %s: %s", getpid(), m_spBase->comPort.c_str(), err.c_str());
+        clean();
+        return -1;
     }
+    const uint32_t rate = PortUtils::Serial::getBaudRate(m_iFd);
+    if(rate != m_spBase->config.nComRate)
+        LINFO("Serial port %s runs at %u baud, %u requested.", m_spBase->comPort.c_str(), rate, (unsigned)m_spBase->config.nComRate);
 
-    tty.c_cflag &= ~PARENB; // Clear parity bit, disabling parity (most common)
-    tty.c_cflag &= ~CSTOPB; // Clear stop field, only one stop bit used in communication (most common)
-    tty.c_cflag &= ~CSIZE; // Clear all bits that set the data size 
-    tty.c_cflag |= CS8; // 8 bits per byte (most common)
-    tty.c_cflag &= ~CRTSCTS; // Disable RTS/CTS hardware flow control (most common)
-    tty.c_cflag |= CREAD | CLOCAL; // Turn on READ & ignore ctrl lines (CLOCAL = 1)
-
-    tty.c_lflag &= ~ICANON;
-    tty.c_lflag &= ~ECHO; // Disable echo
-    tty.c_lflag &= ~ECHOE; // Disable erasure
-    tty.c_lflag &= ~ECHONL; // Disable new-line echo
-    tty.c_lflag &= ~ISIG; // Disable interpretation of INTR, QUIT and SUSP
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY); // Turn off s/w flow ctrl
-    tty.c_iflag &= ~(IGNBRK|BRKINT|PARMRK|ISTRIP|INLCR|IGNCR|ICRNL); // Disable any special handling of received bytes
-
-    tty.c_oflag &= ~OPOST; // Prevent special interpretation of output bytes (e.g. newline chars)
-    tty.c_oflag &= ~ONLCR; // Prevent conversion of newline to carriage return/line feed
-    // tty.c_oflag &= ~OXTABS; // Prevent conversion of tabs to spaces (NOT PRESENT ON LINUX)
-    // tty.c_oflag &= ~ONOEOT; // Prevent removal of C-d chars (0x004) in output (NOT PRESENT ON LINUX)
-
-    tty.c_cc[VTIME] = 1;    // Wait for up to 1s (10 deciseconds), returning as soon as any data is received.
-    tty.c_cc[VMIN] = 0;
-
-    // Set in/out baud rate to be 9600
-    cfsetispeed(&tty, B9600);
-    cfsetospeed(&tty, B9600);
-
-    // Save tty settings, also checking for error
-    if (tcsetattr(m_iFd, TCSANOW, &tty) != 0) {
-        LERROR("pid(%d) From tcsetattr: %s", getpid(), strerror(errno));
+    // No process per port: the shared I/O thread watches the fd and publishes what arrives.
+    if(!EventLoop::instance().addReader(m_iFd, [this](std::span<const char> data) { onData(data); },
+                                        [this]() { return reserveRead(); })) {
         clean();
         return -1;
     }
+    m_bRegistered = true;
+    return 0;
+}
 
-    sleep(2);
-    
-    if(fork() == 0) {
-        *m_pidChildProcess = getpid();
-        LDEBUG("pid(%d) Created child process.", m_pidChildProcess);
-
-        struct epoll_event event;
-        struct epoll_event* events;
-        int length = 0;
-        
-        m_iEpollFd = epoll_create1(0);
-        event.data.fd = m_iFd;
-        event.events = EPOLLIN | EPOLLET;
-
-        epoll_ctl(m_iEpollFd, EPOLL_CTL_ADD, m_iFd, &event);
-        events = (struct epoll_event*)calloc(MAX_EVENTS, sizeof(event));
-
-        int n;
-        struct DataBlob* buffer = new DataBlob;
-        for(;;) {
-            if((n = epoll_wait(m_iEpollFd, events, MAX_EVENTS, 5000)) > 0) {
-                if((length = ::read(events[0].data.fd, buffer->m_carrRawData, sizeof(buffer->m_carrRawData))) > 0) {
-                    m_spBase->m_bqBuffer->write(*buffer);
-                    LINFO("epoll: buffer: %s\n", buffer->m_carrRawData);
-                } else LINFO("No data within 5 seconds. \n");
-            }
+void SerialPort::SerialPortImpl::onData(std::span<const char> data) {
+    if(data.empty()) {
+        LINFO("Serial port %s hung up.", m_spBase->comPort.c_str());
+        // Readers drain what is left, then get 0 instead of waiting for bytes that never come.
+        m_sbrInbound.close();
+        return;
+    }
+    // Stamped first, as close to the wire as it gets.
+    if(m_pCapture)
+        m_pCapture->record(data, SerialCapture::now());
+
+    // Readers in this process.
+    const size_t kept = m_sbrInbound.write(data);
+    if(kept < data.size() && m_atuOverruns.fetch_add(data.size() - kept, std::memory_order_relaxed) == 0)
+        LERROR("pid(%d) Serial port %s: reader too slow, inbound bytes dropped.", getpid(), m_spBase->comPort.c_str());
+
+    // Readers in other processes. On epoll the bytes were read straight into the queue;
+    // io_uring picks its own buffers, so those are copied over.
+    const bool inPlace = data.data() == m_spReserved.data();
+    m_spReserved = {};
+    if(!inPlace) {
+        std::span<char> buffer = m_spBase->m_bqBuffer->reserve(data.size());
+        if(buffer.empty()) {
+            LERROR("pid(%d) Serial port %s: queue full, dropped %zu bytes.", getpid(), m_spBase->comPort.c_str(), data.size());
+            return;
         }
+        std::memcpy(buffer.data(), data.data(), data.size());
+    }
+    m_spBase->m_bqBuffer->commit(data.size());
+    LDEBUG("serial: buffer: %.*s", (int)data.size(), data.data());
+}
 
-        free(events);
-        clean();
+std::span<char> SerialPort::SerialPortImpl::reserveRead() {
+    // A reservation left over from a read that found nothing is simply taken again.
+    m_spReserved = m_spBase->m_bqBuffer->reserve(READ_CHUNK_SIZE);
+    return m_spReserved;
+}
+
+//###################################################################################################
+// Capture.
+//###################################################################################################
+
+bool SerialPort::SerialPortImpl::startCapture(const std::string& path, std::string& err_message)
+{
+    auto capture = std::make_unique<CaptureWriter>(path, err_message);
+    if(!capture->isOpen())
+        return false;
+    EventLoop::instance().runSync([&]() { m_pCapture.swap(capture); });
+    // The one replaced, if any, finishes writing here rather than on the I/O thread.
+    return true;
+}
+
+void SerialPort::SerialPortImpl::stopCapture()
+{
+    std::unique_ptr<CaptureWriter> capture;
+    EventLoop::instance().runSync([&]() { m_pCapture.swap(capture); });
+}
+
+//###################################################################################################
+// Modem lines.
+//###################################################################################################
+
+bool SerialPort::SerialPortImpl::setDtr(bool on)
+{
+    int line = TIOCM_DTR;
+    if(m_iFd == SFD_UNAVAILABLE || ioctl(m_iFd, on ? TIOCMBIS : TIOCMBIC, &line) != 0) {
+        LERROR("pid(%d) Serial port %s: DTR: %s", getpid(), m_spBase->comPort.c_str(), strerror(errno));
+        return false;
     }
-    return 0;
+    return true;
 }
 
 //###################################################################################################
@@ -220,7 +295,39 @@ int SerialPort::SerialPortImpl::connect() {
 
 std::string SerialPort::SerialPortImpl::read()
 {
-    return "";
+    // Whatever has arrived, without waiting.
+    std::string data(m_sbrInbound.available(), '\0');
+    data.resize(m_sbrInbound.read(data));
+    return data;
+}
+
+std::size_t SerialPort::SerialPortImpl::read(std::span<char> out, std::chrono::nanoseconds timeout)
+{
+    if(out.empty() || !m_sbrInbound.wait(0, timeout))
+        return 0;
+    return m_sbrInbound.read(out);
+}
+
+bool SerialPort::SerialPortImpl::readUntil(std::string& line, char delimiter, std::chrono::nanoseconds timeout)
+{
+    // Only the new bytes are searched after each wake-up.
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for(size_t searched = 0;;) {
+        const size_t have = m_sbrInbound.available();
+        const size_t at = m_sbrInbound.find(delimiter, searched);
+        if(at != SpscByteRing::npos) {
+            line.resize(at + 1);
+            m_sbrInbound.read(line);
+            break;
+        }
+        searched = have;
+        std::chrono::nanoseconds left = WAIT_FOREVER;
+        if(timeout.count() >= 0 && (left = deadline - std::chrono::steady_clock::now()).count() <= 0)
+            return false;
+        if(!m_sbrInbound.wait(searched, left))
+            return false;
+    }
+    return true;
 }
 
 //###################################################################################################
@@ -229,9 +336,11 @@ std::string SerialPort::SerialPortImpl::read()
 
 std::size_t SerialPort::SerialPortImpl::write(void *data, std::size_t data_len)
 {
-    (void)data;
-    (void)data_len;
-    return 0;
+    // Queued on the I/O thread: back-to-back writes leave as one, whenever the device takes them.
+    if(!m_bRegistered)
+        return 0;
+    EventLoop::instance().write(m_iFd, std::span<const char>(static_cast<const char*>(data), data_len));
+    return data_len;
 }
 
 //###################################################################################################
@@ -55,7 +55,7 @@ private:
 SerialPort::SerialPort(std::string comPort, PortUtils::Serial::BaudRate baudRate) : comPort(comPort), m_pimpl(std::make_unique<SerialPortImpl>(this, baudRate)) {
     std::string err = "";
     std::string bufferName = PortUtils::shMemPortNameParser(comPort, "/");
-    m_bqBuffer = new BufferQueue(12, bufferName, err);
+    m_bqBuffer = new BufferQueue(BUFFER_QUEUE_CAPACITY, bufferName, err);
     if (err != "") LERROR(err.c_str());
     config = PortUtils::Serial::PortConfig();
     config.nComRate = baudRate;
@@ -64,7 +64,7 @@ SerialPort::SerialPort(std::string comPort, PortUtils::Serial::BaudRate baudRate
 SerialPort::SerialPort(std::string comPort, PortUtils::Serial::PortConfig config): comPort(comPort), m_pimpl(std::make_unique<SerialPortImpl>(this, config)) {
     std::string err = "";
     std::string bufferName = PortUtils::shMemPortNameParser(comPort, "/");
-    m_bqBuffer = new BufferQueue(12, bufferName, err);
+    m_bqBuffer = new BufferQueue(BUFFER_QUEUE_CAPACITY, bufferName, err);
     if (err != "") LERROR(err.c_str());
     this->config = config;
 }
@@ -74,6 +74,27 @@ void SerialPort::flush(){ pimpl()->flush(); }
 int SerialPort::connect(){ return pimpl()->connect(); }
 std::size_t SerialPort::write(void *data, std::size_t data_len) { return pimpl()->write(data, data_len); }
 std::string SerialPort::read() { return pimpl()->read(); }
+// The buffered pipeline is Linux only for now (EventLoop).
+std::size_t SerialPort::read(std::span<char>, std::chrono::nanoseconds) { return 0; }
+bool SerialPort::readUntil(std::string&, char, std::chrono::nanoseconds) { return false; }
+std::size_t SerialPort::getOverruns() const { return 0; }
+bool SerialPort::setDtr(bool) { return false; }
+bool SerialPort::startCapture(const std::string&, std::string& err_message) { err_message = "Capture|not supported on macOS."; return false; }
+void SerialPort::stopCapture() {}
+SerialPort::ReadinessProbe SerialPort::dtrReset(std::chrono::milliseconds) { return [](SerialPort&) { return false; }; }
+SerialPort::ReadinessProbe SerialPort::waitForBanner(std::string, std::chrono::milliseconds) { return [](SerialPort&) { return false; }; }
+
+std::future<int> SerialPort::connectAsync(ReadinessProbe probe) {
+    return std::async(std::launch::async, [this, probe = std::move(probe)]() {
+        if(connect() != 0)
+            return -1;
+        if(probe && !probe(*this)) {
+            pimpl()->clean();
+            return -1;
+        }
+        return 0;
+    });
+}
 
 //###################################################################################################
 // MacOS platform implementation.
@@ -124,57 +145,15 @@ int SerialPort::SerialPortImpl::connect() {
         return(-1);
     }
 
-    // Reference: https://blog.mbedded.ninja/programming/operating-systems/linux/linux-serial-ports-using-c-cpp/
-    // Create new termios struct, we call it 'tty' for convention
-    // No need for "= {0}" at the end as we'll immediately write the existing
-    // config to this struct.
-    struct termios tty;
-
-    // Read in existing settings, and handle any error
-    // NOTE: This is important! POSIX states that the struct passed to tcsetattr()
-    // must have been initialized with a call to tcgetattr() overwise behaviour
-    // is undefined.
-    if(tcgetattr(m_iFd, &tty) != 0) {
-        LERROR("pid(%d) From tcgetattr: %s", getpid(), strerror(errno));
+    std::string err;
+    if(!PortUtils::Serial::applyConfig(m_iFd, m_spBase->config, err)) {
+        LERROR("pid(%d) %s: %s", getpid(), m_spBase->comPort.c_str(), err.c_str());
         clean();
         return -1;
     }
-
-    tty.c_cflag &= ~PARENB; // Clear parity bit, disabling parity (most common)
-    tty.c_cflag &= ~CSTOPB; // Clear stop field, only one stop bit used in communication (most common)
-    tty.c_cflag &= ~CSIZE; // Clear all bits that set the data size 
-    tty.c_cflag |= CS8; // 8 bits per byte (most common)
-    tty.c_cflag &= ~CRTSCTS; // Disable RTS/CTS hardware flow control (most common)
-    tty.c_cflag |= CREAD | CLOCAL; // Turn on READ & ignore ctrl lines (CLOCAL = 1)
-
-    tty.c_lflag &= ~ICANON;
-    tty.c_lflag &= ~ECHO; // Disable echo
-    tty.c_lflag &= ~ECHOE; // Disable erasure
-    tty.c_lflag &= ~ECHONL; // Disable new-line echo
-    tty.c_lflag &= ~ISIG; // Disable interpretation of INTR, QUIT and SUSP
-    tty.c_iflag &= ~(IXON | IXOFF | IXANY); // Turn off s/w flow ctrl
-    tty.c_iflag &= ~(IGNBRK|BRKINT|PARMRK|ISTRIP|INLCR|IGNCR|ICRNL); // Disable any special handling of received bytes
-
-    tty.c_oflag &= ~OPOST; // Prevent special interpretation of output bytes (e.g. newline chars)
-    tty.c_oflag &= ~ONLCR; // Prevent conversion of newline to carriage return/line feed
-    // tty.c_oflag &= ~OXTABS; // Prevent conversion of tabs to spaces (NOT PRESENT ON LINUX)
-    // tty.c_oflag &= ~ONOEOT; // Prevent removal of C-d chars (0x004) in output (NOT PRESENT ON LINUX)
-
-    tty.c_cc[VTIME] = 1;    // Wait for up to 1s (10 deciseconds), returning as soon as any data is received.
-    tty.c_cc[VMIN] = 0;
-
-    // Set in/out baud rate to be 9600
-    cfsetispeed(&tty, B9600);
-    cfsetospeed(&tty, B9600);
-
-    // Save tty settings, also checking for error
-    if (tcsetattr(m_iFd, TCSANOW, &tty) != 0) {
-        LERROR("pid(%d) From tcsetattr: %s", getpid(), strerror(errno));
-        clean();
-        return -1;
-    }
-
-    sleep(2);
+    const uint32_t rate = PortUtils::Serial::getBaudRate(m_iFd);
+    if(rate != m_spBase->config.nComRate)
+        LINFO("Serial port %s runs at %u baud, %u requested.", m_spBase->comPort.c_str(), rate, (unsigned)m_spBase->config.nComRate);
 
     // Spawn process for serial buffer check.
     if(fork() == 0){
@@ -242,14 +221,15 @@ std::string SerialPort::SerialPortImpl::read()
     return std::string(buf);*/
     
     //char buf[255] = {0};
-    struct DataBlob* buffer = new DataBlob();
-    if(::read(m_iFd, buffer->m_carrRawData, sizeof(buffer->m_carrRawData)) < 0) {
+    std::vector<char> buffer(READ_CHUNK_SIZE);
+    ssize_t length = ::read(m_iFd, buffer.data(), buffer.size());
+    if(length < 0) {
         LERROR("pid(%d) Error reading from device: %s", getpid(), strerror(errno));
         return "";
     }
-    m_spBase->m_bqBuffer->write(*buffer);
-    LDEBUG("kevent: %s", buffer->m_carrRawData);
-    return std::string((char*)buffer->m_carrRawData);
+    m_spBase->m_bqBuffer->write(buffer.data(), length);
+    LDEBUG("kevent: %.*s", (int)length, buffer.data());
+    return std::string(buffer.data(), length);
 }
 
 //###################################################################################################
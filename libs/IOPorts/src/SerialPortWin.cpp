@@ -87,7 +87,7 @@ HRESULT inline SerialPort::SerialPortImpl::purge(){
 SerialPort::SerialPortImpl::SerialPortImpl(std::string com_port)
 {
     this->m_sComPort = com_port;
-    this->m_wSerialConf = {DEFAULT_COM_RATE, DEFAULT_COM_BITS, ONESTOPBIT, 0, COMMTIMEOUTS()};
+    this->m_wSerialConf = {DEFAULT_COM_RATE, DEFAULT_COM_BITS, ONESTOPBIT, DEFAULT_PARITY, COMMTIMEOUTS()};
     invalidateHandle(m_hThread);
     invalidateHandle(m_hThreadStarted);
     invalidateHandle(m_hThreadTerm);
@@ -215,7 +215,14 @@ HRESULT SerialPort::SerialPortImpl::setComParms()
     // Set our own parameters from Globals
     dcb.BaudRate = m_wSerialConf.nComRate;       // Baud (bit) rate
     dcb.ByteSize = (BYTE)m_wSerialConf.nComBits; // Number of bits(8)
-    dcb.Parity = m_wSerialConf.parity;           // No parity (0)
+    switch (m_wSerialConf.parity)
+    {
+    case Parity::Odd: dcb.Parity = ODDPARITY; break;
+    case Parity::Even: dcb.Parity = EVENPARITY; break;
+    case Parity::Mark: dcb.Parity = MARKPARITY; break;
+    case Parity::Space: dcb.Parity = SPACEPARITY; break;
+    default: dcb.Parity = NOPARITY; break;
+    }
     dcb.fDsrSensitivity = 0;
     dcb.fDtrControl = DTR_CONTROL_ENABLE;
     dcb.fOutxDsrFlow = 0;
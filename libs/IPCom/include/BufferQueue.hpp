@@ -2,20 +2,57 @@
 
 #include <include/SharedMessage.hpp>
 #include <include/SharedBufferQueue.hpp>
+#include <include/SharedSegment.hpp>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
 
 LIBEXP class BufferQueue {
 public:
-    BufferQueue(unsigned queueLen, std::string& shmem_name, std::string& err_message);
+    // 'capacity' is the size of the shared byte ring, rounded up to a power of two. The
+    // first process to open 'shmem_name' creates the queue, later ones attach to it as is.
+    BufferQueue(size_t capacity, std::string& shmem_name, std::string& err_message);
     ~BufferQueue();
-    bool try_read(DataBlob& d);
-    bool read(DataBlob& d);
-    bool write(const DataBlob& d);
+    // Removes the name; processes that have the queue open keep using it.
+    static void unlink(const std::string& shmem_name) { SharedSegment::unlink(shmem_name); }
+    bool isCreator() const { return m_ssSegment->isCreator(); }
+    bool try_read(std::vector<char>& message);
+    // Blocks until a message arrives, false if none did within 'timeout'.
+    bool read(std::vector<char>& message, std::chrono::nanoseconds timeout = WAIT_FOREVER);
+    bool write(const void* data, size_t length);
+    bool write(std::string_view message) { return write(message.data(), message.size()); }
+    // All records published with one index update, returns how many were written.
+    size_t writeBatch(std::span<const std::string_view> messages);
+    // Up to 'max' messages at once, waiting up to 'timeout' for the first. Returns the count.
+    size_t readBatch(std::vector<std::vector<char>>& messages, size_t max, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
+    // Waits up to 'timeout' for the slowest registered reader instead of lapping it.
+    bool write(const void* data, size_t length, std::chrono::nanoseconds timeout);
+
+    // Zero-copy producer: fill the span in place, then commit the bytes actually used.
+    std::span<char> reserve(size_t length);
+    bool commit(size_t length);
+    // Zero-copy consumer: use the span in place, release() is false if it was overwritten.
+    std::span<const char> peek();
+    std::span<const char> peek(std::chrono::nanoseconds timeout);
+    bool release();
+
+    // Messages this reader lost because the writer lapped it.
+    uint64_t getDropped() const { return m_cCursor.m_uDropped; }
+    // Every registered reader of the queue, this process or others.
+    std::vector<SharedBufferQueue::ConsumerStats> getConsumerStats() const;
+    size_t getMaxMessageSize() const { return m_qShared != nullptr ? m_qShared->getMaxMessageSize() : 0; }
 private:
-     // The read idx for this reader.
-    int32_t m_iRead_idx{ 0 };
-    unsigned m_uQueueLength;
+    // Readers take a consumer slot on their first read, so a process that only writes
+    // never shows up as a lagging reader.
+    SharedBufferQueue* reader();
+    bool m_bSlotRequested = false;
+
+    // The read position for this reader.
+    SharedBufferQueue::Cursor m_cCursor;
+    AdaptiveSpin m_asSpin;
 
-    // No ownership, just a plain old pointer.
-    // User is responsible to assign the pointer.
-    SharedBufferQueue* m_qShared;
-};
\ No newline at end of file
+    // Mapping of the shared segment, header followed by the byte ring.
+    std::unique_ptr<SharedSegment> m_ssSegment;
+    SharedBufferQueue* m_qShared = nullptr;
+};
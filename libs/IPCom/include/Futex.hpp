@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../platform.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Negative timeouts wait until woken.
+constexpr std::chrono::nanoseconds WAIT_FOREVER{ -1 };
+
+// Hint to the core that we are busy-waiting (frees pipeline resources for the sibling thread).
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Process-shared futex on a 32-bit word, which may live in a shared memory segment.
+class Futex {
+public:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32-bit integers.");
+
+    // Sleeps while 'word' still holds 'expected'. False only when the timeout expired.
+    static bool wait(const std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) {
+        timespec ts;
+        timespec* tsp = nullptr;
+        if (timeout.count() >= 0) {
+            ts.tv_sec = timeout.count() / 1000000000;
+            ts.tv_nsec = timeout.count() % 1000000000;
+            tsp = &ts;
+        }
+        // Not FUTEX_PRIVATE_FLAG: waiters and wakers are in different processes.
+        if (syscall(SYS_futex, &word, FUTEX_WAIT, expected, tsp, nullptr, 0) < 0)
+            return errno != ETIMEDOUT;
+        return true;
+    }
+
+    static void wake(const std::atomic<uint32_t>& word, int count = INT_MAX) {
+        syscall(SYS_futex, &word, FUTEX_WAKE, count, nullptr, nullptr, 0);
+    }
+};
+
+// Spin-then-sleep policy: spin up to a budget before falling back to the futex, doubling the
+// budget when spinning paid off and halving it when it did not. On a single core spinning
+// can only delay the thread we are waiting for, so the budget stays at zero.
+class AdaptiveSpin {
+public:
+    static constexpr uint32_t MIN_SPINS = 64;
+    static constexpr uint32_t MAX_SPINS = 1 << 14;
+
+    template <class Ready>
+    bool spin(Ready&& ready) {
+        for (uint32_t i = 0; i < m_uBudget; i++) {
+            if (ready()) {
+                m_uBudget = std::min(MAX_SPINS, m_uBudget * 2);
+                return true;
+            }
+            cpuRelax();
+        }
+        if (m_uBudget != 0) m_uBudget = std::max(MIN_SPINS, m_uBudget / 2);
+        return ready();
+    }
+
+    uint32_t getBudget() const { return m_uBudget; }
+
+private:
+    uint32_t m_uBudget = std::thread::hardware_concurrency() > 1 ? 1024 : 0;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <include/SharedMessage.hpp>
+#include "../platform.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+// Lock-free single-producer / multi-consumer broadcast ring.
+//
+// Every cell carries a sequence number: 2w+1 while message w is being copied in, 2w+2 once
+// it is complete. The writer never waits for readers; a reader that falls more than a lap
+// behind notices the newer sequence and skips ahead, counting what it lost. A read copies
+// the cell and re-checks the sequence afterwards, so a copy torn by the writer is retried
+// instead of returned.
+//
+// The ring is position independent: the header is followed directly by its cells, so the
+// whole thing can be placed at the start of a shared memory segment of segmentSize() bytes.
+
+template <typename T>
+class SeqlockRing {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "SeqlockRing payloads are copied with memcpy.");
+
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<uint64_t> m_atuSeq{ 0 };
+        T m_tData;
+    };
+
+    // Per-consumer state, lives in the reader's own memory.
+    struct Cursor {
+        uint64_t m_uNext = 0;
+        uint64_t m_uDropped = 0;
+    };
+
+    static constexpr size_t segmentSize(uint32_t capacity) {
+        return sizeof(SeqlockRing) + sizeof(Cell) * capacity;
+    }
+
+    // Must be constructed in a block of at least segmentSize(capacity) bytes.
+    explicit SeqlockRing(uint32_t capacity) : m_uCapacity(capacity) {
+        for (uint32_t i = 0; i < m_uCapacity; i++)
+            new (&cells()[i]) Cell();
+    }
+
+    ~SeqlockRing() {
+        for (uint32_t i = 0; i < m_uCapacity; i++)
+            cells()[i].~Cell();
+    }
+
+    SeqlockRing(const SeqlockRing&) = delete;
+    SeqlockRing& operator=(const SeqlockRing&) = delete;
+
+    // Single producer only. Never blocks, the oldest message is overwritten when full.
+    void write(const T& value) {
+        const uint64_t idx = m_atuWrite_idx.load(std::memory_order_relaxed);
+        Cell& cell = cells()[idx % m_uCapacity];
+
+        cell.m_atuSeq.store(2 * idx + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&cell.m_tData, &value, sizeof(T));
+        cell.m_atuSeq.store(2 * idx + 2, std::memory_order_release);
+
+        m_atuWrite_idx.store(idx + 1, std::memory_order_release);
+    }
+
+    // Copies the next message for this cursor into 'out'. False when there is nothing new.
+    bool tryRead(Cursor& cursor, T& out) const {
+        for (;;) {
+            const uint64_t written = m_atuWrite_idx.load(std::memory_order_acquire);
+            if (cursor.m_uNext >= written) return false;
+
+            // More than a lap behind, the oldest messages are gone.
+            if (written - cursor.m_uNext > m_uCapacity) skipTo(cursor, written - m_uCapacity);
+
+            const Cell& cell = cells()[cursor.m_uNext % m_uCapacity];
+            const uint64_t expected = 2 * cursor.m_uNext + 2;
+            const uint64_t before = cell.m_atuSeq.load(std::memory_order_acquire);
+            if (before != expected) {
+                // The writer has lapped us on this cell since 'written' was loaded.
+                lapped(cursor, before);
+                continue;
+            }
+
+            std::memcpy(&out, &cell.m_tData, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t after = cell.m_atuSeq.load(std::memory_order_relaxed);
+            if (after != expected) {
+                // Torn copy, the cell was reused while we read it.
+                lapped(cursor, after);
+                continue;
+            }
+
+            cursor.m_uNext++;
+            return true;
+        }
+    }
+
+    // Starts a cursor at the next message to be written, skipping the backlog.
+    Cursor latest() const { return Cursor{ m_atuWrite_idx.load(std::memory_order_acquire), 0 }; }
+
+    uint64_t getWriteIdx() const { return m_atuWrite_idx.load(std::memory_order_acquire); }
+    uint32_t getCapacity() const { return m_uCapacity; }
+
+private:
+    Cell* cells() { return reinterpret_cast<Cell*>(reinterpret_cast<char*>(this) + sizeof(SeqlockRing)); }
+    const Cell* cells() const { return reinterpret_cast<const Cell*>(reinterpret_cast<const char*>(this) + sizeof(SeqlockRing)); }
+
+    static void skipTo(Cursor& cursor, uint64_t next) {
+        if (next <= cursor.m_uNext) return;
+        cursor.m_uDropped += next - cursor.m_uNext;
+        cursor.m_uNext = next;
+    }
+
+    void lapped(Cursor& cursor, uint64_t seq) const {
+        // seq is 2w+1 or 2w+2 for the message w now in (or entering) our cell, w is at least
+        // a lap ahead of us. The oldest message that can still be intact is w + 1 - capacity.
+        const uint64_t w = (seq - 1) / 2;
+        skipTo(cursor, w + 1 - m_uCapacity);
+    }
+
+    uint32_t m_uCapacity;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_atuWrite_idx{ 0 };
+};
@@ -8,24 +8,33 @@
 #include <sys/stat.h>
 #include <sys/shm.h>
 
-template <typename T>
-LIBEXP T* shalloc(const std::string& shmem_name, std::string& err_message ) {
+// Maps 'size' bytes of the named POSIX shared memory object, creating it if needed.
+inline void* shalloc(const std::string& shmem_name, size_t size, std::string& err_message) {
     int fd = -1;
     if((fd = shm_open(shmem_name.c_str(), O_CREAT | O_RDWR, 0666)) < 0) {
         err_message = "Open failed.";
         return nullptr;
     }
 
-    if(ftruncate(fd, sizeof(T)) < 0) {
+    if(ftruncate(fd, size) < 0) {
         err_message = "Truncate failed.";
+        close(fd);
         return nullptr;
     }
 
-    T* shmem = nullptr;
-    if ((shmem = (T*)mmap(NULL, sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+    void* shmem = nullptr;
+    if ((shmem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
         err_message = "mmap failed.";
+        close(fd);
         return nullptr;
     }
 
+    // The mapping keeps the object alive, the descriptor is no longer needed.
+    close(fd);
     return shmem;
-}
\ No newline at end of file
+}
+
+template <typename T>
+LIBEXP T* shalloc(const std::string& shmem_name, std::string& err_message ) {
+    return (T*)shalloc(shmem_name, sizeof(T), err_message);
+}
@@ -1,40 +1,214 @@
 #pragma once
 
-#include <memory>
-#include <atomic>
 #include <include/SharedAlloc.hpp>
 #include <include/SharedMessage.hpp>
-#include <include/SpinLock.hpp>
+#include <include/Futex.hpp>
 #include "../platform.hpp"
+#include <atomic>
+#include <string>
+#include <span>
+#include <string_view>
+#include <vector>
 
-using Lock = SpinLock;
-
+// Lock-free single-producer / multi-consumer broadcast ring of variable-size records.
+//
+// The header sits at the start of the shared segment and the byte ring follows it, so only
+// the bytes of each message are written and read. Positions grow monotonically, offsets are
+// position & (capacity - 1). Before overwriting old bytes the writer advances the tail to
+// the first record that survives; a reader validates its copy against the tail afterwards
+// and, if the writer lapped it, resynchronises at the tail instead of returning torn data.
+//
+// The header holds no pointers, only sizes and positions, so every process can map the
+// segment at a different address. The creator constructs it and then marks it ready;
+// attach() lets other processes wait for that instead of re-constructing it.
+//
+// Besides the copying write/tryRead, both sides can work in place: reserve() hands the
+// producer a span inside the ring that commit() publishes, peek() hands a consumer a span
+// of the next record and release() tells it whether the bytes stayed intact meanwhile.
+//
+// Consumers may register a slot in the header that publishes their position, dropped count
+// and worst lag. Anybody can read these to spot slow readers, and the producer can use
+// them for backpressure: reserve()/write() with a timeout wait for the slowest registered
+// consumer instead of lapping it.
+//
+// Slots are leases stamped with the owner's PID and a heartbeat. A producer held back by
+// a consumer that died, or that showed no sign of life for a whole lease, takes its slot
+// back; consumers registering into a full table reclaim dead owners too. All of that runs
+// only on those slow paths, never per message.
 LIBEXP class SharedBufferQueue {
 public:
-    SharedBufferQueue(unsigned QueueLength);
-    ~SharedBufferQueue();
-    bool try_write(const DataBlob& DataBlob);
-    bool write(const DataBlob& DataBlob);
+    // Per-consumer state, lives in the reader's own memory.
+    struct Cursor {
+        uint64_t m_uPos = 0;
+        // Sequence expected next, UNKNOWN_SEQ until the first message is read.
+        uint64_t m_uNextSeq = 0;
+        uint64_t m_uDropped = 0;
+        // Record size and sequence handed out by peek(), 0 when nothing is pending.
+        uint64_t m_uPendingSize = 0;
+        uint64_t m_uPendingSeq = 0;
+        // Registered consumer slot, -1 when anonymous or evicted, and the lease held on it.
+        int32_t m_iSlot = -1;
+        uint64_t m_uLease = 0;
+    };
+    static constexpr uint32_t MAX_CONSUMERS = 16;
+
+    // Snapshot of a registered consumer, lags are in bytes.
+    struct ConsumerStats {
+        uint32_t m_uSlot;
+        int32_t m_iPid;
+        uint64_t m_uLag;
+        uint64_t m_uHighWater;
+        uint64_t m_uReceived;
+        uint64_t m_uDropped;
+    };
+    static constexpr uint64_t UNKNOWN_SEQ = ~0ull;
+
+    // Capacity is in bytes and rounded up to a power of two.
+    static size_t roundCapacity(size_t capacity);
+    static size_t segmentSize(size_t capacity) { return sizeof(SharedBufferQueue) + roundCapacity(capacity); }
+
+    // Must be constructed in a block of at least segmentSize(capacity) bytes.
+    explicit SharedBufferQueue(size_t capacity);
+
+    // Called by the creator once constructed, attachers wait for it.
+    void markReady() { m_atuState.store(READY, std::memory_order_release); }
+    // The queue another process constructed in 'segment', nullptr with 'err_message' set
+    // if it does not become ready within 'timeout' or does not fit the segment.
+    static SharedBufferQueue* attach(void* segment, size_t segmentBytes, std::string& err_message,
+                                     std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+    SharedBufferQueue(const SharedBufferQueue&) = delete;
+    SharedBufferQueue& operator=(const SharedBufferQueue&) = delete;
+
+    // Single producer only. Never blocks, false if the message can never fit.
+    bool write(const void* data, size_t length);
+
+    // Backpressure: waits up to 'timeout' for every registered consumer to move out of the
+    // way instead of lapping them. False if the message does not fit or the wait expired.
+    bool write(const void* data, size_t length, std::chrono::nanoseconds timeout);
+
+    // Writes the records back to back and publishes them with one index update (one per
+    // ring's worth of bytes). Stops at a record that can never fit, returns how many went.
+    size_t writeBatch(std::span<const std::string_view> records);
+
+    // Room for up to 'length' bytes, written in place and published by commit(). Empty if
+    // the message can never fit. A reservation that is never committed is simply dropped.
+    std::span<char> reserve(size_t length);
+    // Same, but empty if the registered consumers did not make room within 'timeout'.
+    std::span<char> reserve(size_t length, std::chrono::nanoseconds timeout);
+    // Publishes the first 'length' bytes of the last reservation.
+    bool commit(size_t length);
 
-    Lock& getOperationLock() { return m_lOperationLock; }
-    std::atomic<int32_t>& getWriteIdx() { return m_atiWrite_idx; }
-    std::atomic<int32_t>& getFarthestReadIdx() { return m_atiFarthest_Read_idx; }
-    Cell* getQueueSharedMessages() { return m_ceQueueSharedMessages; }
+    // Copies the next message for this cursor into 'message', resized to the payload.
+    bool tryRead(Cursor& cursor, std::vector<char>& message) const;
 
-    void* operator new(size_t size, std::string& shmem_name, std::string& err_message) {
-        return (void*)shalloc<SharedBufferQueue>(shmem_name, err_message);
-    }
+    // Copies up to 'max' consecutive messages into 'messages', resized to the count, which
+    // is returned. They are validated against the tail once for the whole batch.
+    size_t readBatch(Cursor& cursor, std::vector<std::vector<char>>& messages, size_t max) const;
+
+    // The next message in place, empty when there is none. The bytes may be overwritten by
+    // a lapping writer while in use: release() returns false if that happened, in which case
+    // whatever was derived from them must be discarded. Either way the cursor moves on.
+    std::span<const char> peek(Cursor& cursor) const;
+    bool release(Cursor& cursor) const;
+
+    // Blocks until something past 'cursor' has been published or the timeout expires:
+    // spins per 'spin' first, then sleeps on a futex in the segment. Writers only pay for
+    // a wake-up syscall while somebody is asleep.
+    bool wait(const Cursor& cursor, std::chrono::nanoseconds timeout, AdaptiveSpin& spin) const;
+
+    // Starts a cursor at the next message to be written, skipping the backlog.
+    Cursor latest() const;
+
+    // Claims a free slot for 'cursor', false if all MAX_CONSUMERS are taken.
+    bool registerConsumer(Cursor& cursor);
+    void unregisterConsumer(Cursor& cursor);
+    std::vector<ConsumerStats> getConsumerStats() const;
+    // How long a consumer holding back a waiting producer may go without a heartbeat.
+    void setLeaseTimeout(std::chrono::nanoseconds timeout) { m_iLeaseTimeoutNs = timeout.count(); }
+    // Slots taken back from dead or stalled consumers.
+    uint64_t getEvictedConsumers() const { return m_atuEvicted.load(std::memory_order_relaxed); }
+
+    size_t getCapacity() const { return m_uCapacity; }
+    // Largest payload, half the ring so a record plus wrap padding always fits.
+    size_t getMaxMessageSize() const { return m_uCapacity / 2 - sizeof(MessageHeader); }
+    uint64_t getWritePos() const { return m_atuWrite_pos.load(std::memory_order_acquire); }
 
 private:
-    unsigned m_uQueueLength;
-    // Circular Buffer begin read and write indexes.
-    std::atomic<int32_t> m_atiWrite_idx{ 0 };
-    std::atomic<int32_t> m_atiFarthest_Read_idx{ 0 };
-    Lock m_lOperationLock;
-    Cell* m_ceQueueSharedMessages;
-
-    // class SharedBufferImpl;
-    // std::unique_ptr<SharedBufferImpl> m_pimpl;
-    // const SharedBufferImpl* pimpl() const { return m_pimpl.get(); }
-    // SharedBufferImpl* pimpl() { return m_pimpl.get(); }
-};
\ No newline at end of file
+    char* ring() { return reinterpret_cast<char*>(this) + sizeof(SharedBufferQueue); }
+    const char* ring() const { return reinterpret_cast<const char*>(this) + sizeof(SharedBufferQueue); }
+
+    // Moves the tail past every record the bytes up to 'end' will overwrite.
+    void reclaim(uint64_t end);
+    // Pads the rest of the ring if a record of 'length' at 'pos' would wrap. Returns where
+    // the record starts.
+    uint64_t placeRecord(uint64_t pos, size_t length);
+    // Makes everything up to 'end' visible and wakes sleeping readers.
+    void publish(uint64_t end);
+    // Position just past a record of 'length' bytes written at 'pos', wrap padding included.
+    uint64_t recordEnd(uint64_t pos, size_t length) const;
+
+    // Lowest position of a registered consumer, UINT64_MAX without any.
+    uint64_t slowestConsumer() const;
+    // Publishes the cursor to its slot and wakes a producer waiting on consumers.
+    void publishProgress(Cursor& cursor) const;
+    struct ConsumerSlot;
+    // The cursor's slot, nullptr (and the cursor unregistered) if it lost its lease.
+    ConsumerSlot* ownSlot(Cursor& cursor) const;
+    // Frees slots behind 'limit' whose owner died, or whose heartbeat is older than
+    // 'staleBefore'. Returns how many were freed.
+    uint32_t reclaimConsumers(uint64_t limit, int64_t staleBefore) const;
+
+    static constexpr uint64_t MAGIC = 0x31515542'4c58'5656ull;
+    static constexpr uint32_t READY = 1;
+    // Lease of a slot being set up by a registering consumer; never handed out as a token.
+    static constexpr uint64_t LEASE_CLAIMING = UINT64_MAX;
+    // A producer waiting for room rechecks consumer leases this often.
+    static constexpr std::chrono::milliseconds LEASE_POLL{ 10 };
+
+    // Every group below that is written by a different party gets its own pair of cache
+    // lines, so readers polling the positions never share a line with writer scratch state
+    // or with each other. The constructor checks the layout.
+
+    // Read-mostly: set by the creator, read by everybody on every access.
+    // Segment zero-fills on creation, so the state reads 0 until markReady().
+    alignas(FALSE_SHARING_SIZE) std::atomic<uint32_t> m_atuState{ 0 };
+    uint64_t m_uMagic = MAGIC;
+    uint64_t m_uCapacity;
+    uint64_t m_uMask;
+    // Writer-private, kept in the segment so the numbering survives the writer.
+    alignas(FALSE_SHARING_SIZE) uint64_t m_uNextSeq = 0;
+    uint64_t m_uReservedPos = 0;
+    uint64_t m_uReservedLength = 0;
+    bool m_bReserved = false;
+    int64_t m_iLeaseTimeoutNs = 1000000000;
+    // Written by the producer on every publish, read by every consumer, so kept together:
+    // write (published) and tail (oldest intact record) positions and the futex word.
+    alignas(FALSE_SHARING_SIZE) std::atomic<uint64_t> m_atuWrite_pos{ 0 };
+    std::atomic<uint64_t> m_atuTail_pos{ 0 };
+    std::atomic<uint32_t> m_atuPublished{ 0 };
+    // Written by consumers on their slow paths: readers asleep on m_atuPublished, and the
+    // counter bumped when one moves while the producer waits for room (backpressure).
+    alignas(FALSE_SHARING_SIZE) mutable std::atomic<uint32_t> m_atuSleepers{ 0 };
+    mutable std::atomic<uint32_t> m_atuConsumed{ 0 };
+    // Lease tokens handed out so far, and slots taken back.
+    mutable std::atomic<uint64_t> m_atuLeases{ 0 };
+    mutable std::atomic<uint64_t> m_atuEvicted{ 0 };
+    // Written by the producer when it blocks, read by consumers on every release.
+    alignas(FALSE_SHARING_SIZE) std::atomic<uint32_t> m_atuWriterWaiting{ 0 };
+
+    // Written only by the owning consumer, read by the producer and monitors.
+    struct alignas(FALSE_SHARING_SIZE) ConsumerSlot {
+        // Token of the current owner, 0 when free, LEASE_CLAIMING while being registered.
+        std::atomic<uint64_t> m_atuLease{ 0 };
+        std::atomic<int32_t> m_atiPid{ 0 };
+        // CLOCK_MONOTONIC ns, stamped on registration, before sleeping and while the
+        // producer waits.
+        std::atomic<int64_t> m_atiHeartbeat{ 0 };
+        std::atomic<uint64_t> m_atuPos{ 0 };
+        std::atomic<uint64_t> m_atuHighWater{ 0 };
+        std::atomic<uint64_t> m_atuReceived{ 0 };
+        std::atomic<uint64_t> m_atuDropped{ 0 };
+    };
+    mutable ConsumerSlot m_arrConsumers[MAX_CONSUMERS];
+};
@@ -1,20 +1,32 @@
 #pragma once
 
-#include <include/SpinLock.hpp>
-#include <include/Semaphore.hpp>
 #include "../platform.hpp"
+#include <cstddef>
+#include <cstdint>
 
-using Lock = SpinLock;
+constexpr size_t CACHE_LINE_SIZE = 64;
+// Fields written by different processes are kept this far apart: x86 prefetches cache lines
+// in adjacent pairs, so neighbours on a 64-byte boundary can still ping-pong.
+constexpr size_t FALSE_SHARING_SIZE = 2 * CACHE_LINE_SIZE;
 
-constexpr size_t RAW_DATA_CHAR_SIZE = 1024 * 1024 * 10;
+// Records in the shared byte ring: a header followed by 'm_uLength' payload bytes, padded
+// to RECORD_ALIGNMENT. A PADDING record fills the space left before the ring wraps.
+constexpr size_t RECORD_ALIGNMENT = 16;
 
-LIBEXP struct DataBlob {
-    double m_dCheckSum = -1;
-    char m_carrRawData[RAW_DATA_CHAR_SIZE];
+enum class RecordType : uint32_t {
+    MESSAGE = 1,
+    PADDING = 2
 };
 
-LIBEXP struct Cell {
-    Lock m_lWriterLock;
-    Semaphore m_sSem;
-    DataBlob m_dgData;
-};
\ No newline at end of file
+LIBEXP struct MessageHeader {
+    uint32_t m_uLength;
+    RecordType m_eType;
+    // Per-queue message number, lets readers count what they missed.
+    uint64_t m_uSeq;
+};
+
+static_assert(sizeof(MessageHeader) == RECORD_ALIGNMENT, "A padding record must fit in any gap.");
+
+constexpr size_t recordSize(size_t payload) {
+    return (sizeof(MessageHeader) + payload + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
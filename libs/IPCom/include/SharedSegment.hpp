@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../platform.hpp"
+#include <chrono>
+#include <string>
+
+// Named shared memory segment with a create-or-attach protocol.
+//
+// The first process to open a name creates (and sizes) the segment, everybody after that
+// attaches to it at whatever size the creator chose, so attachers never truncate or
+// re-initialise memory that is already in use. Segments of at least HUGE_PAGE_SIZE are
+// placed on hugetlbfs when it is mounted and has pages reserved, otherwise they live in
+// /dev/shm with transparent huge pages requested via madvise.
+LIBEXP class SharedSegment {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr const char* HUGETLBFS_DIR = "/dev/hugepages";
+
+    // 'size' only matters to the creator. Attachers wait up to 'timeout' for the creator
+    // to size the segment.
+    SharedSegment(const std::string& shmem_name, size_t size, std::string& err_message,
+                  std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    ~SharedSegment();
+
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+
+    void* getData() const { return m_pData; }
+    // Mapped size, rounded up to the huge page size on hugetlbfs.
+    size_t getSize() const { return m_uSize; }
+    bool isCreator() const { return m_bCreator; }
+    bool isHugePages() const { return m_bHugePages; }
+
+    // Removes the name (from hugetlbfs and /dev/shm). Existing mappings stay valid.
+    static void unlink(const std::string& shmem_name);
+
+private:
+    bool map(int fd, size_t size);
+
+    void* m_pData = nullptr;
+    size_t m_uSize = 0;
+    bool m_bCreator = false;
+    bool m_bHugePages = false;
+};
@@ -1,21 +1,61 @@
 #pragma once
 
 #include "../platform.hpp"
-#include <thread>
+#include <include/Futex.hpp>
+#include <algorithm>
 #include <atomic>
-#include <unistd.h>
+#include <cstdint>
+#include <thread>
 
-// A spinlock is a lock that causes a thread trying to acquire it 
-// to simply wait in a loop while repeatedly checking whether the 
+// A spinlock is a lock that causes a thread trying to acquire it
+// to simply wait in a loop while repeatedly checking whether the
 // lock is available.
+//
+// Waiting is done in three stages: spin on the lock word with pause hints, backing off
+// exponentially between attempts (1, 2, 4 ... MAX_BACKOFF pauses) until the spin budget is
+// spent, then park on a futex until the holder hands over. Short critical sections never
+// leave user space, long ones do not burn a core. The whole state is one 32-bit word with
+// no pointers, so the lock works between processes when it lives in shared memory.
 
 LIBEXP class SpinLock {
     public:
-        inline bool tryLock() { return !m_afFlag.test_and_set(); };
-        void lock(){ while(!tryLock()) usleep(m_uSpeedTimeUs); };
-        void unLock(){ m_afFlag.clear(); };
+        static constexpr uint32_t MAX_BACKOFF = 64;
+
+        // 'spins' is the number of pause hints to spend before parking. On a single core
+        // spinning can only delay the holder, so the default parks straight away there.
+        explicit SpinLock(uint32_t spins = std::thread::hardware_concurrency() > 1 ? 4096 : 0) : m_uSpinLimit(spins) {}
+
+        inline bool tryLock() {
+            uint32_t unlocked = UNLOCKED;
+            return m_atuState.compare_exchange_strong(unlocked, LOCKED, std::memory_order_acquire);
+        };
+
+        void lock() {
+            if (tryLock()) return;
+
+            uint32_t backoff = 1;
+            for (uint32_t spun = 0; spun < m_uSpinLimit; spun += backoff, backoff = std::min(2 * backoff, MAX_BACKOFF)) {
+                for (uint32_t i = 0; i < backoff; i++) cpuRelax();
+                // Read before writing, so waiters do not steal the line from the holder.
+                if (m_atuState.load(std::memory_order_relaxed) == UNLOCKED && tryLock()) return;
+            }
+
+            // Whoever takes the lock from here on marks it contended, so unLock() wakes
+            // the next sleeper.
+            while (m_atuState.exchange(CONTENDED, std::memory_order_acquire) != UNLOCKED)
+                Futex::wait(m_atuState, CONTENDED, WAIT_FOREVER);
+        };
+
+        void unLock() {
+            if (m_atuState.exchange(UNLOCKED, std::memory_order_release) == CONTENDED) Futex::wake(m_atuState, 1);
+        };
+
     private:
-        // std::atomic_flag is guaranteed to be lock-free.
-        std::atomic_flag m_afFlag { ATOMIC_FLAG_INIT };
-        uint32_t m_uSpeedTimeUs = 50;
+        static constexpr uint32_t UNLOCKED = 0;
+        static constexpr uint32_t LOCKED = 1;
+        static constexpr uint32_t CONTENDED = 2;
+
+        // Zero-filled shared memory is an unlocked lock.
+        std::atomic<uint32_t> m_atuState{ UNLOCKED };
+        uint32_t m_uSpinLimit;
 };
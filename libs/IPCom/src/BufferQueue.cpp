@@ -1,69 +1,127 @@
 #include <include/BufferQueue.hpp>
-#include <include/LockGuard.hpp>
 #include <include/SharedMessage.hpp>
 #include <include/Logger.hpp>
-#include <sys/mman.h>
-#include <assert.h>
 
+BufferQueue::BufferQueue(size_t capacity, std::string& shmem_name, std::string& err_message):
+    m_ssSegment(std::make_unique<SharedSegment>(shmem_name, SharedBufferQueue::segmentSize(capacity), err_message)) {
+    void* shmem = m_ssSegment->getData();
+    if (shmem == nullptr) return;
 
-BufferQueue::BufferQueue(unsigned queueLen, std::string& shmem_name, std::string& err_message): 
-    m_uQueueLength(queueLen), 
-    m_qShared(new(shmem_name, err_message) SharedBufferQueue(queueLen)) {}
+    if (m_ssSegment->isCreator()) {
+        m_qShared = new(shmem) SharedBufferQueue(capacity);
+        m_qShared->markReady();
+    } else {
+        // Somebody else owns the layout; their capacity wins. Messages published before we
+        // attached are not counted as dropped.
+        m_qShared = SharedBufferQueue::attach(shmem, m_ssSegment->getSize(), err_message);
+        m_cCursor.m_uNextSeq = SharedBufferQueue::UNKNOWN_SEQ;
+    }
+}
 
 BufferQueue::~BufferQueue() {
-    munmap(m_qShared, sizeof(*m_qShared));
+    if (m_qShared != nullptr) m_qShared->unregisterConsumer(m_cCursor);
 }
 
-bool BufferQueue::try_read(DataBlob& d){
-    Cell* cellPtr;
-    
-    {
-        // make sure index operation is locked.
-        // Index operation is light-weighted.
-        // Using a lock doesn't hurt performance much.
-        LockGuard lock(m_qShared->getOperationLock());
-
-        if (m_iRead_idx >= m_qShared->getWriteIdx()) return false; 
-
-        // Jump to lastest message.
-        // It is the flexibility of shared memory. In TCP, you can't do this.
-        if (m_iRead_idx < m_qShared->getFarthestReadIdx()) {
-            const int32_t last_read_idx = m_iRead_idx;
-            m_iRead_idx = m_qShared->getFarthestReadIdx().load();
-            // It doesn't hold when int overflow
-            assert(last_read_idx < m_iRead_idx);
-        }
+SharedBufferQueue* BufferQueue::reader() {
+    if (m_qShared != nullptr && !m_bSlotRequested) {
+        m_bSlotRequested = true;
+        if (!m_qShared->registerConsumer(m_cCursor))
+            LDEBUG("reader|all %u consumer slots taken, reading unregistered", SharedBufferQueue::MAX_CONSUMERS);
+    }
+    return m_qShared;
+}
 
-        cellPtr = &m_qShared->getQueueSharedMessages()[m_iRead_idx % m_uQueueLength];
-
-        // Using a semaphore to track how many process is reading the current message.
-        // "signal" a reader is here
-        cellPtr->m_sSem.increase();
-
-        // Check if someone is writing to this cell
-        // This only happen if the queue warp around.
-        if (!cellPtr->m_lWriterLock.tryLock()) {
-            cellPtr->m_sSem.decrease();
-            LINFO("try_read|someone is writing");
-            LINFO("try_read|m.test_num :%f", cellPtr->m_dgData.m_dCheckSum);
-            return false;
-        } else {
-            // Unlock it since I lock the cell in if statement.
-            cellPtr->m_lWriterLock.unLock();
-        }
+bool BufferQueue::try_read(std::vector<char>& message) {
+    if (reader() == nullptr) return false;
 
-        ++m_iRead_idx;
+    // No locks: the copy is validated against the ring tail and retried if torn.
+    // A reader that was lapped resumes at the oldest record still in the ring.
+    const uint64_t dropped = m_cCursor.m_uDropped;
+    const bool read = m_qShared->tryRead(m_cCursor, message);
+    if (m_cCursor.m_uDropped != dropped)
+        LDEBUG("try_read|lapped, skipped %llu messages", (unsigned long long)(m_cCursor.m_uDropped - dropped));
+    return read;
+}
 
-    }
+bool BufferQueue::read(std::vector<char>& message, std::chrono::nanoseconds timeout) {
+    if (reader() == nullptr) return false;
 
-    d = cellPtr->m_dgData;
-    // TODO: what if program crashes here? RAII ?
-    cellPtr->m_sSem.decrease();
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!try_read(message)) {
+        std::chrono::nanoseconds remaining = WAIT_FOREVER;
+        if (timeout.count() >= 0) {
+            remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining.count() <= 0) return false;
+        }
+        if (!m_qShared->wait(m_cCursor, remaining, m_asSpin)) return false;
+    }
+    return true;
+}
+bool BufferQueue::write(const void* data, size_t length) {
+    if (m_qShared == nullptr) return false;
+    if (!m_qShared->write(data, length)) {
+        LERROR("write|message of %zu bytes exceeds the queue limit of %zu", length, m_qShared->getMaxMessageSize());
+        return false;
+    }
     return true;
 }
 
-bool BufferQueue::read(DataBlob& d) { return try_read(d); }
-bool BufferQueue::write(const DataBlob& d) { 
-    m_qShared->write(d); 
+bool BufferQueue::write(const void* data, size_t length, std::chrono::nanoseconds timeout) {
+    if (m_qShared == nullptr) return false;
+    if (!m_qShared->write(data, length, timeout)) {
+        LDEBUG("write|no room for %zu bytes, slowest reader did not catch up", length);
+        return false;
+    }
     return true;
 }
+
+size_t BufferQueue::writeBatch(std::span<const std::string_view> messages) {
+    if (m_qShared == nullptr) return 0;
+    const size_t written = m_qShared->writeBatch(messages);
+    if (written != messages.size())
+        LERROR("writeBatch|message of %zu bytes exceeds the queue limit of %zu", messages[written].size(), m_qShared->getMaxMessageSize());
+    return written;
+}
+
+size_t BufferQueue::readBatch(std::vector<std::vector<char>>& messages, size_t max, std::chrono::nanoseconds timeout) {
+    if (reader() == nullptr) return 0;
+    const uint64_t dropped = m_cCursor.m_uDropped;
+    size_t count = m_qShared->readBatch(m_cCursor, messages, max);
+    if (count == 0 && timeout.count() != 0 && m_qShared->wait(m_cCursor, timeout, m_asSpin))
+        count = m_qShared->readBatch(m_cCursor, messages, max);
+    if (m_cCursor.m_uDropped != dropped)
+        LDEBUG("readBatch|lapped, skipped %llu messages", (unsigned long long)(m_cCursor.m_uDropped - dropped));
+    return count;
+}
+
+std::vector<SharedBufferQueue::ConsumerStats> BufferQueue::getConsumerStats() const {
+    if (m_qShared == nullptr) return {};
+    return m_qShared->getConsumerStats();
+}
+
+std::span<char> BufferQueue::reserve(size_t length) {
+    if (m_qShared == nullptr) return {};
+    return m_qShared->reserve(length);
+}
+
+bool BufferQueue::commit(size_t length) { return m_qShared != nullptr && m_qShared->commit(length); }
+
+std::span<const char> BufferQueue::peek() {
+    if (reader() == nullptr) return {};
+    return m_qShared->peek(m_cCursor);
+}
+
+std::span<const char> BufferQueue::peek(std::chrono::nanoseconds timeout) {
+    if (reader() == nullptr) return {};
+    std::span<const char> record = m_qShared->peek(m_cCursor);
+    if (m_cCursor.m_uPendingSize == 0 && m_qShared->wait(m_cCursor, timeout, m_asSpin))
+        record = m_qShared->peek(m_cCursor);
+    return record;
+}
+
+bool BufferQueue::release() {
+    if (m_qShared == nullptr) return false;
+    const bool intact = m_qShared->release(m_cCursor);
+    if (!intact) LDEBUG("release|record overwritten while in use");
+    return intact;
+}
@@ -1,53 +1,462 @@
 #include <include/SharedBufferQueue.hpp>
 #include <include/SharedMessage.hpp>
-#include <include/LockGuard.hpp>
-#include <include/Logger.hpp>
-#include <assert.h>
+#include <algorithm>
+#include <cstddef>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <signal.h>
+#include <type_traits>
+#include <unistd.h>
 
-SharedBufferQueue::SharedBufferQueue(unsigned QueueLength): m_uQueueLength(QueueLength){
-    m_ceQueueSharedMessages = new Cell[QueueLength];
+static int64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
-SharedBufferQueue::~SharedBufferQueue(){
-    delete[] m_ceQueueSharedMessages;
+size_t SharedBufferQueue::roundCapacity(size_t capacity) {
+    size_t rounded = 2 * recordSize(0);
+    while (rounded < capacity) rounded <<= 1;
+    return rounded;
 }
 
-bool SharedBufferQueue::try_write(const DataBlob& DataBlob){
-    Cell& m = m_ceQueueSharedMessages[m_atiWrite_idx % m_uQueueLength];
+SharedBufferQueue::SharedBufferQueue(size_t capacity):
+    m_uCapacity(roundCapacity(capacity)),
+    m_uMask(m_uCapacity - 1) {
+    // The header is shared by processes that each write their own part of it.
+    static_assert(std::is_standard_layout_v<SharedBufferQueue>, "The header must have a fixed layout.");
+    static_assert(sizeof(SharedBufferQueue) % FALSE_SHARING_SIZE == 0, "The ring must start on its own line.");
+    static_assert(offsetof(SharedBufferQueue, m_uMask) < FALSE_SHARING_SIZE, "Read-mostly fields share the first line.");
+    static_assert(offsetof(SharedBufferQueue, m_uNextSeq) == FALSE_SHARING_SIZE, "Writer scratch needs its own line.");
+    static_assert(offsetof(SharedBufferQueue, m_atuWrite_pos) == 2 * FALSE_SHARING_SIZE, "Published positions need their own line.");
+    static_assert(offsetof(SharedBufferQueue, m_atuPublished) < 3 * FALSE_SHARING_SIZE, "Publish state shares one line.");
+    static_assert(offsetof(SharedBufferQueue, m_atuSleepers) == 3 * FALSE_SHARING_SIZE, "Consumer-written words need their own line.");
+    static_assert(offsetof(SharedBufferQueue, m_atuWriterWaiting) == 4 * FALSE_SHARING_SIZE, "The backpressure flag needs its own line.");
+    static_assert(offsetof(SharedBufferQueue, m_arrConsumers) == 5 * FALSE_SHARING_SIZE, "Consumer slots start on their own line.");
+    static_assert(sizeof(ConsumerSlot) == FALSE_SHARING_SIZE, "One consumer slot per line.");
+}
+
+SharedBufferQueue* SharedBufferQueue::attach(void* segment, size_t segmentBytes, std::string& err_message, std::chrono::milliseconds timeout) {
+    auto* queue = static_cast<SharedBufferQueue*>(segment);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (queue->m_atuState.load(std::memory_order_acquire) != READY) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            err_message = "Queue was never initialized.";
+            return nullptr;
+        }
+        usleep(100);
+    }
+
+    if (queue->m_uMagic != MAGIC || segmentSize(queue->m_uCapacity) > segmentBytes) {
+        err_message = "Segment does not hold a compatible queue.";
+        return nullptr;
+    }
+    return queue;
+}
+
+bool SharedBufferQueue::write(const void* data, size_t length) {
+    std::span<char> payload = reserve(length);
+    if (payload.size() != length) return false;
+    std::memcpy(payload.data(), data, length);
+    return commit(length);
+}
+
+bool SharedBufferQueue::write(const void* data, size_t length, std::chrono::nanoseconds timeout) {
+    std::span<char> payload = reserve(length, timeout);
+    if (payload.size() != length) return false;
+    std::memcpy(payload.data(), data, length);
+    return commit(length);
+}
+
+uint64_t SharedBufferQueue::recordEnd(uint64_t pos, size_t length) const {
+    const uint64_t offset = pos & m_uMask;
+    const uint64_t size = recordSize(length);
+    // Records never wrap: the rest of the ring becomes a padding record.
+    return (offset + size > m_uCapacity) ? pos + (m_uCapacity - offset) + size : pos + size;
+}
+
+std::span<char> SharedBufferQueue::reserve(size_t length) {
+    if (length > getMaxMessageSize()) return {};
+
+    const uint64_t pos = m_atuWrite_pos.load(std::memory_order_relaxed);
+    reclaim(recordEnd(pos, length));
+
+    m_uReservedPos = placeRecord(pos, length);
+    m_uReservedLength = length;
+    m_bReserved = true;
+    return { ring() + (m_uReservedPos & m_uMask) + sizeof(MessageHeader), length };
+}
+
+bool SharedBufferQueue::commit(size_t length) {
+    if (!m_bReserved || length > m_uReservedLength) return false;
+
+    MessageHeader header{ static_cast<uint32_t>(length), RecordType::MESSAGE, m_uNextSeq++ };
+    std::memcpy(ring() + (m_uReservedPos & m_uMask), &header, sizeof(header));
+    m_bReserved = false;
+
+    // Publishing covers the padding record written by reserve() as well.
+    publish(m_uReservedPos + recordSize(length));
+    return true;
+}
+
+size_t SharedBufferQueue::writeBatch(std::span<const std::string_view> records) {
+    size_t written = 0;
+    while (written < records.size()) {
+        // Claim as many records as the ring holds at once; reclaim() may only walk
+        // headers that are already published.
+        const uint64_t begin = m_atuWrite_pos.load(std::memory_order_relaxed);
+        uint64_t end = begin;
+        size_t count = 0;
+        for (size_t i = written; i < records.size() && records[i].size() <= getMaxMessageSize(); i++) {
+            const uint64_t next = recordEnd(end, records[i].size());
+            if (next - begin > m_uCapacity) break;
+            end = next;
+            count++;
+        }
+        if (count == 0) break;
+
+        reclaim(end);
+        uint64_t pos = begin;
+        for (size_t i = written; i < written + count; i++) {
+            pos = placeRecord(pos, records[i].size());
+            MessageHeader header{ static_cast<uint32_t>(records[i].size()), RecordType::MESSAGE, m_uNextSeq++ };
+            std::memcpy(ring() + (pos & m_uMask), &header, sizeof(header));
+            std::memcpy(ring() + (pos & m_uMask) + sizeof(header), records[i].data(), records[i].size());
+            pos += recordSize(records[i].size());
+        }
+        publish(end);
+        written += count;
+    }
+    return written;
+}
+
+uint64_t SharedBufferQueue::placeRecord(uint64_t pos, size_t length) {
+    const uint64_t padding = recordEnd(pos, length) - pos - recordSize(length);
+    if (padding != 0) {
+        MessageHeader pad{ static_cast<uint32_t>(padding - sizeof(MessageHeader)), RecordType::PADDING, 0 };
+        std::memcpy(ring() + (pos & m_uMask), &pad, sizeof(pad));
+        pos += padding;
+    }
+    return pos;
+}
+
+void SharedBufferQueue::publish(uint64_t end) {
+    m_atuWrite_pos.store(end, std::memory_order_release);
+
+    // Pairs with the sleeper count in wait(): either the reader sees the new word or we see it.
+    m_atuPublished.fetch_add(1, std::memory_order_seq_cst);
+    if (m_atuSleepers.load(std::memory_order_seq_cst) != 0) Futex::wake(m_atuPublished);
+}
+
+std::span<char> SharedBufferQueue::reserve(size_t length, std::chrono::nanoseconds timeout) {
+    if (length > getMaxMessageSize()) return {};
+
+    // Every byte before 'limit' gets overwritten; consumers there must move first.
+    const uint64_t end = recordEnd(m_atuWrite_pos.load(std::memory_order_relaxed), length);
+    const uint64_t limit = end > m_uCapacity ? end - m_uCapacity : 0;
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    const int64_t waitBegin = monotonicNs();
+    for (;;) {
+        const uint32_t consumed = m_atuConsumed.load(std::memory_order_acquire);
+        if (slowestConsumer() >= limit) break;
+
+        // Dead consumers never wake us; live ones get a lease from when we started waiting.
+        const int64_t now = monotonicNs();
+        const int64_t staleBefore = now - waitBegin > m_iLeaseTimeoutNs ? now - m_iLeaseTimeoutNs : INT64_MIN;
+        if (reclaimConsumers(limit, staleBefore) != 0) continue;
+
+        std::chrono::nanoseconds remaining = LEASE_POLL;
+        if (timeout.count() >= 0) {
+            const std::chrono::nanoseconds left = deadline - std::chrono::steady_clock::now();
+            if (left.count() <= 0) return {};
+            remaining = std::min(left, remaining);
+        }
+
+        // Same handshake as wait(), with the roles swapped.
+        m_atuWriterWaiting.store(1, std::memory_order_seq_cst);
+        if (slowestConsumer() < limit) Futex::wait(m_atuConsumed, consumed, remaining);
+        m_atuWriterWaiting.store(0, std::memory_order_relaxed);
+    }
+    return reserve(length);
+}
+
+void SharedBufferQueue::reclaim(uint64_t end) {
+    if (end <= m_uCapacity) return;
+
+    const uint64_t limit = end - m_uCapacity;
+    uint64_t tail = m_atuTail_pos.load(std::memory_order_relaxed);
+    if (tail >= limit) return;
+
+    // Only the writer touches these headers, they are always consistent here.
+    while (tail < limit) {
+        MessageHeader header;
+        std::memcpy(&header, ring() + (tail & m_uMask), sizeof(header));
+        tail += recordSize(header.m_uLength);
+    }
+
+    // Publish the new tail before any byte behind it is overwritten (seqlock order).
+    m_atuTail_pos.store(tail, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+bool SharedBufferQueue::tryRead(Cursor& cursor, std::vector<char>& message) const {
+    for (;;) {
+        std::span<const char> payload = peek(cursor);
+        if (cursor.m_uPendingSize == 0) return false;
+        message.assign(payload.begin(), payload.end());
+        if (release(cursor)) return true;
+    }
+}
 
-    // If some processes is reading, do nothing
-    if (!m.m_sSem.isZero()) return false;
+size_t SharedBufferQueue::readBatch(Cursor& cursor, std::vector<std::vector<char>>& messages, size_t max) const {
+    cursor.m_uPendingSize = 0;
+    for (;;) {
+        const uint64_t written = m_atuWrite_pos.load(std::memory_order_acquire);
+        const uint64_t start = std::max(cursor.m_uPos, m_atuTail_pos.load(std::memory_order_acquire));
 
-    // The write operation is protected by a lock *in the message*.
-    {
-        LockGuard lock(m.m_lWriterLock);
-        m.m_dgData = DataBlob;
+        uint64_t pos = start;
+        size_t count = 0;
+        uint64_t firstSeq = 0, lastSeq = 0;
+        while (pos < written && count < max) {
+            const uint64_t offset = pos & m_uMask;
+            MessageHeader header;
+            std::memcpy(&header, ring() + offset, sizeof(header));
 
-        {
-            // Index operation is protected by lock for *write* and *read*.
-            // Because index operation is light,
-            // using a lock doesn't hurt the performance much.
-            LockGuard lock(m_lOperationLock);
-            ++m_atiWrite_idx;
+            // Torn headers stop the batch, the tail check below tells whether it was a lap.
+            const uint64_t size = recordSize(header.m_uLength);
+            if (offset + size > m_uCapacity || (header.m_eType == RecordType::MESSAGE && header.m_uLength > getMaxMessageSize())) break;
+            if (header.m_eType == RecordType::MESSAGE) {
+                if (count == messages.size()) messages.emplace_back();
+                const char* payload = ring() + offset + sizeof(header);
+                messages[count].assign(payload, payload + header.m_uLength);
+                if (count == 0) firstSeq = header.m_uSeq;
+                lastSeq = header.m_uSeq;
+                count++;
+            }
+            pos += size;
+        }
 
-            // Queue warp around.
-            if ((m_atiWrite_idx - m_atiFarthest_Read_idx) > (int)m_uQueueLength) {
-                int32_t last_farest_read_idx = m_atiFarthest_Read_idx;
-                m_atiFarthest_Read_idx++;
-                assert(m_atiFarthest_Read_idx = m_atiWrite_idx - m_uQueueLength);
-                // doesn't hold when int overflow
-                assert(m_atiFarthest_Read_idx > last_farest_read_idx);
+        // One validation for the whole batch: lapped anywhere means start over at the tail.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_atuTail_pos.load(std::memory_order_relaxed) > start) {
+            cursor.m_uPos = start;
+            continue;
+        }
+
+        messages.resize(count);
+        if (count != 0) {
+            if (ConsumerSlot* slot = ownSlot(cursor)) {
+                if (written - start > slot->m_atuHighWater.load(std::memory_order_relaxed)) slot->m_atuHighWater.store(written - start, std::memory_order_relaxed);
+                slot->m_atuReceived.store(slot->m_atuReceived.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
             }
+            if (cursor.m_uNextSeq != UNKNOWN_SEQ && firstSeq > cursor.m_uNextSeq)
+                cursor.m_uDropped += firstSeq - cursor.m_uNextSeq;
+            cursor.m_uNextSeq = lastSeq + 1;
         }
+        cursor.m_uPos = pos;
+        publishProgress(cursor);
+        return count;
     }
-    return true;
 }
 
-bool SharedBufferQueue::write(const DataBlob& DataBlob){
-    while (!try_write(DataBlob)) {
-        // Unlikely. Happends when the queue warp around.
-        LDEBUG("write|spinning");
-        usleep(1000);
+std::span<const char> SharedBufferQueue::peek(Cursor& cursor) const {
+    cursor.m_uPendingSize = 0;
+    for (;;) {
+        const uint64_t written = m_atuWrite_pos.load(std::memory_order_acquire);
+        if (cursor.m_uPos >= written) return {};
+
+        // Lapped: everything before the tail may already be overwritten.
+        const uint64_t tail = m_atuTail_pos.load(std::memory_order_acquire);
+        if (cursor.m_uPos < tail) {
+            cursor.m_uPos = tail;
+            publishProgress(cursor);
+        }
+
+        const uint64_t offset = cursor.m_uPos & m_uMask;
+        MessageHeader header;
+        std::memcpy(&header, ring() + offset, sizeof(header));
+
+        // A header torn by the writer must not send us outside the ring.
+        const uint64_t size = recordSize(header.m_uLength);
+        const bool plausible = offset + size <= m_uCapacity &&
+            (header.m_eType == RecordType::PADDING || header.m_uLength <= getMaxMessageSize());
+        if (plausible && header.m_eType == RecordType::MESSAGE) {
+            cursor.m_uPendingSize = size;
+            cursor.m_uPendingSeq = header.m_uSeq;
+            return { ring() + offset + sizeof(header), header.m_uLength };
+        }
+
+        // Padding, or a torn header: only trusted if the tail is still behind us.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_atuTail_pos.load(std::memory_order_relaxed) > cursor.m_uPos) continue;
+        if (!plausible) return {};
+        cursor.m_uPos += size;
+    }
+}
+
+bool SharedBufferQueue::release(Cursor& cursor) const {
+    if (cursor.m_uPendingSize == 0) return false;
+
+    // Nothing read since peek() counts unless the tail is still behind the record.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const bool intact = m_atuTail_pos.load(std::memory_order_relaxed) <= cursor.m_uPos;
+    if (intact) {
+        if (ConsumerSlot* slot = ownSlot(cursor)) {
+            const uint64_t lag = m_atuWrite_pos.load(std::memory_order_relaxed) - cursor.m_uPos;
+            if (lag > slot->m_atuHighWater.load(std::memory_order_relaxed)) slot->m_atuHighWater.store(lag, std::memory_order_relaxed);
+            slot->m_atuReceived.store(slot->m_atuReceived.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        cursor.m_uPos += cursor.m_uPendingSize;
+        if (cursor.m_uNextSeq != UNKNOWN_SEQ && cursor.m_uPendingSeq > cursor.m_uNextSeq)
+            cursor.m_uDropped += cursor.m_uPendingSeq - cursor.m_uNextSeq;
+        cursor.m_uNextSeq = cursor.m_uPendingSeq + 1;
+        publishProgress(cursor);
+    }
+    // When torn, the next peek() resynchronises at the tail.
+    cursor.m_uPendingSize = 0;
+    return intact;
+}
+
+bool SharedBufferQueue::wait(const Cursor& cursor, std::chrono::nanoseconds timeout, AdaptiveSpin& spin) const {
+    auto readable = [&]() { return cursor.m_uPos < m_atuWrite_pos.load(std::memory_order_acquire); };
+    if (spin.spin(readable)) return true;
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        const uint32_t published = m_atuPublished.load(std::memory_order_acquire);
+        if (readable()) return true;
+
+        std::chrono::nanoseconds remaining = WAIT_FOREVER;
+        if (timeout.count() >= 0) {
+            remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining.count() <= 0) return false;
+        }
+
+        // A consumer asleep here is alive, whatever the producer waits for.
+        if (cursor.m_iSlot >= 0) m_arrConsumers[cursor.m_iSlot].m_atiHeartbeat.store(monotonicNs(), std::memory_order_relaxed);
+        m_atuSleepers.fetch_add(1, std::memory_order_seq_cst);
+        if (m_atuPublished.load(std::memory_order_seq_cst) == published)
+            Futex::wait(m_atuPublished, published, remaining);
+        m_atuSleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+SharedBufferQueue::Cursor SharedBufferQueue::latest() const {
+    Cursor cursor;
+    cursor.m_uPos = m_atuWrite_pos.load(std::memory_order_acquire);
+    cursor.m_uNextSeq = UNKNOWN_SEQ;
+    return cursor;
+}
+
+bool SharedBufferQueue::registerConsumer(Cursor& cursor) {
+    if (cursor.m_iSlot >= 0) return true;
+    const uint64_t lease = m_atuLeases.fetch_add(1, std::memory_order_relaxed) + 1;
+    // Second pass only if the table was full: slots of dead owners are fair game.
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1 && reclaimConsumers(UINT64_MAX, INT64_MIN) == 0) break;
+        for (uint32_t i = 0; i < MAX_CONSUMERS; i++) {
+            ConsumerSlot& slot = m_arrConsumers[i];
+            // Claimed first, so nobody else takes it; reclaimConsumers() leaves it alone while
+            // the previous owner's pid, heartbeat and position are still in it.
+            uint64_t free = 0;
+            if (!slot.m_atuLease.compare_exchange_strong(free, LEASE_CLAIMING, std::memory_order_acq_rel)) continue;
+
+            // Anything behind the tail is gone already, holding the producer there is pointless.
+            cursor.m_uPos = std::max(cursor.m_uPos, m_atuTail_pos.load(std::memory_order_acquire));
+            slot.m_atiPid.store(getpid(), std::memory_order_relaxed);
+            slot.m_atiHeartbeat.store(monotonicNs(), std::memory_order_relaxed);
+            slot.m_atuPos.store(cursor.m_uPos, std::memory_order_relaxed);
+            slot.m_atuHighWater.store(0, std::memory_order_relaxed);
+            slot.m_atuReceived.store(0, std::memory_order_relaxed);
+            slot.m_atuDropped.store(0, std::memory_order_relaxed);
+            // Published last: whoever sees the lease sees the slot stamped.
+            slot.m_atuLease.store(lease, std::memory_order_release);
+            cursor.m_iSlot = static_cast<int32_t>(i);
+            cursor.m_uLease = lease;
+            publishProgress(cursor);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SharedBufferQueue::unregisterConsumer(Cursor& cursor) {
+    if (cursor.m_iSlot < 0) return;
+    uint64_t lease = cursor.m_uLease;
+    m_arrConsumers[cursor.m_iSlot].m_atuLease.compare_exchange_strong(lease, 0, std::memory_order_seq_cst);
+    cursor.m_iSlot = -1;
+    // A producer waiting on this consumer can go ahead now.
+    if (m_atuWriterWaiting.load(std::memory_order_seq_cst) != 0) {
+        m_atuConsumed.fetch_add(1, std::memory_order_release);
+        Futex::wake(m_atuConsumed);
+    }
+}
+
+std::vector<SharedBufferQueue::ConsumerStats> SharedBufferQueue::getConsumerStats() const {
+    std::vector<ConsumerStats> stats;
+    const uint64_t written = m_atuWrite_pos.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < MAX_CONSUMERS; i++) {
+        const ConsumerSlot& slot = m_arrConsumers[i];
+        const uint64_t lease = slot.m_atuLease.load(std::memory_order_acquire);
+        if (lease == 0 || lease == LEASE_CLAIMING) continue;
+        const uint64_t pos = slot.m_atuPos.load(std::memory_order_acquire);
+        stats.push_back(ConsumerStats{ i, slot.m_atiPid.load(std::memory_order_relaxed), written > pos ? written - pos : 0,
+                                       slot.m_atuHighWater.load(std::memory_order_relaxed), slot.m_atuReceived.load(std::memory_order_relaxed),
+                                       slot.m_atuDropped.load(std::memory_order_relaxed) });
+    }
+    return stats;
+}
+
+uint64_t SharedBufferQueue::slowestConsumer() const {
+    uint64_t slowest = UINT64_MAX;
+    for (const ConsumerSlot& slot : m_arrConsumers)
+        // Slots still being registered (LEASE_CLAIMING) count too.
+        if (slot.m_atuLease.load(std::memory_order_seq_cst) != 0)
+            slowest = std::min(slowest, slot.m_atuPos.load(std::memory_order_seq_cst));
+    return slowest;
+}
+
+uint32_t SharedBufferQueue::reclaimConsumers(uint64_t limit, int64_t staleBefore) const {
+    uint32_t freed = 0;
+    for (ConsumerSlot& slot : m_arrConsumers) {
+        uint64_t lease = slot.m_atuLease.load(std::memory_order_acquire);
+        if (lease == 0 || lease == LEASE_CLAIMING || slot.m_atuPos.load(std::memory_order_acquire) >= limit) continue;
+
+        const bool dead = kill(slot.m_atiPid.load(std::memory_order_relaxed), 0) != 0 && errno == ESRCH;
+        const bool stale = slot.m_atiHeartbeat.load(std::memory_order_relaxed) < staleBefore;
+        // Fails harmlessly if the owner unregistered or was replaced meanwhile.
+        if ((dead || stale) && slot.m_atuLease.compare_exchange_strong(lease, 0, std::memory_order_acq_rel)) {
+            m_atuEvicted.fetch_add(1, std::memory_order_relaxed);
+            freed++;
+        }
+    }
+    return freed;
+}
+
+SharedBufferQueue::ConsumerSlot* SharedBufferQueue::ownSlot(Cursor& cursor) const {
+    if (cursor.m_iSlot < 0) return nullptr;
+    ConsumerSlot& slot = m_arrConsumers[cursor.m_iSlot];
+    // Our own line, the check costs no sharing. Evicted consumers carry on unregistered.
+    if (slot.m_atuLease.load(std::memory_order_relaxed) != cursor.m_uLease) {
+        cursor.m_iSlot = -1;
+        return nullptr;
+    }
+    return &slot;
+}
+
+void SharedBufferQueue::publishProgress(Cursor& cursor) const {
+    ConsumerSlot* slot = ownSlot(cursor);
+    if (slot == nullptr) return;
+    slot->m_atuDropped.store(cursor.m_uDropped, std::memory_order_relaxed);
+    // Pairs with m_atuWriterWaiting in reserve(): either the producer sees our position or
+    // we see it waiting.
+    slot->m_atuPos.store(cursor.m_uPos, std::memory_order_seq_cst);
+    if (m_atuWriterWaiting.load(std::memory_order_seq_cst) != 0) {
+        slot->m_atiHeartbeat.store(monotonicNs(), std::memory_order_relaxed);
+        m_atuConsumed.fetch_add(1, std::memory_order_release);
+        Futex::wake(m_atuConsumed);
     }
-    return true;
 }
@@ -0,0 +1,103 @@
+#include <include/SharedSegment.hpp>
+#include <include/Logger.hpp>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+
+#ifndef HUGETLBFS_MAGIC
+#define HUGETLBFS_MAGIC 0x958458f6
+#endif
+
+static bool isHugetlbfs(const char* dir) {
+    struct statfs fs;
+    return statfs(dir, &fs) == 0 && static_cast<unsigned long>(fs.f_type) == HUGETLBFS_MAGIC;
+}
+
+// Size of a segment somebody else created, once its creator has sized it.
+static size_t waitForSize(int fd, std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    struct stat st;
+    while (fstat(fd, &st) == 0) {
+        if (st.st_size > 0) return st.st_size;
+        if (std::chrono::steady_clock::now() > deadline) break;
+        usleep(100);
+    }
+    return 0;
+}
+
+SharedSegment::SharedSegment(const std::string& shmem_name, size_t size, std::string& err_message, std::chrono::milliseconds timeout) {
+    int fd = -1;
+
+    // Huge pages first: attach to an existing hugetlbfs segment, or create one if ours is big
+    // enough and the pool can back it (hugetlbfs reserves the pages at mmap time).
+    if (isHugetlbfs(HUGETLBFS_DIR)) {
+        const std::string path = std::string(HUGETLBFS_DIR) + shmem_name;
+        fd = open(path.c_str(), O_RDWR);
+        if (fd < 0 && size >= HUGE_PAGE_SIZE) {
+            fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+            if (fd >= 0) {
+                const size_t rounded = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+                if (ftruncate(fd, rounded) == 0 && map(fd, rounded)) {
+                    m_bCreator = m_bHugePages = true;
+                    close(fd);
+                    return;
+                }
+                LDEBUG("SharedSegment|no huge pages for %s, falling back to /dev/shm", shmem_name.c_str());
+                close(fd);
+                ::unlink(path.c_str());
+                fd = -1;
+            } else if (errno == EEXIST) {
+                fd = open(path.c_str(), O_RDWR);
+            }
+        }
+        m_bHugePages = fd >= 0;
+    }
+
+    if (fd < 0) {
+        fd = shm_open(shmem_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+        if (fd >= 0) {
+            m_bCreator = true;
+            if (ftruncate(fd, size) < 0) {
+                err_message = "Truncate failed.";
+                close(fd);
+                shm_unlink(shmem_name.c_str());
+                return;
+            }
+        } else if (errno == EEXIST) {
+            fd = shm_open(shmem_name.c_str(), O_RDWR, 0666);
+        }
+        if (fd < 0) {
+            err_message = "Open failed.";
+            return;
+        }
+    }
+
+    // Attachers map what the creator made, never their own idea of the size.
+    const size_t mapSize = m_bCreator ? size : waitForSize(fd, timeout);
+    if (mapSize == 0) err_message = "Attach timed out.";
+    else if (!map(fd, mapSize)) err_message = "mmap failed.";
+    close(fd);
+
+    // tmpfs honours this when shmem_enabled allows it, cutting TLB misses on large rings.
+    if (m_pData != nullptr && !m_bHugePages && m_uSize >= HUGE_PAGE_SIZE) madvise(m_pData, m_uSize, MADV_HUGEPAGE);
+}
+
+SharedSegment::~SharedSegment() {
+    if (m_pData != nullptr) munmap(m_pData, m_uSize);
+}
+
+bool SharedSegment::map(int fd, size_t size) {
+    void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) return false;
+    m_pData = data;
+    m_uSize = size;
+    return true;
+}
+
+void SharedSegment::unlink(const std::string& shmem_name) {
+    ::unlink((std::string(HUGETLBFS_DIR) + shmem_name).c_str());
+    shm_unlink(shmem_name.c_str());
+}
@@ -6,188 +6,195 @@
 #include <vector>
 #include <cstdlib>
 #include <functional>
+#include <utility>
+#include <algorithm>
+#include <include/MatrixView.hpp>
+#include <include/ThreadPool.hpp>
+#include <include/Transpose.hpp>
 
 // Uploaded by panchis7u7 ~ Sebastian Madrigal
 namespace voxel
 {
 
+	// Matrix is a value type: copies are deep, moves steal the storage and every
+	// static helper returns its result by value (RVO / move, no heap ownership).
+	// Elements live in a single contiguous row-major block, 'data' holds one
+	// pointer per row into that block.
+	//
+	// Every kernel takes its operands as ConstMatrixView, so matrices, vectors,
+	// spans and slices of any of them can be fed in without copying.
+	//
+	// Kernels fan out over ThreadPool::instance() once their size crosses the
+	// PARALLEL_* thresholds, smaller problems stay on the calling thread.
 	template <class T>
 	class Matrix
 	{
 	public:
+		// Multiply-adds for dot, elements for transpose and element-wise kernels.
+		static constexpr uint_fast64_t PARALLEL_DOT_THRESHOLD = 1 << 18;
+		static constexpr uint_fast64_t PARALLEL_TRANSPOSE_THRESHOLD = 1 << 16;
+		static constexpr uint_fast64_t PARALLEL_ELEMENTWISE_THRESHOLD = 1 << 16;
+		static constexpr uint_fast64_t ELEMENTWISE_GRAIN = 1 << 14;
+		static constexpr uint_fast64_t DOT_TILE_ROWS = 32;
+		static constexpr uint_fast64_t DOT_TILE_COLUMNS = 256;
+		static constexpr uint_fast64_t TRANSPOSE_BAND = 64;
+
 		Matrix();
 		Matrix(uint_fast64_t rows, uint_fast64_t columns);
-		Matrix(Matrix<T> &copy);
-		Matrix(std::vector<T> &vec);
+		Matrix(const Matrix<T> &copy);
+		Matrix(Matrix<T> &&other) noexcept;
+		Matrix(const std::vector<T> &vec);
+		explicit Matrix(ConstMatrixView<T> view);
 		~Matrix();
-		void print();
+		Matrix<T> &operator=(const Matrix<T> &copy);
+		Matrix<T> &operator=(Matrix<T> &&other) noexcept;
+		void print() const;
 		void add(T addend);
-		void add(Matrix<T> *addend);
-		void subtract(Matrix<T> *minuend);
-		void subtract(std::vector<T> *minuend);
-		void dot(Matrix<T> &multiplicand);
+		void add(ConstMatrixView<T> addend);
+		// Adds a rows x 1 'column' to every column (a bias over a batch, one sample per
+		// column). Any other shape leaves the matrix unchanged.
+		void addColumn(ConstMatrixView<T> column);
+		void subtract(ConstMatrixView<T> minuend);
+		void dot(ConstMatrixView<T> multiplicand);
 		void randomize();
 		void transpose();
 		void scalarProduct(T factor);
-		void hadamardProduct(Matrix<T> *factor);
-		void forEach(std::function<void(T data, unsigned row, unsigned column)> callback);
+		void hadamardProduct(ConstMatrixView<T> factor);
+		void forEach(std::function<void(T data, unsigned row, unsigned column)> callback) const;
 		void map(T (*func)(T));
-		unsigned getRows();
-		unsigned getColumns();
+		unsigned getRows() const;
+		unsigned getColumns() const;
+		bool isEmpty() const;
 		T **getData();
+		const T *const *getData() const;
 
-		// Overloads.
-		// friend std::ostream& operator<< <>(std::ostream& out, const Matrix<T>* mat);
-
-		// Static methods.
-		// static Matrix* fromVector(std::vector<T>* entradas);
-		// static std::vector<T>* toVector(Matrix<T>* entradas);
-		// static Matrix<T>* hadamardProduct(Matrix<T>* A, Matrix<T>* B);
-		// static Matrix<T>* elementWiseSubstraction(Matrix<T>* A, Matrix<T>* B);
-		// static Matrix<T>* dot(Matrix<T>* A, Matrix<T>* B);
-		// static Matrix<T>* transpose(Matrix<T>* A);
-		// static Matrix<T>* map(Matrix<T>* A, T (*func)(T));
+		// Views over the whole matrix.
+		MatrixView<T> view() { return MatrixView<T>(storage, rows, columns); }
+		ConstMatrixView<T> view() const { return ConstMatrixView<T>(storage, rows, columns); }
+		operator MatrixView<T>() { return view(); }
+		operator ConstMatrixView<T>() const { return view(); }
 
 		///////////////////////////////////////////////////////////////////////////////////////////
 		// Public static typename Methods.
 		///////////////////////////////////////////////////////////////////////////////////////////
 
-		static Matrix<T> *fromVector(std::vector<T> *entradas)
+		static Matrix<T> fromVector(const std::vector<T> &entradas)
 		{
-			Matrix<T> *result = new Matrix(entradas->size(), 1);
-			for (uint_fast64_t i = 0; i < entradas->size(); i++)
-			{
-				result->data[i][0] = entradas->at(i);
-			}
-			return result;
+			return Matrix<T>(entradas);
 		}
 
-		static std::vector<T> *toVector(Matrix<T> *entradas)
+		static std::vector<T> toVector(ConstMatrixView<T> entradas)
 		{
-			std::vector<T> *result = new std::vector<T>();
-			for (uint_fast64_t i = 0; i < entradas->rows; i++)
+			std::vector<T> result;
+			result.reserve(entradas.size());
+			for (uint_fast64_t i = 0; i < entradas.getRows(); i++)
 			{
-				for (uint_fast64_t j = 0; j < entradas->columns; j++)
+				for (uint_fast64_t j = 0; j < entradas.getColumns(); j++)
 				{
-					result->push_back(entradas->data[i][j]);
+					result.push_back(entradas(i, j));
 				}
 			}
 			return result;
 		}
 
-		static Matrix<T> *hadamardProduct(Matrix<T> *A, Matrix<T> *B)
+		// Mismatched operands yield an empty (0x0) matrix.
+		static Matrix<T> hadamardProduct(ConstMatrixView<T> A, ConstMatrixView<T> B)
 		{
-			if ((A->rows != B->rows) || (A->columns != B->columns))
-			{
-				return NULL;
-			}
-			else
-			{
-				Matrix<T> *result = new Matrix<T>(A->rows, B->columns);
-				for (uint_fast64_t i = 0; i < A->rows; i++)
-				{
-					for (uint_fast64_t j = 0; j < B->columns; j++)
-					{
-						result->data[i][j] = A->data[i][j] * B->data[i][j];
-					}
-				}
-				return result;
-			}
+			if ((A.getRows() != B.getRows()) || (A.getColumns() != B.getColumns()))
+				return Matrix<T>();
+
+			Matrix<T> result(A.getRows(), A.getColumns());
+			zip(result, A, B, [](T a, T b)
+				{ return a * b; });
+			return result;
 		}
 
-		static Matrix<T> *elementWiseSubstraction(Matrix<T> *A, Matrix<T> *B)
+		// Mismatched operands yield an empty (0x0) matrix.
+		static Matrix<T> elementWiseSubstraction(ConstMatrixView<T> A, ConstMatrixView<T> B)
 		{
-			if ((A->rows != B->rows) || (A->columns != B->columns))
-			{
-				return NULL;
-			}
-			else
-			{
-				Matrix<T> *result = new Matrix<T>(A->rows, B->columns);
-				for (uint_fast64_t i = 0; i < A->rows; i++)
-				{
-					for (uint_fast64_t j = 0; j < B->columns; j++)
-					{
-						result->data[i][j] = A->data[i][j] - B->data[i][j];
-					}
-				}
-				return result;
-			}
+			if ((A.getRows() != B.getRows()) || (A.getColumns() != B.getColumns()))
+				return Matrix<T>();
+
+			Matrix<T> result(A.getRows(), A.getColumns());
+			zip(result, A, B, [](T a, T b)
+				{ return a - b; });
+			return result;
 		}
 
-		static Matrix<T> *dot(Matrix<T> *A, Matrix<T> *B)
+		// A vector operand is read in place as an n x 1 column.
+		static Matrix<T> dot(ConstMatrixView<T> A, ConstMatrixView<T> B)
 		{
-			Matrix<T> *result = new Matrix<T>(A->rows, B->columns);
-			for (uint_fast64_t i = 0; i < result->rows; i++)
-			{
-				for (uint_fast64_t j = 0; j < result->columns; j++)
-				{
-					T sum = 0;
-					for (uint_fast64_t k = 0; k < A->columns; k++)
-					{
-						sum += A->data[i][k] * B->data[k][j];
-					}
-					result->data[i][j] = sum;
-				}
-			}
+			Matrix<T> result(A.getRows(), B.getColumns());
+			dot(result, A, B);
 			return result;
 		}
 
-		static Matrix<T> *dot(Matrix<T> *A, std::vector<T> *B)
+		// Accumulates (to += aOperand * bOperand), 'to' must already be sized.
+		// Large products are split into DOT_TILE_ROWS x DOT_TILE_COLUMNS tiles of 'to',
+		// each tile is owned by exactly one task so no two threads write the same row.
+		static void dot(MatrixView<T> to, ConstMatrixView<T> aOperand, ConstMatrixView<T> bOperand)
 		{
-			// n Column Matrix requires n elements vector in order to perform product.
-			Matrix<T> *result = new Matrix<T>(A->rows, 1);
-			for (uint_fast64_t i = 0; i < result->rows; i++)
+			const uint_fast64_t rows = aOperand.getRows();
+			const uint_fast64_t columns = bOperand.getColumns();
+			if (rows * aOperand.getColumns() * columns < PARALLEL_DOT_THRESHOLD)
 			{
-				for (uint_fast64_t j = 0; j < result->columns; j++)
-				{
-					T sum = 0;
-					for (uint_fast64_t k = 0; k < A->columns; k++)
-					{
-						sum += A->data[i][k] * B->at(k);
-					}
-					result->data[i][j] = sum;
-				}
+				dotTile(to, aOperand, bOperand, 0, rows, 0, columns);
+				return;
 			}
-			return result;
+
+			const uint_fast64_t rowTiles = (rows + DOT_TILE_ROWS - 1) / DOT_TILE_ROWS;
+			const uint_fast64_t columnTiles = (columns + DOT_TILE_COLUMNS - 1) / DOT_TILE_COLUMNS;
+			ThreadPool::instance().parallelFor(0, rowTiles * columnTiles, 1, [&](uint_fast64_t begin, uint_fast64_t end)
+											   {
+				for (uint_fast64_t tile = begin; tile < end; tile++)
+				{
+					const uint_fast64_t i0 = (tile / columnTiles) * DOT_TILE_ROWS;
+					const uint_fast64_t j0 = (tile % columnTiles) * DOT_TILE_COLUMNS;
+					dotTile(to, aOperand, bOperand, i0, std::min(rows, i0 + DOT_TILE_ROWS), j0, std::min(columns, j0 + DOT_TILE_COLUMNS));
+				} });
 		}
 
-		static void dot(Matrix<T> *to, Matrix *aOperand, Matrix<T> *bOperand)
+		static Matrix<T> transpose(ConstMatrixView<T> A)
 		{
-			for (uint_fast64_t i = 0; i < aOperand->rows; ++i)
-			{
-				for (uint_fast64_t j = 0; j < bOperand->columns; ++j)
-				{
-					for (uint_fast64_t k = 0; k < aOperand->columns; ++k)
-					{
-						to->data[i][j] += aOperand->data[i][k] * bOperand->data[k][j];
-					}
-				}
-			}
+			Matrix<T> result(A.getColumns(), A.getRows());
+			transpose(result, A);
+			return result;
 		}
 
-		static Matrix<T> *transpose(Matrix<T> *A)
+		// to = from^T through the cache-oblivious SIMD kernel in Transposer. Large inputs are
+		// cut into TRANSPOSE_BAND-row bands, one task per band.
+		static void transpose(MatrixView<T> to, ConstMatrixView<T> from)
 		{
-			Matrix<T> *result = new Matrix<T>(A->columns, A->rows);
-			for (uint_fast64_t i = 0; i < A->rows; i++)
+			const uint_fast64_t rows = from.getRows();
+			if (from.size() < PARALLEL_TRANSPOSE_THRESHOLD)
 			{
-				for (uint_fast64_t j = 0; j < A->columns; j++)
-				{
-					result->data[j][i] = A->data[i][j];
-				}
+				Transposer<T>::blocked(to, from);
+				return;
 			}
-			return result;
+
+			const uint_fast64_t bands = (rows + TRANSPOSE_BAND - 1) / TRANSPOSE_BAND;
+			ThreadPool::instance().parallelFor(0, bands, 1, [&](uint_fast64_t begin, uint_fast64_t end)
+											   { Transposer<T>::rows(to, from, begin * TRANSPOSE_BAND, std::min(rows, end * TRANSPOSE_BAND)); });
 		}
 
-		static Matrix<T> *map(Matrix<T> *A, T (*func)(T))
+		static Matrix<T> map(ConstMatrixView<T> A, T (*func)(T))
 		{
-			Matrix<T> *result = new Matrix<T>(A->rows, A->columns);
-			for (uint_fast64_t i = 0; i < A->rows; i++)
+			Matrix<T> result(A.getRows(), A.getColumns());
+			if (A.isContiguous())
 			{
-				for (uint_fast64_t j = 0; j < A->columns; j++)
-				{
-					result->data[i][j] = func(A->data[i][j]);
-				}
+				const T *source = A.getData();
+				forLinear(result.size(), [&](uint_fast64_t begin, uint_fast64_t end)
+						  {
+					for (uint_fast64_t i = begin; i < end; i++)
+						result.storage[i] = func(source[i]); });
+			}
+			else
+			{
+				forRows(result.rows, result.columns, [&](uint_fast64_t begin, uint_fast64_t end)
+						{
+					for (uint_fast64_t i = begin; i < end; i++)
+						for (uint_fast64_t j = 0; j < result.columns; j++)
+							result.data[i][j] = func(A(i, j)); });
 			}
 			return result;
 		}
@@ -196,14 +203,14 @@ namespace voxel
 		// Operator Overloading.
 		///////////////////////////////////////////////////////////////////////////////////////////
 
-		friend std::ostream &operator<<(std::ostream &out, const Matrix<T> *mat)
+		friend std::ostream &operator<<(std::ostream &out, const Matrix<T> &mat)
 		{
-			for (uint_fast64_t i = 0; i < mat->rows; i++)
+			for (uint_fast64_t i = 0; i < mat.rows; i++)
 			{
 				out << "|";
-				for (uint_fast64_t j = 0; j < mat->columns; j++)
+				for (uint_fast64_t j = 0; j < mat.columns; j++)
 				{
-					out << "  " << mat->data[i][j] << "  ";
+					out << "  " << mat.data[i][j] << "  ";
 				}
 				out << "|";
 				out << std::endl;
@@ -212,11 +219,87 @@ namespace voxel
 			return out;
 		}
 
+		friend std::ostream &operator<<(std::ostream &out, const Matrix<T> *mat)
+		{
+			return out << *mat;
+		}
+
 	private:
 		T **data;
+		T *storage;
 		unsigned rows;
 		unsigned columns;
-		T **alloc(uint_fast64_t rows, uint_fast64_t columns);
+		uint_fast64_t size() const { return static_cast<uint_fast64_t>(rows) * columns; }
+		void alloc(uint_fast64_t rows, uint_fast64_t columns);
+		void release();
+
+		// result(i, j) = op(A(i, j), B(i, j)), linear when both operands are packed.
+		template <class Op>
+		static void zip(Matrix<T> &result, ConstMatrixView<T> A, ConstMatrixView<T> B, Op op)
+		{
+			if (A.isContiguous() && B.isContiguous())
+			{
+				const T *a = A.getData();
+				const T *b = B.getData();
+				forLinear(result.size(), [&](uint_fast64_t begin, uint_fast64_t end)
+						  {
+					for (uint_fast64_t i = begin; i < end; i++)
+						result.storage[i] = op(a[i], b[i]); });
+			}
+			else
+			{
+				forRows(result.rows, result.columns, [&](uint_fast64_t begin, uint_fast64_t end)
+						{
+					for (uint_fast64_t i = begin; i < end; i++)
+						for (uint_fast64_t j = 0; j < result.columns; j++)
+							result.data[i][j] = op(A(i, j), B(i, j)); });
+			}
+		}
+
+		// Runs body(begin, end) over [0, count) elements, chunked across the pool past the threshold.
+		template <class Body>
+		static void forLinear(uint_fast64_t count, Body &&body)
+		{
+			if (count < PARALLEL_ELEMENTWISE_THRESHOLD)
+				body(0, count);
+			else
+				ThreadPool::instance().parallelFor(0, count, ELEMENTWISE_GRAIN, body);
+		}
+
+		// Same as forLinear but hands out whole rows, for strided operands.
+		template <class Body>
+		static void forRows(uint_fast64_t rows, uint_fast64_t columns, Body &&body)
+		{
+			if (rows * columns < PARALLEL_ELEMENTWISE_THRESHOLD)
+				body(0, rows);
+			else
+				ThreadPool::instance().parallelFor(0, rows, std::max<uint_fast64_t>(1, ELEMENTWISE_GRAIN / std::max<uint_fast64_t>(1, columns)), body);
+		}
+
+		static void dotTile(MatrixView<T> to, ConstMatrixView<T> aOperand, ConstMatrixView<T> bOperand,
+							uint_fast64_t i0, uint_fast64_t i1, uint_fast64_t j0, uint_fast64_t j1)
+		{
+			const bool unitStride = to.getColumnStride() == 1 && bOperand.getColumnStride() == 1;
+			for (uint_fast64_t i = i0; i < i1; ++i)
+			{
+				for (uint_fast64_t k = 0; k < aOperand.getColumns(); ++k)
+				{
+					const T a = aOperand(i, k);
+					if (unitStride)
+					{
+						T *toRow = to.getData() + i * to.getRowStride();
+						const T *bRow = bOperand.getData() + k * bOperand.getRowStride();
+						for (uint_fast64_t j = j0; j < j1; ++j)
+							toRow[j] += a * bRow[j];
+					}
+					else
+					{
+						for (uint_fast64_t j = j0; j < j1; ++j)
+							to(i, j) += a * bOperand(k, j);
+					}
+				}
+			}
+		}
 
 	protected:
 	};
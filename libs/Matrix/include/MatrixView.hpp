@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+// Uploaded by panchis7u7 ~ Sebastian Madrigal
+namespace voxel
+{
+
+	// Non-owning window over external memory (a Matrix, a std::vector, a span or any
+	// mmap'd region). Element (i, j) lives at data[i * rowStride + j * columnStride], so
+	// rows, columns, blocks and transposes are all views over the same memory and
+	// slicing never copies. The viewed memory must outlive the view.
+	template <class T>
+	class MatrixView
+	{
+	public:
+		MatrixView() : data(nullptr), rows(0), columns(0), rowStride(0), columnStride(1) {}
+		MatrixView(T *data, uint_fast64_t rows, uint_fast64_t columns)
+			: data(data), rows(rows), columns(columns), rowStride(columns), columnStride(1) {}
+		MatrixView(T *data, uint_fast64_t rows, uint_fast64_t columns, uint_fast64_t rowStride, uint_fast64_t columnStride = 1)
+			: data(data), rows(rows), columns(columns), rowStride(rowStride), columnStride(columnStride) {}
+
+		// Vectors and spans are viewed as column matrices (n x 1).
+		MatrixView(std::vector<T> &vec) : MatrixView(vec.data(), vec.size(), 1) {}
+		MatrixView(std::span<T> span) : MatrixView(span.data(), span.size(), 1) {}
+
+		inline T &operator()(uint_fast64_t row, uint_fast64_t column) const { return data[row * rowStride + column * columnStride]; }
+
+		inline MatrixView<T> row(uint_fast64_t row) const { return block(row, 0, 1, columns); }
+		inline MatrixView<T> column(uint_fast64_t column) const { return block(0, column, rows, 1); }
+		inline MatrixView<T> block(uint_fast64_t row, uint_fast64_t column, uint_fast64_t nRows, uint_fast64_t nColumns) const
+		{
+			return MatrixView<T>(&(*this)(row, column), nRows, nColumns, rowStride, columnStride);
+		}
+		inline MatrixView<T> transposed() const { return MatrixView<T>(data, columns, rows, columnStride, rowStride); }
+
+		inline T *getData() const { return data; }
+		inline uint_fast64_t getRows() const { return rows; }
+		inline uint_fast64_t getColumns() const { return columns; }
+		inline uint_fast64_t getRowStride() const { return rowStride; }
+		inline uint_fast64_t getColumnStride() const { return columnStride; }
+		inline uint_fast64_t size() const { return rows * columns; }
+		inline bool isEmpty() const { return size() == 0; }
+
+		// Rows are packed back to back, the whole view is one linear run of memory.
+		inline bool isContiguous() const { return columnStride == 1 && (rowStride == columns || rows <= 1); }
+
+	private:
+		T *data;
+		uint_fast64_t rows;
+		uint_fast64_t columns;
+		uint_fast64_t rowStride;
+		uint_fast64_t columnStride;
+	};
+
+	// Read-only counterpart of MatrixView, every MatrixView converts to it implicitly.
+	template <class T>
+	class ConstMatrixView
+	{
+	public:
+		ConstMatrixView() : data(nullptr), rows(0), columns(0), rowStride(0), columnStride(1) {}
+		ConstMatrixView(const T *data, uint_fast64_t rows, uint_fast64_t columns)
+			: data(data), rows(rows), columns(columns), rowStride(columns), columnStride(1) {}
+		ConstMatrixView(const T *data, uint_fast64_t rows, uint_fast64_t columns, uint_fast64_t rowStride, uint_fast64_t columnStride = 1)
+			: data(data), rows(rows), columns(columns), rowStride(rowStride), columnStride(columnStride) {}
+		ConstMatrixView(const MatrixView<T> &view)
+			: ConstMatrixView(view.getData(), view.getRows(), view.getColumns(), view.getRowStride(), view.getColumnStride()) {}
+
+		// Vectors and spans are viewed as column matrices (n x 1).
+		ConstMatrixView(const std::vector<T> &vec) : ConstMatrixView(vec.data(), vec.size(), 1) {}
+		ConstMatrixView(std::span<const T> span) : ConstMatrixView(span.data(), span.size(), 1) {}
+
+		inline const T &operator()(uint_fast64_t row, uint_fast64_t column) const { return data[row * rowStride + column * columnStride]; }
+
+		inline ConstMatrixView<T> row(uint_fast64_t row) const { return block(row, 0, 1, columns); }
+		inline ConstMatrixView<T> column(uint_fast64_t column) const { return block(0, column, rows, 1); }
+		inline ConstMatrixView<T> block(uint_fast64_t row, uint_fast64_t column, uint_fast64_t nRows, uint_fast64_t nColumns) const
+		{
+			return ConstMatrixView<T>(&(*this)(row, column), nRows, nColumns, rowStride, columnStride);
+		}
+		inline ConstMatrixView<T> transposed() const { return ConstMatrixView<T>(data, columns, rows, columnStride, rowStride); }
+
+		inline const T *getData() const { return data; }
+		inline uint_fast64_t getRows() const { return rows; }
+		inline uint_fast64_t getColumns() const { return columns; }
+		inline uint_fast64_t getRowStride() const { return rowStride; }
+		inline uint_fast64_t getColumnStride() const { return columnStride; }
+		inline uint_fast64_t size() const { return rows * columns; }
+		inline bool isEmpty() const { return size() == 0; }
+		inline bool isContiguous() const { return columnStride == 1 && (rowStride == columns || rows <= 1); }
+
+	private:
+		const T *data;
+		uint_fast64_t rows;
+		uint_fast64_t columns;
+		uint_fast64_t rowStride;
+		uint_fast64_t columnStride;
+	};
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <include/Matrix.hpp>
+#include <include/MatrixView.hpp>
+#include <cstdint>
+#include <vector>
+
+// Uploaded by panchis7u7 ~ Sebastian Madrigal
+namespace voxel
+{
+
+	// CSR keeps one run of (column, value) pairs per row, CSC one run of (row, value) pairs
+	// per column. A CSC matrix reinterpreted as CSR is its transpose, which the kernels use
+	// to multiply by B^T without materialising it.
+	enum class SparseLayout
+	{
+		CSR,
+		CSC
+	};
+
+	// Compressed sparse matrix for inputs that are mostly zeros. The kernels only visit
+	// stored entries, so their cost scales with getNonZeros() instead of rows x columns.
+	template <class T>
+	class SparseMatrix
+	{
+	public:
+		using Index = uint32_t;
+
+		// Multiply-adds below which the kernels stay on the calling thread.
+		static constexpr uint_fast64_t PARALLEL_THRESHOLD = 1 << 16;
+
+		SparseMatrix();
+		SparseMatrix(uint_fast64_t rows, uint_fast64_t columns, SparseLayout layout,
+					 std::vector<Index> offsets, std::vector<Index> indices, std::vector<T> values);
+
+		// Keeps the entries whose magnitude is above 'epsilon'.
+		static SparseMatrix<T> fromDense(ConstMatrixView<T> dense, SparseLayout layout, T epsilon = 0);
+		// n x 1 CSC column, the shape feedForward/train expect for sparse inputs.
+		static SparseMatrix<T> fromVector(const std::vector<T> &vec, T epsilon = 0);
+
+		Matrix<T> toDense() const;
+		SparseMatrix<T> toLayout(SparseLayout layout) const;
+
+		uint_fast64_t getRows() const { return rows; }
+		uint_fast64_t getColumns() const { return columns; }
+		uint_fast64_t getNonZeros() const { return values.size(); }
+		SparseLayout getLayout() const { return layout; }
+		const std::vector<Index> &getOffsets() const { return offsets; }
+		const std::vector<Index> &getIndices() const { return indices; }
+		const std::vector<T> &getValues() const { return values; }
+
+		///////////////////////////////////////////////////////////////////////////////////////////
+		// Kernels.
+		///////////////////////////////////////////////////////////////////////////////////////////
+
+		// SpMV / SpMM: sparse A times dense B.
+		static Matrix<T> dot(const SparseMatrix<T> &A, ConstMatrixView<T> B);
+
+		// Dense A times sparse B, e.g. layer weights times a sparse input column.
+		static Matrix<T> dot(ConstMatrixView<T> A, const SparseMatrix<T> &B);
+
+		// Accumulates to += A * B (or A * B^T), 'to' must already be sized.
+		static void dot(MatrixView<T> to, ConstMatrixView<T> A, const SparseMatrix<T> &B);
+		static void dotTransposed(MatrixView<T> to, ConstMatrixView<T> A, const SparseMatrix<T> &B);
+
+	private:
+		static void accumulate(MatrixView<T> to, ConstMatrixView<T> A, const SparseMatrix<T> &B, bool transposeB);
+
+		uint_fast64_t rows;
+		uint_fast64_t columns;
+		SparseLayout layout;
+		// offsets has one entry per outer index (row for CSR, column for CSC) plus one.
+		std::vector<Index> offsets;
+		std::vector<Index> indices;
+		std::vector<T> values;
+	};
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../../platform.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Uploaded by panchis7u7 ~ Sebastian Madrigal
+namespace voxel
+{
+
+	// Process-wide work-stealing pool shared by the Matrix kernels.
+	// Every worker owns a deque: it pops its own work from the back and steals from the
+	// front of the others when it runs dry. Threads blocked in parallelFor() execute
+	// queued tasks while they wait, so nested parallel calls cannot deadlock the pool.
+	class ThreadPool
+	{
+	public:
+		using Task = std::function<void()>;
+		using RangeTask = std::function<void(uint_fast64_t begin, uint_fast64_t end)>;
+
+		LIBEXP explicit ThreadPool(unsigned workers);
+		LIBEXP ~ThreadPool();
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		// Pool sized to the machine (hardware_concurrency - 1 workers, the caller is the last core).
+		LIBEXP static ThreadPool &instance();
+
+		// Threads taking part in a parallelFor: the workers plus the calling thread.
+		LIBEXP unsigned getThreadCount() const { return static_cast<unsigned>(m_vWorkers.size()) + 1; }
+
+		// Stops and restarts the workers, must not race with running work.
+		LIBEXP void resize(unsigned workers);
+
+		LIBEXP void submit(Task task);
+
+		// Splits [begin, end) into chunks of at least 'grain' items and runs 'body' on each,
+		// returning once every chunk has completed.
+		LIBEXP void parallelFor(uint_fast64_t begin, uint_fast64_t end, uint_fast64_t grain, const RangeTask &body);
+
+	private:
+		struct WorkQueue
+		{
+			std::mutex m_mxLock;
+			std::deque<Task> m_dqTasks;
+		};
+
+		void start(unsigned workers);
+		void stop();
+		void workerLoop(unsigned index);
+		bool tryPop(unsigned index, Task &task);
+		bool trySteal(unsigned thief, Task &task);
+
+		std::vector<std::thread> m_vWorkers;
+		std::vector<std::unique_ptr<WorkQueue>> m_vQueues;
+		std::atomic<uint_fast64_t> m_atuQueued{0};
+		std::atomic<unsigned> m_atuNextQueue{0};
+		std::atomic<bool> m_atbStop{false};
+		std::mutex m_mxSleep;
+		std::condition_variable m_cvSleep;
+	};
+}
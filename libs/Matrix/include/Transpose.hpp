@@ -0,0 +1,239 @@
+#pragma once
+
+#include <include/MatrixView.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// Uploaded by panchis7u7 ~ Sebastian Madrigal
+namespace voxel
+{
+
+	// Transpose kernels used by Matrix.
+	//
+	// The out-of-place path is cache-oblivious: the index space is halved along its
+	// longer side until a block fits in L1 (LEAF x LEAF), and leaves are walked in
+	// MICRO x MICRO tiles that are transposed in SIMD registers (8x8 / 4x4 floats with
+	// AVX / SSE, 4x4 / 2x2 doubles). Both reads and writes then touch whole cache
+	// lines instead of striding a column through memory.
+	template <class T>
+	class Transposer
+	{
+	public:
+		static constexpr uint_fast64_t LEAF = 32;
+
+#if defined(__AVX__)
+		static constexpr uint_fast64_t MICRO = std::is_same_v<T, float> ? 8 : (std::is_same_v<T, double> ? 4 : 1);
+#elif defined(__SSE2__) || defined(_M_X64)
+		static constexpr uint_fast64_t MICRO = std::is_same_v<T, float> ? 4 : (std::is_same_v<T, double> ? 2 : 1);
+#else
+		static constexpr uint_fast64_t MICRO = 1;
+#endif
+
+		// Reference kernel: reads rows, writes columns. Kept for benchmarks and tests.
+		static void naive(MatrixView<T> to, ConstMatrixView<T> from)
+		{
+			for (uint_fast64_t i = 0; i < from.getRows(); i++)
+				for (uint_fast64_t j = 0; j < from.getColumns(); j++)
+					to(j, i) = from(i, j);
+		}
+
+		// to = from^T restricted to rows [i0, i1) of 'from'.
+		static void rows(MatrixView<T> to, ConstMatrixView<T> from, uint_fast64_t i0, uint_fast64_t i1)
+		{
+			recurse(to, from, i0, i1, 0, from.getColumns());
+		}
+
+		static void blocked(MatrixView<T> to, ConstMatrixView<T> from)
+		{
+			rows(to, from, 0, from.getRows());
+		}
+
+		// In-place transpose of a square view: mirrored tile pairs are swapped through a
+		// small stack buffer, diagonal tiles are transposed on themselves.
+		// Handles block rows [b0, b1) of LEAF-sized blocks so callers can split the work.
+		static void inPlace(MatrixView<T> square, uint_fast64_t b0, uint_fast64_t b1)
+		{
+			const uint_fast64_t n = square.getRows();
+			for (uint_fast64_t bi = b0; bi < b1; bi++)
+			{
+				const uint_fast64_t i0 = bi * LEAF;
+				const uint_fast64_t i1 = std::min(n, i0 + LEAF);
+				for (uint_fast64_t j0 = i0; j0 < n; j0 += LEAF)
+				{
+					const uint_fast64_t j1 = std::min(n, j0 + LEAF);
+					swapBlocks(square, i0, i1, j0, j1);
+				}
+			}
+		}
+
+		static void inPlace(MatrixView<T> square)
+		{
+			inPlace(square, 0, (square.getRows() + LEAF - 1) / LEAF);
+		}
+
+	private:
+		static void recurse(MatrixView<T> to, ConstMatrixView<T> from,
+							uint_fast64_t i0, uint_fast64_t i1, uint_fast64_t j0, uint_fast64_t j1)
+		{
+			const uint_fast64_t height = i1 - i0;
+			const uint_fast64_t width = j1 - j0;
+			if (height <= LEAF && width <= LEAF)
+			{
+				leaf(to, from, i0, i1, j0, j1);
+			}
+			else if (height >= width)
+			{
+				// Split on a MICRO boundary so leaves keep full SIMD tiles.
+				const uint_fast64_t mid = i0 + std::max<uint_fast64_t>(MICRO, (height / 2) / MICRO * MICRO);
+				recurse(to, from, i0, mid, j0, j1);
+				recurse(to, from, mid, i1, j0, j1);
+			}
+			else
+			{
+				const uint_fast64_t mid = j0 + std::max<uint_fast64_t>(MICRO, (width / 2) / MICRO * MICRO);
+				recurse(to, from, i0, i1, j0, mid);
+				recurse(to, from, i0, i1, mid, j1);
+			}
+		}
+
+		static void leaf(MatrixView<T> to, ConstMatrixView<T> from,
+						 uint_fast64_t i0, uint_fast64_t i1, uint_fast64_t j0, uint_fast64_t j1)
+		{
+			uint_fast64_t iSimd = i0;
+			uint_fast64_t jSimd = j0;
+			if (MICRO > 1 && to.getColumnStride() == 1 && from.getColumnStride() == 1)
+			{
+				iSimd = i0 + (i1 - i0) / MICRO * MICRO;
+				jSimd = j0 + (j1 - j0) / MICRO * MICRO;
+				for (uint_fast64_t i = i0; i < iSimd; i += MICRO)
+					for (uint_fast64_t j = j0; j < jSimd; j += MICRO)
+						micro(&from(i, j), from.getRowStride(), &to(j, i), to.getRowStride());
+			}
+
+			// Ragged right and bottom edges.
+			for (uint_fast64_t i = i0; i < i1; i++)
+			{
+				for (uint_fast64_t j = (i < iSimd ? jSimd : j0); j < j1; j++)
+					to(j, i) = from(i, j);
+			}
+		}
+
+		static void swapBlocks(MatrixView<T> square, uint_fast64_t i0, uint_fast64_t i1, uint_fast64_t j0, uint_fast64_t j1)
+		{
+			const bool diagonal = (i0 == j0);
+			uint_fast64_t iSimd = i0;
+			uint_fast64_t jSimd = j0;
+			if (MICRO > 1 && square.getColumnStride() == 1)
+			{
+				const uint_fast64_t stride = square.getRowStride();
+				iSimd = i0 + (i1 - i0) / MICRO * MICRO;
+				jSimd = j0 + (j1 - j0) / MICRO * MICRO;
+				T upper[MICRO * MICRO];
+				T lower[MICRO * MICRO];
+				for (uint_fast64_t i = i0; i < iSimd; i += MICRO)
+				{
+					for (uint_fast64_t j = (diagonal ? i : j0); j < jSimd; j += MICRO)
+					{
+						T *p = &square(i, j);
+						T *q = &square(j, i);
+						micro(p, stride, upper, MICRO);
+						if (p != q)
+						{
+							micro(q, stride, lower, MICRO);
+							copyTile(lower, p, stride);
+						}
+						copyTile(upper, q, stride);
+					}
+				}
+			}
+
+			// Elements outside the SIMD tiles are swapped one by one.
+			for (uint_fast64_t i = i0; i < i1; i++)
+			{
+				for (uint_fast64_t j = (diagonal ? i + 1 : j0); j < j1; j++)
+				{
+					if (i < iSimd && j < jSimd)
+						continue;
+					std::swap(square(i, j), square(j, i));
+				}
+			}
+		}
+
+		static inline void copyTile(const T *tile, T *dst, uint_fast64_t dstStride)
+		{
+			for (uint_fast64_t r = 0; r < MICRO; r++)
+				std::copy(tile + r * MICRO, tile + (r + 1) * MICRO, dst + r * dstStride);
+		}
+
+		// dst (MICRO x MICRO) = src^T, both row-major with the given row strides.
+		static inline void micro(const T *src, uint_fast64_t srcStride, T *dst, uint_fast64_t dstStride)
+		{
+#if defined(__AVX__)
+			if constexpr (std::is_same_v<T, float>)
+			{
+				__m256 r0 = _mm256_loadu_ps(src + 0 * srcStride), r1 = _mm256_loadu_ps(src + 1 * srcStride);
+				__m256 r2 = _mm256_loadu_ps(src + 2 * srcStride), r3 = _mm256_loadu_ps(src + 3 * srcStride);
+				__m256 r4 = _mm256_loadu_ps(src + 4 * srcStride), r5 = _mm256_loadu_ps(src + 5 * srcStride);
+				__m256 r6 = _mm256_loadu_ps(src + 6 * srcStride), r7 = _mm256_loadu_ps(src + 7 * srcStride);
+				__m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+				__m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+				__m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+				__m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+				__m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)), s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+				__m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)), s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+				__m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)), s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+				__m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)), s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+				_mm256_storeu_ps(dst + 0 * dstStride, _mm256_permute2f128_ps(s0, s4, 0x20));
+				_mm256_storeu_ps(dst + 1 * dstStride, _mm256_permute2f128_ps(s1, s5, 0x20));
+				_mm256_storeu_ps(dst + 2 * dstStride, _mm256_permute2f128_ps(s2, s6, 0x20));
+				_mm256_storeu_ps(dst + 3 * dstStride, _mm256_permute2f128_ps(s3, s7, 0x20));
+				_mm256_storeu_ps(dst + 4 * dstStride, _mm256_permute2f128_ps(s0, s4, 0x31));
+				_mm256_storeu_ps(dst + 5 * dstStride, _mm256_permute2f128_ps(s1, s5, 0x31));
+				_mm256_storeu_ps(dst + 6 * dstStride, _mm256_permute2f128_ps(s2, s6, 0x31));
+				_mm256_storeu_ps(dst + 7 * dstStride, _mm256_permute2f128_ps(s3, s7, 0x31));
+				return;
+			}
+			else if constexpr (std::is_same_v<T, double>)
+			{
+				__m256d r0 = _mm256_loadu_pd(src + 0 * srcStride), r1 = _mm256_loadu_pd(src + 1 * srcStride);
+				__m256d r2 = _mm256_loadu_pd(src + 2 * srcStride), r3 = _mm256_loadu_pd(src + 3 * srcStride);
+				__m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+				__m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+				_mm256_storeu_pd(dst + 0 * dstStride, _mm256_permute2f128_pd(t0, t2, 0x20));
+				_mm256_storeu_pd(dst + 1 * dstStride, _mm256_permute2f128_pd(t1, t3, 0x20));
+				_mm256_storeu_pd(dst + 2 * dstStride, _mm256_permute2f128_pd(t0, t2, 0x31));
+				_mm256_storeu_pd(dst + 3 * dstStride, _mm256_permute2f128_pd(t1, t3, 0x31));
+				return;
+			}
+#elif defined(__SSE2__) || defined(_M_X64)
+			if constexpr (std::is_same_v<T, float>)
+			{
+				__m128 r0 = _mm_loadu_ps(src + 0 * srcStride), r1 = _mm_loadu_ps(src + 1 * srcStride);
+				__m128 r2 = _mm_loadu_ps(src + 2 * srcStride), r3 = _mm_loadu_ps(src + 3 * srcStride);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				_mm_storeu_ps(dst + 0 * dstStride, r0);
+				_mm_storeu_ps(dst + 1 * dstStride, r1);
+				_mm_storeu_ps(dst + 2 * dstStride, r2);
+				_mm_storeu_ps(dst + 3 * dstStride, r3);
+				return;
+			}
+			else if constexpr (std::is_same_v<T, double>)
+			{
+				__m128d r0 = _mm_loadu_pd(src), r1 = _mm_loadu_pd(src + srcStride);
+				_mm_storeu_pd(dst, _mm_unpacklo_pd(r0, r1));
+				_mm_storeu_pd(dst + dstStride, _mm_unpackhi_pd(r0, r1));
+				return;
+			}
+#endif
+			for (uint_fast64_t r = 0; r < MICRO; r++)
+				for (uint_fast64_t c = 0; c < MICRO; c++)
+					dst[c * dstStride + r] = src[r * srcStride + c];
+		}
+	};
+}
@@ -1,4 +1,5 @@
 #include <include/Matrix.hpp>
+#include <algorithm>
 
 using namespace voxel;
 
@@ -11,186 +12,219 @@ using namespace voxel;
 template <typename T>
 Matrix<T>::Matrix()
 {
-	this->rows = 0;
-	this->columns = 0;
-	this->data = alloc(0, 0);
+	alloc(0, 0);
 }
 
 template <typename T>
 Matrix<T>::Matrix(uint_fast64_t rows, uint_fast64_t columns)
 {
-	this->rows = rows;
-	this->columns = columns;
-	this->data = alloc(rows, columns);
+	alloc(rows, columns);
 }
 
 template <typename T>
-Matrix<T>::Matrix(Matrix<T> &copy)
+Matrix<T>::Matrix(const Matrix<T> &copy)
 {
-	this->rows = copy.rows;
-	this->columns = copy.columns;
-	this->data = alloc(copy.rows, copy.columns);
-	// std::copy(std::begin(*(copy.data)), std::end(*(copy.data)), std::begin(*(this.data)));
+	alloc(copy.rows, copy.columns);
+	std::copy(copy.storage, copy.storage + copy.size(), this->storage);
 }
 
 template <typename T>
-Matrix<T>::Matrix(std::vector<T> &vec)
+Matrix<T>::Matrix(Matrix<T> &&other) noexcept
+	: data(other.data), storage(other.storage), rows(other.rows), columns(other.columns)
 {
-	std::size_t vec_size = vec.size();
-	this->rows = vec_size;
-	this->columns = 1;
-	this->data = alloc(vec_size, 1);
-	for (uint_fast64_t i = 0; i < vec_size; ++i)
-	{
-		this->data[i][0] = vec.at(i);
-	}
+	other.data = nullptr;
+	other.storage = nullptr;
+	other.rows = 0;
+	other.columns = 0;
 }
 
 template <typename T>
-Matrix<T>::~Matrix()
+Matrix<T>::Matrix(const std::vector<T> &vec)
 {
-	for (uint_fast64_t i = 0; i < this->rows; i++)
-		delete[] data[i];
-	delete[] data;
+	alloc(vec.size(), 1);
+	std::copy(vec.begin(), vec.end(), this->storage);
 }
 
 template <typename T>
-void Matrix<T>::print()
+Matrix<T>::Matrix(ConstMatrixView<T> view)
 {
+	alloc(view.getRows(), view.getColumns());
 	for (uint_fast64_t i = 0; i < this->rows; i++)
 	{
-		std::cout << "|";
 		for (uint_fast64_t j = 0; j < this->columns; j++)
 		{
-			std::cout << "  " << this->data[i][j] << "  ";
+			this->data[i][j] = view(i, j);
 		}
-		std::cout << "|";
-		std::cout << std::endl;
 	}
-	std::cout << std::endl;
 }
 
 template <typename T>
-void Matrix<T>::add(T addend)
+Matrix<T>::~Matrix()
 {
-	for (uint_fast64_t i = 0; i < this->rows; i++)
-	{
-		for (uint_fast64_t j = 0; j < this->columns; j++)
-		{
-			this->data[i][j] += addend;
-		}
-	}
+	release();
 }
 
 template <typename T>
-void Matrix<T>::subtract(Matrix<T> *minuend)
+Matrix<T> &Matrix<T>::operator=(const Matrix<T> &copy)
 {
-	for (uint_fast64_t i = 0; i < this->rows; i++)
+	if (this == &copy)
+		return *this;
+
+	// Reuse the current block when the shapes already match.
+	if (this->rows != copy.rows || this->columns != copy.columns)
 	{
-		for (uint_fast64_t j = 0; j < minuend->columns; j++)
-		{
-			this->data[i][j] -= minuend->data[i][j];
-		}
+		release();
+		alloc(copy.rows, copy.columns);
 	}
+	std::copy(copy.storage, copy.storage + copy.size(), this->storage);
+	return *this;
 }
 
 template <typename T>
-void Matrix<T>::subtract(std::vector<T> *minuend)
+Matrix<T> &Matrix<T>::operator=(Matrix<T> &&other) noexcept
 {
-	std::cout << minuend->size() << std::endl;
+	if (this == &other)
+		return *this;
+
+	release();
+	this->data = other.data;
+	this->storage = other.storage;
+	this->rows = other.rows;
+	this->columns = other.columns;
+	other.data = nullptr;
+	other.storage = nullptr;
+	other.rows = 0;
+	other.columns = 0;
+	return *this;
 }
 
 template <typename T>
-void Matrix<T>::add(Matrix<T> *addend)
+void Matrix<T>::print() const
 {
-	for (uint_fast64_t i = 0; i < this->rows; i++)
+	std::cout << *this;
+}
+
+template <typename T>
+void Matrix<T>::add(T addend)
+{
+	forLinear(this->size(), [&](uint_fast64_t begin, uint_fast64_t end)
+			  {
+		for (uint_fast64_t i = begin; i < end; i++)
+			this->storage[i] += addend; });
+}
+
+template <typename T>
+void Matrix<T>::subtract(ConstMatrixView<T> minuend)
+{
+	forRows(this->rows, this->columns, [&](uint_fast64_t begin, uint_fast64_t end)
+			{
+		for (uint_fast64_t i = begin; i < end; i++)
+			for (uint_fast64_t j = 0; j < this->columns; j++)
+				this->data[i][j] -= minuend(i, j); });
+}
+
+template <typename T>
+void Matrix<T>::add(ConstMatrixView<T> addend)
+{
+	if (addend.isContiguous())
 	{
-		for (uint_fast64_t j = 0; j < this->columns; j++)
-		{
-			this->data[i][j] += addend->data[i][j];
-		}
+		const T *source = addend.getData();
+		forLinear(this->size(), [&](uint_fast64_t begin, uint_fast64_t end)
+				  {
+			for (uint_fast64_t i = begin; i < end; i++)
+				this->storage[i] += source[i]; });
+		return;
 	}
+
+	forRows(this->rows, this->columns, [&](uint_fast64_t begin, uint_fast64_t end)
+			{
+		for (uint_fast64_t i = begin; i < end; i++)
+			for (uint_fast64_t j = 0; j < this->columns; j++)
+				this->data[i][j] += addend(i, j); });
 }
 
-template <class T>
-void Matrix<T>::dot(Matrix<T> &multiplicand)
+template <typename T>
+void Matrix<T>::addColumn(ConstMatrixView<T> column)
 {
-	T **data = alloc(this->rows, multiplicand.columns);
+	if (column.getRows() != this->rows || column.getColumns() != 1)
+		return;
 
-	for (uint_fast64_t i = 0; i < this->rows; i++)
-	{
-		for (uint_fast64_t j = 0; j < multiplicand.columns; j++)
-		{
-			T sum = 0;
-			for (uint_fast64_t k = 0; k < this->columns; k++)
+	forRows(this->rows, this->columns, [&](uint_fast64_t begin, uint_fast64_t end)
 			{
-				sum += this->data[i][k] * multiplicand.data[k][j];
-			}
-			data[i][j] = sum;
-		}
-	}
+		for (uint_fast64_t i = begin; i < end; i++)
+		{
+			const T value = column(i, 0);
+			for (uint_fast64_t j = 0; j < this->columns; j++)
+				this->data[i][j] += value;
+		} });
+}
 
-	this->columns = multiplicand.columns;
-	delete this->data;
-	this->data = data;
+template <class T>
+void Matrix<T>::dot(ConstMatrixView<T> multiplicand)
+{
+	*this = Matrix<T>::dot(*this, multiplicand);
 }
 
 template <typename T>
 void Matrix<T>::randomize()
 {
-	for (uint_fast64_t i = 0; i < this->rows; i++)
+	for (uint_fast64_t i = 0; i < this->size(); i++)
 	{
-		for (uint_fast64_t j = 0; j < this->columns; j++)
-		{
-			// Genera numero aleatorio entre -1 y 1
-			this->data[i][j] = (-1) + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (1 - (-1))));
-		}
+		// Genera numero aleatorio entre -1 y 1
+		this->storage[i] = (-1) + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (1 - (-1))));
 	}
 }
 
+// Square matrices are transposed in place (no allocation), others go out of place.
 template <typename T>
 void Matrix<T>::transpose()
 {
-	T **temp = this->alloc(this->columns, this->rows);
-	for (uint_fast64_t i = 0; i < this->rows; i++)
+	if (this->rows != this->columns)
 	{
-		for (uint_fast64_t j = 0; j < this->columns; j++)
-		{
-			temp[j][i] = this->data[i][j];
-		}
+		*this = Matrix<T>::transpose(*this);
+		return;
 	}
 
-	std::swap(this->rows, this->columns);
-	delete this->data;
-	this->data = temp;
+	MatrixView<T> square = this->view();
+	const uint_fast64_t blockRows = (this->rows + Transposer<T>::LEAF - 1) / Transposer<T>::LEAF;
+	if (this->size() < PARALLEL_TRANSPOSE_THRESHOLD)
+		Transposer<T>::inPlace(square);
+	else
+		ThreadPool::instance().parallelFor(0, blockRows, 1, [&](uint_fast64_t begin, uint_fast64_t end)
+										   { Transposer<T>::inPlace(square, begin, end); });
 }
 
 template <typename T>
 void Matrix<T>::scalarProduct(T factor)
 {
-	for (uint_fast64_t i = 0; i < this->rows; i++)
-	{
-		for (uint_fast64_t j = 0; j < this->columns; j++)
-		{
-			this->data[i][j] *= factor;
-		}
-	}
+	forLinear(this->size(), [&](uint_fast64_t begin, uint_fast64_t end)
+			  {
+		for (uint_fast64_t i = begin; i < end; i++)
+			this->storage[i] *= factor; });
 }
 
 template <typename T>
-void Matrix<T>::hadamardProduct(Matrix<T> *factor)
+void Matrix<T>::hadamardProduct(ConstMatrixView<T> factor)
 {
-	for (uint_fast64_t i = 0; i < this->rows; i++)
+	if (factor.isContiguous())
 	{
-		for (uint_fast64_t j = 0; j < this->columns; j++)
-		{
-			this->data[i][j] *= factor->data[i][j];
-		}
+		const T *source = factor.getData();
+		forLinear(this->size(), [&](uint_fast64_t begin, uint_fast64_t end)
+				  {
+			for (uint_fast64_t i = begin; i < end; i++)
+				this->storage[i] *= source[i]; });
+		return;
 	}
+
+	forRows(this->rows, this->columns, [&](uint_fast64_t begin, uint_fast64_t end)
+			{
+		for (uint_fast64_t i = begin; i < end; i++)
+			for (uint_fast64_t j = 0; j < this->columns; j++)
+				this->data[i][j] *= factor(i, j); });
 }
 
 template <typename T>
-void Matrix<T>::forEach(std::function<void(T data, unsigned row, unsigned column)> callback)
+void Matrix<T>::forEach(std::function<void(T data, unsigned row, unsigned column)> callback) const
 {
 	for (unsigned i = 0; i < this->rows; ++i)
 	{
@@ -204,34 +238,53 @@ void Matrix<T>::forEach(std::function<void(T data, unsigned row, unsigned column
 template <typename T>
 void Matrix<T>::map(T (*func)(T))
 {
-	for (uint_fast64_t i = 0; i < this->rows; i++)
-	{
-		for (uint_fast64_t j = 0; j < this->columns; j++)
-		{
-			this->data[i][j] = func(this->data[i][j]);
-		}
-	}
+	forLinear(this->size(), [&](uint_fast64_t begin, uint_fast64_t end)
+			  {
+		for (uint_fast64_t i = begin; i < end; i++)
+			this->storage[i] = func(this->storage[i]); });
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+// Private typename Methods.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+// One zero-initialized block for the elements plus a table of row pointers into it.
 template <typename T>
-T **Matrix<T>::alloc(uint_fast64_t rows, uint_fast64_t columns)
+void Matrix<T>::alloc(uint_fast64_t rows, uint_fast64_t columns)
 {
-	T **data = new T *[rows];
+	this->rows = rows;
+	this->columns = columns;
+	this->storage = new T[rows * columns]();
+	this->data = new T *[rows];
 	for (uint_fast64_t i = 0; i < rows; i++)
 	{
-		data[i] = new T[columns];
+		this->data[i] = this->storage + i * columns;
 	}
-	return data;
 }
 
 template <typename T>
-unsigned Matrix<T>::getRows() { return this->rows; }
+void Matrix<T>::release()
+{
+	delete[] this->data;
+	delete[] this->storage;
+	this->data = nullptr;
+	this->storage = nullptr;
+}
 
 template <typename T>
-unsigned Matrix<T>::getColumns() { return this->columns; }
+unsigned Matrix<T>::getRows() const { return this->rows; }
+
+template <typename T>
+unsigned Matrix<T>::getColumns() const { return this->columns; }
+
+template <typename T>
+bool Matrix<T>::isEmpty() const { return this->size() == 0; }
 
 template <typename T>
 T **Matrix<T>::getData() { return this->data; }
 
+template <typename T>
+const T *const *Matrix<T>::getData() const { return this->data; }
+
 template class voxel::Matrix<float>;
-template class voxel::Matrix<double>;
\ No newline at end of file
+template class voxel::Matrix<double>;
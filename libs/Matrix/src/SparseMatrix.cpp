@@ -0,0 +1,231 @@
+#include <include/SparseMatrix.hpp>
+#include <include/ThreadPool.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace voxel;
+
+// Uploaded by panchis7u7 ~ Sebastian Madrigal
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Construction.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+template <class T>
+SparseMatrix<T>::SparseMatrix() : rows(0), columns(0), layout(SparseLayout::CSR), offsets(1, 0) {}
+
+template <class T>
+SparseMatrix<T>::SparseMatrix(uint_fast64_t rows, uint_fast64_t columns, SparseLayout layout,
+							  std::vector<Index> offsets, std::vector<Index> indices, std::vector<T> values)
+	: rows(rows), columns(columns), layout(layout), offsets(std::move(offsets)), indices(std::move(indices)), values(std::move(values))
+{
+	const uint_fast64_t outer = (layout == SparseLayout::CSR) ? rows : columns;
+	const uint_fast64_t inner = (layout == SparseLayout::CSR) ? columns : rows;
+	bool wellFormed = this->offsets.size() == outer + 1 && this->indices.size() == this->values.size() && this->offsets.back() == this->values.size();
+	// Runs that go backwards or indices past the inner dimension would send the kernels out of bounds.
+	for (uint_fast64_t o = 0; wellFormed && o < outer; o++)
+		wellFormed = this->offsets[o] <= this->offsets[o + 1];
+	for (uint_fast64_t p = 0; wellFormed && p < this->indices.size(); p++)
+		wellFormed = this->indices[p] < inner;
+	if (!wellFormed)
+	{
+		// Malformed input, keep the shape but drop the entries.
+		this->offsets.assign(outer + 1, 0);
+		this->indices.clear();
+		this->values.clear();
+	}
+}
+
+template <class T>
+SparseMatrix<T> SparseMatrix<T>::fromDense(ConstMatrixView<T> dense, SparseLayout layout, T epsilon)
+{
+	const bool csr = (layout == SparseLayout::CSR);
+	const uint_fast64_t outer = csr ? dense.getRows() : dense.getColumns();
+	const uint_fast64_t inner = csr ? dense.getColumns() : dense.getRows();
+
+	std::vector<Index> offsets(outer + 1, 0);
+	std::vector<Index> indices;
+	std::vector<T> values;
+	for (uint_fast64_t o = 0; o < outer; o++)
+	{
+		for (uint_fast64_t i = 0; i < inner; i++)
+		{
+			const T value = csr ? dense(o, i) : dense(i, o);
+			if (std::abs(value) > epsilon)
+			{
+				indices.push_back(static_cast<Index>(i));
+				values.push_back(value);
+			}
+		}
+		offsets[o + 1] = static_cast<Index>(values.size());
+	}
+	return SparseMatrix<T>(dense.getRows(), dense.getColumns(), layout, std::move(offsets), std::move(indices), std::move(values));
+}
+
+template <class T>
+SparseMatrix<T> SparseMatrix<T>::fromVector(const std::vector<T> &vec, T epsilon)
+{
+	return fromDense(ConstMatrixView<T>(vec), SparseLayout::CSC, epsilon);
+}
+
+template <class T>
+Matrix<T> SparseMatrix<T>::toDense() const
+{
+	Matrix<T> result(rows, columns);
+	T **out = result.getData();
+	const bool csr = (layout == SparseLayout::CSR);
+	for (uint_fast64_t o = 0; o + 1 < offsets.size(); o++)
+		for (Index p = offsets[o]; p < offsets[o + 1]; p++)
+		{
+			if (csr)
+				out[o][indices[p]] = values[p];
+			else
+				out[indices[p]][o] = values[p];
+		}
+	return result;
+}
+
+template <class T>
+SparseMatrix<T> SparseMatrix<T>::toLayout(SparseLayout target) const
+{
+	if (target == layout)
+		return *this;
+
+	// Counting sort on the inner index: one pass to size the new outer runs, one to scatter.
+	const uint_fast64_t outer = offsets.size() - 1;
+	const uint_fast64_t inner = (layout == SparseLayout::CSR) ? columns : rows;
+	std::vector<Index> newOffsets(inner + 1, 0);
+	for (Index index : indices)
+		newOffsets[index + 1]++;
+	for (uint_fast64_t i = 0; i < inner; i++)
+		newOffsets[i + 1] += newOffsets[i];
+
+	std::vector<Index> cursor(newOffsets.begin(), newOffsets.end() - 1);
+	std::vector<Index> newIndices(indices.size());
+	std::vector<T> newValues(values.size());
+	for (uint_fast64_t o = 0; o < outer; o++)
+		for (Index p = offsets[o]; p < offsets[o + 1]; p++)
+		{
+			const Index slot = cursor[indices[p]]++;
+			newIndices[slot] = static_cast<Index>(o);
+			newValues[slot] = values[p];
+		}
+	return SparseMatrix<T>(rows, columns, target, std::move(newOffsets), std::move(newIndices), std::move(newValues));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Kernels.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+template <class T>
+Matrix<T> SparseMatrix<T>::dot(const SparseMatrix<T> &A, ConstMatrixView<T> B)
+{
+	if (A.columns != B.getRows())
+		return Matrix<T>();
+
+	Matrix<T> result(A.rows, B.getColumns());
+	T **out = result.getData();
+	const uint_fast64_t work = A.getNonZeros() * B.getColumns();
+
+	if (A.layout == SparseLayout::CSR)
+	{
+		// Each row of the result only reads its own run, rows are split across the pool.
+		auto body = [&](uint_fast64_t begin, uint_fast64_t end)
+		{
+			for (uint_fast64_t i = begin; i < end; i++)
+				for (Index p = A.offsets[i]; p < A.offsets[i + 1]; p++)
+				{
+					const T value = A.values[p];
+					const uint_fast64_t k = A.indices[p];
+					for (uint_fast64_t j = 0; j < B.getColumns(); j++)
+						out[i][j] += value * B(k, j);
+				}
+		};
+		if (work < PARALLEL_THRESHOLD)
+			body(0, A.rows);
+		else
+			ThreadPool::instance().parallelFor(0, A.rows, 1, body);
+	}
+	else
+	{
+		// A CSC column scatters into many rows, so split on the columns of B instead.
+		auto body = [&](uint_fast64_t begin, uint_fast64_t end)
+		{
+			for (uint_fast64_t k = 0; k < A.columns; k++)
+				for (Index p = A.offsets[k]; p < A.offsets[k + 1]; p++)
+				{
+					const T value = A.values[p];
+					T *row = out[A.indices[p]];
+					for (uint_fast64_t j = begin; j < end; j++)
+						row[j] += value * B(k, j);
+				}
+		};
+		if (work < PARALLEL_THRESHOLD)
+			body(0, B.getColumns());
+		else
+			ThreadPool::instance().parallelFor(0, B.getColumns(), 1, body);
+	}
+	return result;
+}
+
+template <class T>
+Matrix<T> SparseMatrix<T>::dot(ConstMatrixView<T> A, const SparseMatrix<T> &B)
+{
+	if (A.getColumns() != B.rows)
+		return Matrix<T>();
+
+	Matrix<T> result(A.getRows(), B.columns);
+	accumulate(result, A, B, false);
+	return result;
+}
+
+template <class T>
+void SparseMatrix<T>::dot(MatrixView<T> to, ConstMatrixView<T> A, const SparseMatrix<T> &B)
+{
+	if (A.getColumns() != B.rows || to.getRows() != A.getRows() || to.getColumns() != B.columns)
+		return;
+	accumulate(to, A, B, false);
+}
+
+template <class T>
+void SparseMatrix<T>::dotTransposed(MatrixView<T> to, ConstMatrixView<T> A, const SparseMatrix<T> &B)
+{
+	if (A.getColumns() != B.columns || to.getRows() != A.getRows() || to.getColumns() != B.rows)
+		return;
+	accumulate(to, A, B, true);
+}
+
+template <class T>
+void SparseMatrix<T>::accumulate(MatrixView<T> to, ConstMatrixView<T> A, const SparseMatrix<T> &B, bool transposeB)
+{
+	// Every stored (outer, inner, v) of B adds v * A(:, k) into to(:, j). Which of outer and
+	// inner is k depends on the layout, and flips when B is read transposed.
+	const bool outerIsK = (B.layout == SparseLayout::CSR) != transposeB;
+	const uint_fast64_t outer = B.offsets.size() - 1;
+
+	// Rows of 'to' are independent, splitting on them keeps tasks write-disjoint.
+	auto body = [&](uint_fast64_t begin, uint_fast64_t end)
+	{
+		for (uint_fast64_t o = 0; o < outer; o++)
+			for (Index p = B.offsets[o]; p < B.offsets[o + 1]; p++)
+			{
+				const T value = B.values[p];
+				const uint_fast64_t k = outerIsK ? o : B.indices[p];
+				const uint_fast64_t j = outerIsK ? B.indices[p] : o;
+				for (uint_fast64_t i = begin; i < end; i++)
+					to(i, j) += value * A(i, k);
+			}
+	};
+
+	if (B.getNonZeros() * A.getRows() < PARALLEL_THRESHOLD)
+		body(0, A.getRows());
+	else
+		ThreadPool::instance().parallelFor(0, A.getRows(), 1, body);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Template Specialization.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+template class voxel::SparseMatrix<float>;
+template class voxel::SparseMatrix<double>;
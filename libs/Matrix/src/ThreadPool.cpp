@@ -0,0 +1,189 @@
+#include <include/ThreadPool.hpp>
+#include <algorithm>
+
+using namespace voxel;
+
+// Uploaded by panchis7u7 ~ Sebastian Madrigal
+
+// Index of the pool queue owned by the current thread, NO_QUEUE for outside threads.
+static constexpr unsigned NO_QUEUE = ~0u;
+static thread_local unsigned t_uQueueIndex = NO_QUEUE;
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Construction / Destruction.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::ThreadPool(unsigned workers) { start(workers); }
+
+ThreadPool::~ThreadPool() { stop(); }
+
+ThreadPool &ThreadPool::instance()
+{
+	static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	return pool;
+}
+
+void ThreadPool::resize(unsigned workers)
+{
+	stop();
+	start(workers);
+}
+
+void ThreadPool::start(unsigned workers)
+{
+	m_atbStop = false;
+	m_vQueues.clear();
+	for (unsigned i = 0; i < std::max(1u, workers); i++)
+		m_vQueues.push_back(std::make_unique<WorkQueue>());
+	for (unsigned i = 0; i < workers; i++)
+		m_vWorkers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+void ThreadPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mxSleep);
+		m_atbStop = true;
+	}
+	m_cvSleep.notify_all();
+	for (auto &worker : m_vWorkers)
+		worker.join();
+	m_vWorkers.clear();
+
+	// Drain whatever is left on the calling thread.
+	Task task;
+	while (trySteal(NO_QUEUE, task))
+		task();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Scheduling.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::submit(Task task)
+{
+	// Workers push onto their own deque, outside threads spread work round-robin.
+	unsigned index = t_uQueueIndex;
+	if (index == NO_QUEUE || index >= m_vQueues.size())
+		index = m_atuNextQueue.fetch_add(1, std::memory_order_relaxed) % m_vQueues.size();
+
+	{
+		std::lock_guard<std::mutex> lock(m_vQueues[index]->m_mxLock);
+		m_vQueues[index]->m_dqTasks.push_back(std::move(task));
+	}
+	m_atuQueued.fetch_add(1, std::memory_order_release);
+
+	if (!m_vWorkers.empty())
+	{
+		// Taking the sleep lock orders the notify after a worker's predicate check.
+		std::lock_guard<std::mutex> lock(m_mxSleep);
+	}
+	m_cvSleep.notify_one();
+}
+
+void ThreadPool::parallelFor(uint_fast64_t begin, uint_fast64_t end, uint_fast64_t grain, const RangeTask &body)
+{
+	if (begin >= end)
+		return;
+
+	const uint_fast64_t total = end - begin;
+	grain = std::max<uint_fast64_t>(1, grain);
+
+	// A few chunks per thread keeps the load balanced without drowning in tasks.
+	const uint_fast64_t maxChunks = static_cast<uint_fast64_t>(getThreadCount()) * 4;
+	const uint_fast64_t chunks = std::min(maxChunks, std::max<uint_fast64_t>(1, total / grain));
+	if (chunks == 1 || m_vWorkers.empty())
+	{
+		body(begin, end);
+		return;
+	}
+
+	const uint_fast64_t step = (total + chunks - 1) / chunks;
+	std::atomic<uint_fast64_t> pending{0};
+	for (uint_fast64_t chunkBegin = begin + step; chunkBegin < end; chunkBegin += step)
+	{
+		const uint_fast64_t chunkEnd = std::min(end, chunkBegin + step);
+		pending.fetch_add(1, std::memory_order_relaxed);
+		submit([&body, &pending, chunkBegin, chunkEnd]()
+			   {
+				   body(chunkBegin, chunkEnd);
+				   pending.fetch_sub(1, std::memory_order_release); });
+	}
+
+	// The caller takes the first chunk, then helps with queued work until its chunks are done.
+	body(begin, std::min(end, begin + step));
+	Task task;
+	while (pending.load(std::memory_order_acquire) != 0)
+	{
+		if (tryPop(t_uQueueIndex, task) || trySteal(t_uQueueIndex, task))
+			task();
+		else
+			std::this_thread::yield();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Workers.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::workerLoop(unsigned index)
+{
+	t_uQueueIndex = index;
+	Task task;
+	for (;;)
+	{
+		if (tryPop(index, task) || trySteal(index, task))
+		{
+			task();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mxSleep);
+		m_cvSleep.wait(lock, [this]()
+					   { return m_atbStop.load() || m_atuQueued.load(std::memory_order_acquire) != 0; });
+		if (m_atbStop && m_atuQueued.load(std::memory_order_acquire) == 0)
+			break;
+	}
+	t_uQueueIndex = NO_QUEUE;
+}
+
+bool ThreadPool::tryPop(unsigned index, Task &task)
+{
+	if (index >= m_vQueues.size())
+		return false;
+
+	WorkQueue &queue = *m_vQueues[index];
+	std::lock_guard<std::mutex> lock(queue.m_mxLock);
+	if (queue.m_dqTasks.empty())
+		return false;
+
+	// LIFO on the owner side keeps the most recently split work cache-hot.
+	task = std::move(queue.m_dqTasks.back());
+	queue.m_dqTasks.pop_back();
+	m_atuQueued.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool ThreadPool::trySteal(unsigned thief, Task &task)
+{
+	const unsigned queues = static_cast<unsigned>(m_vQueues.size());
+	const unsigned start = (thief == NO_QUEUE) ? 0 : thief + 1;
+	for (unsigned n = 0; n < queues; n++)
+	{
+		const unsigned victim = (start + n) % queues;
+		if (victim == thief)
+			continue;
+
+		WorkQueue &queue = *m_vQueues[victim];
+		std::lock_guard<std::mutex> lock(queue.m_mxLock);
+		if (queue.m_dqTasks.empty())
+			continue;
+
+		// FIFO on the thief side takes the oldest, usually largest, piece of work.
+		task = std::move(queue.m_dqTasks.front());
+		queue.m_dqTasks.pop_front();
+		m_atuQueued.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+	return false;
+}
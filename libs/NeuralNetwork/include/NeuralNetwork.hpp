@@ -1,6 +1,7 @@
 #pragma once
 #include "../../platform.hpp"
 #include <include/Matrix.hpp>
+#include <include/SparseMatrix.hpp>
 using namespace voxel;
 
 // Uploaded by panchis7u7 ~ Sebastian Madrigal
@@ -11,9 +12,19 @@ class NeuralNetwork
 public:
 	LIBEXP NeuralNetwork(unsigned inputNodes, unsigned hiddenNodes, unsigned outputNodes);
 	LIBEXP virtual ~NeuralNetwork();
-	LIBEXP virtual std::vector<T> *feedForward(std::vector<T> *inputVec);
-	LIBEXP virtual void train(std::vector<T> *guessesVec, std::vector<T> *answersVec);
+	LIBEXP std::vector<T> feedForward(const std::vector<T> &inputVec);
+	LIBEXP void train(const std::vector<T> &guessesVec, const std::vector<T> &answersVec);
+	// Zero-copy entry points: inputs/answers are read in place and the returned view
+	// points into the network's output buffer, valid until the next feedForward/train.
+	LIBEXP ConstMatrixView<T> feedForward(ConstMatrixView<T> inputs);
+	LIBEXP void train(ConstMatrixView<T> inputs, ConstMatrixView<T> answers);
+	// Sparse n x 1 inputs (see SparseMatrix::fromVector): the input layer only touches
+	// the weight columns of the nonzero features, forward and backward.
+	LIBEXP ConstMatrixView<T> feedForward(const SparseMatrix<T> &inputs);
+	LIBEXP void train(const SparseMatrix<T> &inputs, ConstMatrixView<T> answers);
 	LIBEXP virtual inline void printWeights();
+	unsigned getInputNodes() const { return m_uInputLayerNodes; }
+	unsigned getOutputNodes() const { return m_uOutputLayerNodes; }
 
 	static T sigmoid(T n)
 	{
@@ -30,14 +41,20 @@ protected:
 	float m_fLearningRate = 0.25f;
 	unsigned m_uInputLayerNodes;
 	unsigned m_uOutputLayerNodes;
-	Matrix<T> *m_ihWeights;
-	Matrix<T> *m_hoWeights;
-	Matrix<T> *m_hBias;
-	Matrix<T> *m_oBias;
+	Matrix<T> m_ihWeights;
+	Matrix<T> m_hoWeights;
+	Matrix<T> m_hBias;
+	Matrix<T> m_oBias;
+	Matrix<T> m_Outputs;
+
+	// Everything past the input layer, shared by the dense and sparse entry points.
+	// forwardHidden takes W_ih * inputs, backpropagate returns the input-hidden gradient.
+	virtual ConstMatrixView<T> forwardHidden(Matrix<T> &&inputProduct);
+	virtual Matrix<T> backpropagate(ConstMatrixView<T> answers);
 
 private:
 	unsigned m_uHiddenLayerNodes;
-	Matrix<T> *m_HiddenOutputWeights;
+	Matrix<T> m_HiddenOutputWeights;
 };
 
 template <class T>
@@ -46,18 +63,19 @@ class DeepNeuralNetwork : public NeuralNetwork<T>
 public:
 	LIBEXP DeepNeuralNetwork(uint_fast64_t inputLayerNodes, std::vector<uint_fast64_t> &hiddenLayerNodes, uint_fast64_t outputLayerNodes);
 	LIBEXP ~DeepNeuralNetwork() override;
-	LIBEXP std::vector<T> *feedForward(std::vector<T> *inputData) override;
-	LIBEXP void train(std::vector<T> *guesses, std::vector<T> *answers) override;
 	LIBEXP void printWeights() override;
 
+protected:
+	ConstMatrixView<T> forwardHidden(Matrix<T> &&inputProduct) override;
+	Matrix<T> backpropagate(ConstMatrixView<T> answers) override;
+
 private:
 	// Number of Hidden Layers.
 	unsigned int m_uHiddenLayerSize;
 	// std::vector<Matrix<T> *> nth_hidden_weights;
-	std::vector<Matrix<T> *> m_vHWeights;
-	std::vector<Matrix<T> *> m_vBiases;
-	std::vector<Matrix<T> *> m_vHiddenOutputWeights;
-	std::vector<Matrix<T> *> m_vErrors;
-	std::vector<Matrix<T> *> m_vGradients;
-	std::vector<Matrix<T> *> m_vDeltas;
-};
\ No newline at end of file
+	std::vector<Matrix<T>> m_vHWeights;
+	std::vector<Matrix<T>> m_vBiases;
+	std::vector<Matrix<T>> m_vHiddenOutputWeights;
+	std::vector<Matrix<T>> m_vErrors;
+	std::vector<Matrix<T>> m_vGradients;
+};
\ No newline at end of file
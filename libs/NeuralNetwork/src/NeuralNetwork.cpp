@@ -20,24 +20,23 @@ NeuralNetwork<T>::NeuralNetwork(unsigned inputLayerNodes, unsigned hiddenLayerNo
 
 	// Create matrices based upon the number of nodes supplied.
 	/********************************************************************************/
-	m_ihWeights = new Matrix<T>(m_uHiddenLayerNodes, m_uInputLayerNodes);
-	m_hoWeights = new Matrix<T>(m_uOutputLayerNodes, m_uHiddenLayerNodes);
+	m_ihWeights = Matrix<T>(m_uHiddenLayerNodes, m_uInputLayerNodes);
+	m_hoWeights = Matrix<T>(m_uOutputLayerNodes, m_uHiddenLayerNodes);
 
 	// Initialize random values into the weights matrices.
 	/********************************************************************************/
-	m_ihWeights->randomize();
-	m_hoWeights->randomize();
+	m_ihWeights.randomize();
+	m_hoWeights.randomize();
 
 	// Create bias matrices based upon the number of nodes supplied.
 	/********************************************************************************/
-	m_hBias = new Matrix<T>(m_uHiddenLayerNodes, 1);
-	m_oBias = new Matrix<T>(m_uOutputLayerNodes, 1);
+	m_hBias = Matrix<T>(m_uHiddenLayerNodes, 1);
+	m_oBias = Matrix<T>(m_uOutputLayerNodes, 1);
 
 	// Initialize random values into the bias matrices.
 	/********************************************************************************/
-	m_hBias->randomize();
-	m_oBias->randomize();
-	m_HiddenOutputWeights = nullptr;
+	m_hBias.randomize();
+	m_oBias.randomize();
 
 	LINFO("Created Simple Neural Network { Input: %u, Hidden: %u, Output: %u}", inputLayerNodes, hiddenLayerNodes, outputLayerNodes);
 }
@@ -50,10 +49,22 @@ template <typename T>
 NeuralNetwork<T>::~NeuralNetwork()
 {
 	LDEBUG("Neural Network Destroyed.");
-	delete (m_ihWeights);
-	delete (m_hoWeights);
-	delete (m_hBias);
-	delete (m_oBias);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Vector wrappers.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+std::vector<T> NeuralNetwork<T>::feedForward(const std::vector<T> &vInputs)
+{
+	return Matrix<T>::toVector(this->feedForward(ConstMatrixView<T>(vInputs)));
+}
+
+template <typename T>
+void NeuralNetwork<T>::train(const std::vector<T> &vInputs, const std::vector<T> &vAnswers)
+{
+	this->train(ConstMatrixView<T>(vInputs), ConstMatrixView<T>(vAnswers));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -61,7 +72,7 @@ NeuralNetwork<T>::~NeuralNetwork()
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename T>
-std::vector<T> *NeuralNetwork<T>::feedForward(std::vector<T> *vInputs)
+ConstMatrixView<T> NeuralNetwork<T>::feedForward(ConstMatrixView<T> mInputs)
 {
 
 	////////////////////////////////////////////////
@@ -72,28 +83,33 @@ std::vector<T> *NeuralNetwork<T>::feedForward(std::vector<T> *vInputs)
 	// sig -> Sigmoid function.
 	////////////////////////////////////////////////
 	/********************************************************************************/
+	return this->forwardHidden(Matrix<T>::dot(m_ihWeights, mInputs));
+}
 
-	if (m_HiddenOutputWeights)
-		delete m_HiddenOutputWeights;
-	m_HiddenOutputWeights = Matrix<T>::dot(m_ihWeights, vInputs);
-	m_HiddenOutputWeights->add(m_hBias);
-	m_HiddenOutputWeights->map(NeuralNetwork<T>::sigmoid);
-
-	// sig((W * i) + b) process for hidden - output.
+template <typename T>
+ConstMatrixView<T> NeuralNetwork<T>::feedForward(const SparseMatrix<T> &mInputs)
+{
+	// Only the weight columns of the nonzero inputs contribute to W * i.
 	/********************************************************************************/
-	Matrix<T> *outputs = Matrix<T>::dot(m_hoWeights, m_HiddenOutputWeights);
-	outputs->add(m_oBias);
-	outputs->map(NeuralNetwork<T>::sigmoid);
+	return this->forwardHidden(SparseMatrix<T>::dot(m_ihWeights, mInputs));
+}
 
-	// Vector conversion.
+template <typename T>
+ConstMatrixView<T> NeuralNetwork<T>::forwardHidden(Matrix<T> &&mInputProduct)
+{
+	// (W * i) + b and sigmoid for input - hidden.
 	/********************************************************************************/
-	std::vector<T> *vOutputs = Matrix<T>::toVector(outputs);
+	m_HiddenOutputWeights = std::move(mInputProduct);
+	m_HiddenOutputWeights.addColumn(m_hBias);
+	m_HiddenOutputWeights.map(NeuralNetwork<T>::sigmoid);
 
-	// Memory deallocation.
+	// sig((W * i) + b) process for hidden - output.
 	/********************************************************************************/
-	delete outputs;
+	m_Outputs = Matrix<T>::dot(m_hoWeights, m_HiddenOutputWeights);
+	m_Outputs.addColumn(m_oBias);
+	m_Outputs.map(NeuralNetwork<T>::sigmoid);
 
-	return vOutputs;
+	return m_Outputs;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -101,65 +117,65 @@ std::vector<T> *NeuralNetwork<T>::feedForward(std::vector<T> *vInputs)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename T>
-void NeuralNetwork<T>::train(std::vector<T> *vInputs, std::vector<T> *vAnswers)
+void NeuralNetwork<T>::train(ConstMatrixView<T> mInputs, ConstMatrixView<T> mAnswers)
 {
 
-	// Convert vector to a matrix type. 		TODO: Implement native vector support.
+	// Inputs and answers are read in place, outputs stay in the network buffer.
 	/********************************************************************************/
-	std::vector<T> *vOutputs = this->feedForward(vInputs);
+	this->feedForward(mInputs);
+	Matrix<T> mHiddenGradients = this->backpropagate(mAnswers);
 
-	Matrix<T> mInputs(*vInputs);
-	Matrix<T> mAnswers(*vAnswers);
-	Matrix<T> mOutputs(*vOutputs);
+	// Calculate Input-Hidden deltas.
+	/********************************************************************************/
+	Matrix<T>::dot(m_ihWeights, mHiddenGradients, mInputs.transposed());
+}
+
+template <typename T>
+void NeuralNetwork<T>::train(const SparseMatrix<T> &mInputs, ConstMatrixView<T> mAnswers)
+{
+	this->feedForward(mInputs);
+	Matrix<T> mHiddenGradients = this->backpropagate(mAnswers);
+
+	// Input-Hidden deltas, gradient * i^T only updates the columns of nonzero inputs.
+	/********************************************************************************/
+	SparseMatrix<T>::dotTransposed(m_ihWeights, mHiddenGradients, mInputs);
+}
+
+template <typename T>
+Matrix<T> NeuralNetwork<T>::backpropagate(ConstMatrixView<T> mAnswers)
+{
+	ConstMatrixView<T> mOutputs = m_Outputs;
 
 	// Error calculation.
 	// 1) Output Errors -> (respuestas -  salidas).
 	/********************************************************************************/
-	Matrix<T> *mOutputErrors = Matrix<T>::elementWiseSubstraction(&mAnswers, &mOutputs);
+	Matrix<T> mOutputErrors = Matrix<T>::elementWiseSubstraction(mAnswers, mOutputs);
 
 	// 2) Hidden Layer Errors -> (Wh^T * (Output Erros)).
 	/********************************************************************************/
-	Matrix<T> *mHoErrors = Matrix<T>::transpose(m_hoWeights);
-	mHoErrors->dot(*mOutputErrors);
+	Matrix<T> mHoErrors = Matrix<T>::dot(m_hoWeights.view().transposed(), mOutputErrors);
 
 	// Calculate output layer gradient (learning_rate * outputErrors * dsigmoid(salidas)).
 	/********************************************************************************/
-	Matrix<T> *mOutputGradients = Matrix<T>::map(&mOutputs, NeuralNetwork<T>::dsigmoid);
-	mOutputGradients->hadamardProduct(mOutputErrors);
-	mOutputGradients->scalarProduct(m_fLearningRate);
+	Matrix<T> mOutputGradients = Matrix<T>::map(mOutputs, NeuralNetwork<T>::dsigmoid);
+	mOutputGradients.hadamardProduct(mOutputErrors);
+	mOutputGradients.scalarProduct(m_fLearningRate);
 
 	// Calculate hidden layer gradient (learning_rate * HiddenErrors * dsigmoid(hidden_weights_output)).
 	/********************************************************************************/
-	Matrix<T> *mHiddenGradients = Matrix<T>::map(m_HiddenOutputWeights, NeuralNetwork<T>::dsigmoid);
-	mHiddenGradients->hadamardProduct(mHoErrors);
-	mHiddenGradients->scalarProduct(m_fLearningRate);
+	Matrix<T> mHiddenGradients = Matrix<T>::map(m_HiddenOutputWeights, NeuralNetwork<T>::dsigmoid);
+	mHiddenGradients.hadamardProduct(mHoErrors);
+	mHiddenGradients.scalarProduct(m_fLearningRate);
 
 	// Calculte Hidden-Output deltas (learning_rate * errors * dsigmoid(salidas) * weights(T)).
 	/********************************************************************************/
-	Matrix<T> *tHiddenOutputWeights = Matrix<T>::transpose(m_HiddenOutputWeights);
-	Matrix<T> *mHoDeltas = Matrix<T>::dot(mOutputGradients, tHiddenOutputWeights);
-	m_hoWeights->add(mHoDeltas);
-	m_oBias->add(mOutputGradients);
-
-	// Calculate Input-Hidden deltas.
-	/********************************************************************************/
-	Matrix<T> *tInputs = Matrix<T>::transpose(&mInputs);
-	Matrix<T> *mIhDeltas = Matrix<T>::dot(mHiddenGradients, tInputs);
-	m_ihWeights->add(mIhDeltas);
-	m_hBias->add(mHiddenGradients);
+	Matrix<T>::dot(m_hoWeights, mOutputGradients, m_HiddenOutputWeights.view().transposed());
+	m_oBias.add(mOutputGradients);
 
-	// Memory deallocation.
+	// Input-Hidden deltas are left to the caller, which knows the input format.
 	/********************************************************************************/
-
-	delete vOutputs;
-	delete mOutputErrors;
-	delete mOutputGradients;
-	delete mHiddenGradients;
-	delete tHiddenOutputWeights;
-	delete tInputs;
-	delete mHoErrors;
-	delete mIhDeltas;
-	delete mHoDeltas;
+	m_hBias.add(mHiddenGradients);
+	return mHiddenGradients;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -199,38 +215,36 @@ DeepNeuralNetwork<T>::DeepNeuralNetwork(uint_fast64_t inputLayerNodes, std::vect
 	m_vHiddenOutputWeights.reserve(m_uHiddenLayerSize);
 	m_vHWeights.reserve(m_uHiddenLayerSize - 1);
 	m_vGradients.reserve(m_uHiddenLayerSize - 1);
-	m_vDeltas.reserve(m_uHiddenLayerSize - 1);
 	m_vBiases.reserve(m_uHiddenLayerSize + 1);
 
-	// Fill previously reserved vectors with null pointers and weights with random values.
+	// Fill previously reserved vectors with empty matrices and weights with random values.
 	/********************************************************************************/
 	for (size_t i = 0; i < m_uHiddenLayerSize - 1; i++)
 	{
-		m_vGradients.push_back(nullptr);
-		m_vDeltas.push_back(nullptr);
-		m_vHWeights.push_back(new Matrix<T>(hiddenLayerNodes[i + 1], hiddenLayerNodes[i]));
-		m_vHWeights.at(i)->randomize();
-
-		m_vErrors.push_back(nullptr);
-		m_vHiddenOutputWeights.push_back(nullptr);
-		m_vBiases.push_back(new Matrix<T>(hiddenLayerNodes[i], 1));
-		m_vBiases.at(i)->randomize();
+		m_vGradients.emplace_back();
+		m_vHWeights.emplace_back(hiddenLayerNodes[i + 1], hiddenLayerNodes[i]);
+		m_vHWeights.at(i).randomize();
+
+		m_vErrors.emplace_back();
+		m_vHiddenOutputWeights.emplace_back();
+		m_vBiases.emplace_back(hiddenLayerNodes[i], 1);
+		m_vBiases.at(i).randomize();
 	}
 
-	m_vHiddenOutputWeights.push_back(nullptr);
-	m_vBiases.push_back(new Matrix<T>(hiddenLayerNodes[m_uHiddenLayerSize - 1], 1));
-	m_vBiases[(m_uHiddenLayerSize - 1)]->randomize();
-	m_vErrors.push_back(nullptr);
+	m_vHiddenOutputWeights.emplace_back();
+	m_vBiases.emplace_back(hiddenLayerNodes[m_uHiddenLayerSize - 1], 1);
+	m_vBiases[(m_uHiddenLayerSize - 1)].randomize();
+	m_vErrors.emplace_back();
 
 	// Create nth-Hidden-Output weight Matrix.
 	/********************************************************************************/
-	this->m_hoWeights = new Matrix<T>(outputLayerNodes, hiddenLayerNodes[m_uHiddenLayerSize - 1]);
-	this->m_hoWeights->randomize();
+	this->m_hoWeights = Matrix<T>(outputLayerNodes, hiddenLayerNodes[m_uHiddenLayerSize - 1]);
+	this->m_hoWeights.randomize();
 
 	// Create nth-Hidden-Output bias Matrix.
 	/********************************************************************************/
-	m_vBiases.push_back(new Matrix<T>(outputLayerNodes, 1));
-	m_vBiases.at(m_vBiases.size() - 1)->randomize();
+	m_vBiases.emplace_back(outputLayerNodes, 1);
+	m_vBiases.at(m_vBiases.size() - 1).randomize();
 
 	LINFO("Created Deep Neural Network { Input Nodes: %u, Hidden Layers: %u, Output Nodes: %u}", inputLayerNodes, hiddenLayerNodes.size(), outputLayerNodes);
 }
@@ -240,28 +254,15 @@ DeepNeuralNetwork<T>::DeepNeuralNetwork(uint_fast64_t inputLayerNodes, std::vect
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename T>
-DeepNeuralNetwork<T>::~DeepNeuralNetwork()
-{
-	for (auto &matrix : m_vErrors)
-		delete matrix;
-	for (auto &matrix : m_vGradients)
-		delete matrix;
-	for (auto &matrix : m_vDeltas)
-		delete matrix;
-	for (auto &matrix : m_vHiddenOutputWeights)
-		delete matrix;
-}
+DeepNeuralNetwork<T>::~DeepNeuralNetwork() {}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Deep Neural Net FeedForward.
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename T>
-std::vector<T> *DeepNeuralNetwork<T>::feedForward(std::vector<T> *inputVec)
+ConstMatrixView<T> DeepNeuralNetwork<T>::forwardHidden(Matrix<T> &&inputProduct)
 {
-	// Convierte el vector de entrada a una matriz
-	// Matrix<T>* entradas = Matrix<T>::fromVector(inputData);
-
 	////////////////////////////////////////////////
 	// sig((W * i) + b) process for input - hidden.
 	// W -> Weights.
@@ -270,38 +271,26 @@ std::vector<T> *DeepNeuralNetwork<T>::feedForward(std::vector<T> *inputVec)
 	// sig -> Sigmoid function.
 	////////////////////////////////////////////////
 	/********************************************************************************/
-	if (m_vHiddenOutputWeights[0] != nullptr)
-		delete m_vHiddenOutputWeights[0];
-	m_vHiddenOutputWeights[0] = Matrix<T>::dot(this->m_ihWeights, inputVec);
-	m_vHiddenOutputWeights[0]->add(m_vBiases[0]);
-	m_vHiddenOutputWeights[0]->map(NeuralNetwork<T>::sigmoid);
+	m_vHiddenOutputWeights[0] = std::move(inputProduct);
+	m_vHiddenOutputWeights[0].addColumn(m_vBiases[0]);
+	m_vHiddenOutputWeights[0].map(NeuralNetwork<T>::sigmoid);
 
 	// sig((W * i) + b) process for nth-hidden layers.
 	/********************************************************************************/
 	for (size_t i = 0; i < (m_uHiddenLayerSize - 1); i++)
 	{
-		if (m_vHiddenOutputWeights[i + 1] != nullptr)
-			delete m_vHiddenOutputWeights[i + 1];
 		m_vHiddenOutputWeights.at(i + 1) = Matrix<T>::dot(m_vHWeights.at(i), m_vHiddenOutputWeights.at(i));
-		m_vHiddenOutputWeights.at(i + 1)->add(m_vBiases.at(i + 1));
-		m_vHiddenOutputWeights.at(i + 1)->map(NeuralNetwork<T>::sigmoid);
+		m_vHiddenOutputWeights.at(i + 1).addColumn(m_vBiases.at(i + 1));
+		m_vHiddenOutputWeights.at(i + 1).map(NeuralNetwork<T>::sigmoid);
 	}
 
 	// sig((W * i) + b) process for nth-hidden and output layer.
 	/********************************************************************************/
-	Matrix<T> *outputLayerInputs = Matrix<T>::dot(this->m_hoWeights, m_vHiddenOutputWeights.at(m_vHiddenOutputWeights.size() - 1));
-	outputLayerInputs->add(m_vBiases.at(m_uHiddenLayerSize));
-	outputLayerInputs->map(NeuralNetwork<T>::sigmoid);
-
-	// Matrix to Vector conversion for return value.
-	/********************************************************************************/
-	std::vector<T> *outputVec = Matrix<T>::toVector(outputLayerInputs);
-
-	// Memory deallocation.
-	/********************************************************************************/
-	delete outputLayerInputs;
+	this->m_Outputs = Matrix<T>::dot(this->m_hoWeights, m_vHiddenOutputWeights.at(m_vHiddenOutputWeights.size() - 1));
+	this->m_Outputs.addColumn(m_vBiases.at(m_uHiddenLayerSize));
+	this->m_Outputs.map(NeuralNetwork<T>::sigmoid);
 
-	return outputVec;
+	return this->m_Outputs;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -309,100 +298,65 @@ std::vector<T> *DeepNeuralNetwork<T>::feedForward(std::vector<T> *inputVec)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template <typename T>
-void DeepNeuralNetwork<T>::train(std::vector<T> *vGuesses, std::vector<T> *vAnswers)
+Matrix<T> DeepNeuralNetwork<T>::backpropagate(ConstMatrixView<T> answers)
 {
-
-	// Obtain Neural Nets outputs, given a guess vector.
-	/********************************************************************************/
-	std::vector<T> *vOutputs = this->feedForward(vGuesses);
-
-	// Vector to Matrix conversion for Matrix operations.
+	// Outputs of the forward pass the caller just ran.
 	/********************************************************************************/
-
-	Matrix<T> inputs(*vGuesses);
-	Matrix<T> answers(*vAnswers);
-	Matrix<T> outputs(*vOutputs);
+	ConstMatrixView<T> outputs = this->m_Outputs;
 
 	// Error calculation. (Answers - Outputs)
 	/********************************************************************************/
-	Matrix<T> *outputErrors = Matrix<T>::elementWiseSubstraction(&answers, &outputs);
+	Matrix<T> outputErrors = Matrix<T>::elementWiseSubstraction(answers, outputs);
 
 	// Hidden-Output error calculation. (Backpropagation)
 	/********************************************************************************/
-	Matrix<T> *tHOWeights = Matrix<T>::transpose(this->m_hoWeights);
-	if (m_vErrors[m_uHiddenLayerSize - 1] != nullptr)
-		delete m_vErrors[m_uHiddenLayerSize - 1];
-	m_vErrors.at(m_uHiddenLayerSize - 1) = Matrix<T>::dot(tHOWeights, outputErrors);
+	m_vErrors.at(m_uHiddenLayerSize - 1) = Matrix<T>::dot(this->m_hoWeights.view().transposed(), outputErrors);
 
 	for (size_t i = m_uHiddenLayerSize - 1; i > 0; i--)
 	{
-		if (m_vErrors[i - 1] != nullptr)
-			delete m_vErrors[i - 1];
-		Matrix<T> *tHiddenWHN = Matrix<T>::transpose(m_vHWeights.at(i - 1));
-		m_vErrors.at(i - 1) = Matrix<T>::dot(tHiddenWHN, m_vErrors.at(i));
-		delete tHiddenWHN;
+		m_vErrors.at(i - 1) = Matrix<T>::dot(m_vHWeights.at(i - 1).view().transposed(), m_vErrors.at(i));
 	}
 
 	// Output layer gradient calculation. (learning_rate * outputErrors * dsigmoid(outputs))
 	/********************************************************************************/
-	Matrix<T> *outputGradient = &outputs;
-	outputGradient->map(NeuralNetwork<T>::dsigmoid);
-	outputGradient->hadamardProduct(outputErrors);
-	outputGradient->scalarProduct(this->m_fLearningRate);
-	m_vBiases.at(m_vBiases.size() - 1)->add(outputGradient);
+	Matrix<T> outputGradient = Matrix<T>::map(outputs, NeuralNetwork<T>::dsigmoid);
+	outputGradient.hadamardProduct(outputErrors);
+	outputGradient.scalarProduct(this->m_fLearningRate);
+	m_vBiases.at(m_vBiases.size() - 1).add(outputGradient);
 
 	// Hidden-(Hidden-Output) gradient calculation. (learning_rate * outputErrors * dsigmoid(salidas))
 	/********************************************************************************/
 	for (size_t i = m_uHiddenLayerSize - 1; i > 0; i--)
 	{
-		if (m_vGradients[i - 1] != nullptr)
-			delete m_vGradients[i - 1];
 		m_vGradients.at(i - 1) = Matrix<T>::map(m_vHiddenOutputWeights.at(m_uHiddenLayerSize - i), NeuralNetwork<T>::dsigmoid);
-		m_vGradients.at(i - 1)->hadamardProduct(m_vErrors.at(m_uHiddenLayerSize - i));
-		m_vGradients.at(i - 1)->scalarProduct(this->m_fLearningRate);
-		m_vBiases.at(m_uHiddenLayerSize - i)->add(m_vGradients.at(i - 1));
+		m_vGradients.at(i - 1).hadamardProduct(m_vErrors.at(m_uHiddenLayerSize - i));
+		m_vGradients.at(i - 1).scalarProduct(this->m_fLearningRate);
+		m_vBiases.at(m_uHiddenLayerSize - i).add(m_vGradients.at(i - 1));
 	}
 
 	// Input-Hidden gradient calculation. (learning_rate * outputErrors * dsigmoid(hidden_weights_output))
 	/********************************************************************************/
-	Matrix<T> *ihGradient = Matrix<T>::map(this->m_vHiddenOutputWeights.at(0), NeuralNetwork<T>::dsigmoid);
-	ihGradient->hadamardProduct(m_vErrors.at(0));
-	ihGradient->scalarProduct(this->m_fLearningRate);
-	m_vBiases.at(0)->add(ihGradient);
+	Matrix<T> ihGradient = Matrix<T>::map(this->m_vHiddenOutputWeights.at(0), NeuralNetwork<T>::dsigmoid);
+	ihGradient.hadamardProduct(m_vErrors.at(0));
+	ihGradient.scalarProduct(this->m_fLearningRate);
+	m_vBiases.at(0).add(ihGradient);
 
 	// Hidden-Output deltas calculation.
 	/********************************************************************************/
-	Matrix<T> *tHiddenOutputWeights = Matrix<T>::transpose(m_vHiddenOutputWeights.at(m_vHiddenOutputWeights.size() - 1));
-	Matrix<T> *hoDeltaWeights = Matrix<T>::dot(outputGradient, tHiddenOutputWeights);
-	this->m_hoWeights->add(hoDeltaWeights);
+	Matrix<T>::dot(this->m_hoWeights, outputGradient, m_vHiddenOutputWeights.at(m_vHiddenOutputWeights.size() - 1).view().transposed());
 
-	// Hidden-(Hidden-Output) deltas calculation.
+	// Hidden-(Hidden-Output) deltas calculation. Gradient (i - 1) belongs to hidden layer
+	// (n - i), whose weights read hidden layer (n - i - 1).
 	/********************************************************************************/
 	for (size_t i = m_uHiddenLayerSize - 1; i > 0; i--)
 	{
-		Matrix<T> *tGradient = Matrix<T>::transpose(m_vGradients.at(i - 1));
-		if (m_vDeltas[i - 1] != nullptr)
-			delete m_vDeltas[i - 1];
-		m_vDeltas.at(i - 1) = Matrix<T>::dot(m_vHiddenOutputWeights.at(i), tGradient);
-		this->m_vHWeights.at(i - 1)->add(m_vDeltas.at(i - 1));
-		delete tGradient;
+		const size_t layer = m_uHiddenLayerSize - i - 1;
+		Matrix<T>::dot(m_vHWeights.at(layer), m_vGradients.at(i - 1), m_vHiddenOutputWeights.at(layer).view().transposed());
 	}
 
-	// Input-Hidden deltas calculation.
-	/********************************************************************************/
-	inputs.transpose();
-	Matrix<T> *ihDeltaWeights = Matrix<T>::dot(ihGradient, &inputs);
-	this->m_ihWeights->add(ihDeltaWeights);
-
-	// Memory deallocation.
+	// Input-Hidden deltas are applied by train(), which knows the input format.
 	/********************************************************************************/
-	delete vOutputs;
-	delete outputErrors;
-	delete tHOWeights;
-	delete tHiddenOutputWeights;
-	delete ihGradient;
-	delete ihDeltaWeights;
-	delete hoDeltaWeights;
+	return ihGradient;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -421,7 +375,7 @@ inline void DeepNeuralNetwork<T>::printWeights()
 
 	// nth Hidden wieghts matrix print.
 	/********************************************************************************/
-	for (auto nth_hidden_weights : this->m_vHWeights)
+	for (const auto &nth_hidden_weights : this->m_vHWeights)
 	{
 		std::cout << "#### Layer " << layer << " ####"
 				  << "\n\n"
@@ -438,4 +392,4 @@ inline void DeepNeuralNetwork<T>::printWeights()
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 template class NeuralNetwork<float>;
-template class DeepNeuralNetwork<float>;
\ No newline at end of file
+template class DeepNeuralNetwork<float>;
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "../platform.hpp"
+#include <include/FrameDecoder.hpp>
+#include <include/NeuralNetwork.hpp>
+#include <include/SlotRing.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <thread>
+#include <vector>
+
+class SerialPort;
+class BufferQueue;
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Inference pipeline class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+// Streams sensor records from a serial link through a network:
+//
+//   source -> [decoder thread] -> SlotRing -> [inference thread] -> SlotRing -> nextPrediction()
+//
+// The decoder thread frames the received bytes (FrameDecoder) and writes each record's
+// features straight into a slot of the record ring, the only copy they get; the records of
+// a chunk are published once the source confirms its bytes were intact. The inference
+// thread takes every record waiting (up to maxBatch) as one batch and hands the slots to
+// feedForward() in place, as a strided matrix with one record per column; a busier link
+// makes bigger batches. Predictions go out through a second ring. Both threads can be
+// pinned to a core. Full rings drop records and count them rather than stall the link.
+//
+// A record is 'features' native-endian floats, framed as Options::framing says.
+LIBEXP class InferencePipeline {
+public:
+    struct Source {
+        // The bytes received since the last call, at most 'timeout' waiting for some; empty
+        // if none came. The span stays valid until the next call.
+        std::function<std::span<const char>(std::chrono::nanoseconds timeout)> read;
+        // Called once the bytes 'read' handed out are decoded, false if they were overwritten
+        // meanwhile (read in place from shared memory): their records are then dropped.
+        // Unset for a source whose bytes cannot change.
+        std::function<bool()> release = nullptr;
+    };
+
+    struct Options {
+        FrameDecoder::Framing framing = { FrameDecoder::Framing::LENGTH_PREFIX };
+        size_t maxBatch = 32;
+        // How long a batch may wait to fill up once its first record is in; 0 takes what is there.
+        std::chrono::microseconds batchWindow{ 0 };
+        // Records, and predictions, in flight.
+        size_t queueDepth = 4096;
+        // Cores for the decoder and inference threads, -1 leaves them to the scheduler.
+        int decoderCpu = -1;
+        int inferenceCpu = -1;
+    };
+
+    struct Prediction {
+        // Position of the record in the stream, from 0.
+        uint64_t sequence = 0;
+        // Received, on the steady clock, and from then to its prediction being published.
+        std::chrono::nanoseconds received{ 0 };
+        std::chrono::nanoseconds latency{ 0 };
+        std::vector<float> outputs;
+    };
+
+    struct Stats {
+        uint64_t records = 0;
+        uint64_t predictions = 0;
+        uint64_t batches = 0;
+        // Frames of the wrong size, the decoder's framing errors, or records of bytes
+        // overwritten while they were decoded.
+        uint64_t malformed = 0;
+        // Refused by a full ring.
+        uint64_t dropped = 0;
+        // Receive to prediction; percentiles to within 1/8 (histogram buckets).
+        std::chrono::nanoseconds latencyMean{ 0 };
+        std::chrono::nanoseconds latencyP50{ 0 };
+        std::chrono::nanoseconds latencyP99{ 0 };
+        std::chrono::nanoseconds latencyMax{ 0 };
+    };
+
+    // 'network' takes 'features' inputs and gives 'outputs'; only the inference thread uses
+    // it while the pipeline runs. Sizes the network does not have are logged and leave a
+    // pipeline that does not start().
+    InferencePipeline(NeuralNetwork<float>& network, size_t features, size_t outputs, Source source, Options options);
+    InferencePipeline(NeuralNetwork<float>& network, size_t features, size_t outputs, Source source)
+        : InferencePipeline(network, features, outputs, std::move(source), Options()) {}
+    ~InferencePipeline();
+    InferencePipeline(const InferencePipeline&) = delete;
+    InferencePipeline& operator=(const InferencePipeline&) = delete;
+
+    // False if the pipeline cannot run (see the constructor).
+    bool start();
+    // Stops both threads; records still queued are dropped.
+    void stop();
+
+    // The next prediction, waiting up to 'timeout'. For one consuming thread.
+    bool nextPrediction(Prediction& prediction, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0));
+    Stats getStats() const;
+
+    // What a port receives (copied out of its inbound buffer).
+    static Source fromSerialPort(SerialPort& port);
+    // What a port publishes to other processes, read in place.
+    static Source fromBufferQueue(BufferQueue& queue);
+
+private:
+    void decode();
+    void infer();
+    void onFrame(std::string_view frame);
+    void recordLatency(uint64_t nanoseconds);
+    static void pin(int cpu);
+
+    // Slot headers, ahead of the features (records) or outputs (predictions).
+    struct RecordHeader {
+        uint64_t sequence;
+        int64_t received;
+    };
+    struct PredictionHeader {
+        uint64_t sequence;
+        int64_t received;
+        int64_t latency;
+    };
+
+    // Latency histogram: 8 linear buckets per power of two.
+    static constexpr size_t LATENCY_BUCKETS = 62 * 8;
+    static size_t bucketOf(uint64_t nanoseconds);
+    static uint64_t bucketLimit(size_t bucket);
+
+    NeuralNetwork<float>& m_nnNetwork;
+    size_t m_uFeatures;
+    size_t m_uOutputs;
+    Source m_fnSource;
+    Options m_oOptions;
+    bool m_bValid = true;
+
+    SlotRing m_srRecords;
+    SlotRing m_srPredictions;
+    std::thread m_tDecoder;
+    std::thread m_tInference;
+    std::atomic<bool> m_atbStopping{ false };
+
+    // Decoder thread. Records claimed for the chunk being decoded, not published yet.
+    int64_t m_iReceived = 0;
+    uint64_t m_uSequence = 0;
+    size_t m_uClaimed = 0;
+    uint64_t m_uTorn = 0;
+
+    // Written by one thread each, read by getStats().
+    std::atomic<uint64_t> m_atuRecords{ 0 };
+    std::atomic<uint64_t> m_atuMalformed{ 0 };
+    std::atomic<uint64_t> m_atuDroppedRecords{ 0 };
+    std::atomic<uint64_t> m_atuPredictions{ 0 };
+    std::atomic<uint64_t> m_atuBatches{ 0 };
+    std::atomic<uint64_t> m_atuDroppedPredictions{ 0 };
+    std::atomic<uint64_t> m_atuLatencySum{ 0 };
+    std::atomic<uint64_t> m_atuLatencyMax{ 0 };
+    std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> m_aLatency{};
+};
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// End Inference pipeline class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
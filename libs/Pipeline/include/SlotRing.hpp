@@ -0,0 +1,124 @@
+#pragma once
+
+#include "../platform.hpp"
+#include <include/Futex.hpp>
+#include <include/SharedMessage.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// SPSC slot ring class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+// Lock-free single-producer / single-consumer ring of fixed-size records whose size is only
+// known at run time (a header and N features). The producer fills a slot in place and
+// publishes it, the consumer uses runs of slots in place and releases them; slots are back
+// to back, so a run is one strided matrix. The producer never blocks: a full ring refuses
+// the record. The consumer may sleep on a futex, woken only when it is asleep.
+class SlotRing {
+public:
+    // 'slots' is rounded up to a power of two, 'slotSize' to 8 bytes.
+    SlotRing(size_t slots, size_t slotSize) : m_uSlotSize((slotSize + 7) & ~size_t(7)) {
+        size_t count = 1;
+        while (count < slots) count <<= 1;
+        m_uMask = count - 1;
+        m_pData = std::make_unique<uint64_t[]>(count * m_uSlotSize / sizeof(uint64_t));
+    }
+    SlotRing(const SlotRing&) = delete;
+    SlotRing& operator=(const SlotRing&) = delete;
+
+    size_t capacity() const { return m_uMask + 1; }
+    size_t getSlotSize() const { return m_uSlotSize; }
+
+    //###############################################################################################
+    // Producer.
+    //###############################################################################################
+
+    // The free slot 'ahead' past the next one, to fill; nullptr while the ring has no room
+    // for it. Several can be filled before they are published together.
+    char* claim(size_t ahead = 0) {
+        const size_t tail = m_atuTail.load(std::memory_order_relaxed) + ahead;
+        if (tail - m_atuHead.load(std::memory_order_acquire) >= capacity()) return nullptr;
+        return slot(tail);
+    }
+
+    // Hands the next 'count' claimed slots to the consumer.
+    void publish(size_t count = 1) {
+        // seq_cst pairs with the consumer's store to m_atuWaiting: either it sees the slot or
+        // we see it asleep.
+        m_atuTail.store(m_atuTail.load(std::memory_order_relaxed) + count, std::memory_order_seq_cst);
+        if (m_atuWaiting.load(std::memory_order_seq_cst)) wake();
+    }
+
+    // Wakes a consumer blocked in wait() and makes it return (shutdown).
+    void signal() {
+        m_atuSignals.fetch_add(1, std::memory_order_release);
+        wake();
+    }
+
+    //###############################################################################################
+    // Consumer.
+    //###############################################################################################
+
+    size_t available() const {
+        return m_atuTail.load(std::memory_order_acquire) - m_atuHead.load(std::memory_order_relaxed);
+    }
+
+    // The oldest readable slot and how many follow it without wrapping around the ring.
+    const char* front(size_t& run) const {
+        const size_t head = m_atuHead.load(std::memory_order_relaxed);
+        run = std::min(available(), capacity() - (head & m_uMask));
+        return slot(head);
+    }
+
+    void release(size_t count) { m_atuHead.store(m_atuHead.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+
+    // Sleeps until more than 'have' slots are readable, signal(), or 'timeout'. True if there are.
+    bool wait(size_t have, std::chrono::nanoseconds timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        const uint32_t signals = m_atuSignals.load(std::memory_order_acquire);
+        while (available() <= have) {
+            const uint32_t signal = m_atuSignal.load(std::memory_order_acquire);
+            m_atuWaiting.store(1, std::memory_order_seq_cst);
+            if (available() > have) break;
+            std::chrono::nanoseconds left = WAIT_FOREVER;
+            if (timeout.count() >= 0) {
+                left = deadline - std::chrono::steady_clock::now();
+                if (left.count() <= 0) break;
+            }
+            Futex::wait(m_atuSignal, signal, left);
+            if (m_atuSignals.load(std::memory_order_acquire) != signals) break;
+        }
+        m_atuWaiting.store(0, std::memory_order_relaxed);
+        return available() > have;
+    }
+
+private:
+    char* slot(size_t position) const { return reinterpret_cast<char*>(m_pData.get()) + (position & m_uMask) * m_uSlotSize; }
+
+    void wake() {
+        m_atuSignal.fetch_add(1, std::memory_order_release);
+        Futex::wake(m_atuSignal);
+    }
+
+    size_t m_uSlotSize;
+    size_t m_uMask = 0;
+    // uint64_t: slots start 8 byte aligned for their headers.
+    std::unique_ptr<uint64_t[]> m_pData;
+
+    // The consumer writes the first line, the producer the second, the producer and
+    // signal() the third.
+    alignas(FALSE_SHARING_SIZE) std::atomic<size_t> m_atuHead{ 0 };
+    std::atomic<uint32_t> m_atuWaiting{ 0 };
+    alignas(FALSE_SHARING_SIZE) std::atomic<size_t> m_atuTail{ 0 };
+    alignas(FALSE_SHARING_SIZE) std::atomic<uint32_t> m_atuSignal{ 0 };
+    std::atomic<uint32_t> m_atuSignals{ 0 };
+};
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// End SPSC slot ring class.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
@@ -0,0 +1,245 @@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+// Inference pipeline implementation.
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+#include <include/InferencePipeline.hpp>
+#include <include/BufferQueue.hpp>
+#include <include/Logger.hpp>
+#include <include/SerialPort.hpp>
+#include <bit>
+#include <cstring>
+
+#ifdef LINUX_PLATFORM
+#include <sched.h>
+#endif
+
+namespace {
+    // How often an idle stage looks up to see whether it should stop.
+    constexpr std::chrono::milliseconds SOURCE_POLL{ 50 };
+
+    int64_t steadyNow() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+InferencePipeline::InferencePipeline(NeuralNetwork<float>& network, size_t features, size_t outputs, Source source, Options options)
+    : m_nnNetwork(network), m_uFeatures(features), m_uOutputs(outputs), m_fnSource(std::move(source)), m_oOptions(options),
+      m_srRecords(options.queueDepth, sizeof(RecordHeader) + features * sizeof(float)),
+      m_srPredictions(options.queueDepth, sizeof(PredictionHeader) + outputs * sizeof(float)) {
+    m_oOptions.maxBatch = std::max<size_t>(1, std::min(m_oOptions.maxBatch, m_srRecords.capacity()));
+    // feedForward() does not check shapes: the wrong sizes would read past the slots and the
+    // network's outputs.
+    if (features != network.getInputNodes() || outputs != network.getOutputNodes()) {
+        LERROR("Pipeline|%zu features and %zu outputs given, the network has %u and %u.", features, outputs,
+               network.getInputNodes(), network.getOutputNodes());
+        m_bValid = false;
+    }
+}
+
+InferencePipeline::~InferencePipeline() { stop(); }
+
+bool InferencePipeline::start() {
+    if (!m_bValid) return false;
+    if (m_tDecoder.joinable()) return true;
+    m_atbStopping.store(false, std::memory_order_relaxed);
+    m_tInference = std::thread(&InferencePipeline::infer, this);
+    m_tDecoder = std::thread(&InferencePipeline::decode, this);
+    return true;
+}
+
+void InferencePipeline::stop() {
+    if (!m_tDecoder.joinable()) return;
+    m_atbStopping.store(true, std::memory_order_release);
+    m_tDecoder.join();
+    m_srRecords.signal();
+    m_tInference.join();
+}
+
+bool InferencePipeline::nextPrediction(Prediction& prediction, std::chrono::nanoseconds timeout) {
+    if (!m_srPredictions.wait(0, timeout)) return false;
+    size_t run;
+    const char* slot = m_srPredictions.front(run);
+    PredictionHeader header;
+    std::memcpy(&header, slot, sizeof(header));
+    prediction.sequence = header.sequence;
+    prediction.received = std::chrono::nanoseconds(header.received);
+    prediction.latency = std::chrono::nanoseconds(header.latency);
+    const float* outputs = reinterpret_cast<const float*>(slot + sizeof(PredictionHeader));
+    prediction.outputs.assign(outputs, outputs + m_uOutputs);
+    m_srPredictions.release(1);
+    return true;
+}
+
+InferencePipeline::Stats InferencePipeline::getStats() const {
+    Stats stats;
+    stats.records = m_atuRecords.load(std::memory_order_relaxed);
+    stats.predictions = m_atuPredictions.load(std::memory_order_relaxed);
+    stats.batches = m_atuBatches.load(std::memory_order_relaxed);
+    stats.malformed = m_atuMalformed.load(std::memory_order_relaxed);
+    stats.dropped = m_atuDroppedRecords.load(std::memory_order_relaxed) + m_atuDroppedPredictions.load(std::memory_order_relaxed);
+
+    uint64_t counts[LATENCY_BUCKETS], total = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) total += counts[i] = m_aLatency[i].load(std::memory_order_relaxed);
+    if (total == 0) return stats;
+    stats.latencyMean = std::chrono::nanoseconds(m_atuLatencySum.load(std::memory_order_relaxed) / total);
+    stats.latencyMax = std::chrono::nanoseconds(m_atuLatencyMax.load(std::memory_order_relaxed));
+    const auto percentile = [&](uint64_t rank) {
+        uint64_t seen = 0;
+        for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+            if ((seen += counts[i]) >= rank) return std::chrono::nanoseconds(std::min<uint64_t>(bucketLimit(i), uint64_t(stats.latencyMax.count())));
+        return stats.latencyMax;
+    };
+    stats.latencyP50 = percentile((total + 1) / 2);
+    stats.latencyP99 = percentile(total - total / 100);
+    return stats;
+}
+
+//###################################################################################################
+// Sources.
+//###################################################################################################
+
+InferencePipeline::Source InferencePipeline::fromSerialPort(SerialPort& port) {
+    // A copy: nothing to release.
+    auto buffer = std::make_shared<std::vector<char>>(64 * 1024);
+    return { [&port, buffer](std::chrono::nanoseconds timeout) {
+        return std::span<const char>(buffer->data(), port.read(*buffer, timeout));
+    } };
+}
+
+InferencePipeline::Source InferencePipeline::fromBufferQueue(BufferQueue& queue) {
+    // Seqlock: the message is decoded in place, then validated; only then are its records used.
+    return { [&queue](std::chrono::nanoseconds timeout) { return queue.peek(timeout); },
+             [&queue]() { return queue.release(); } };
+}
+
+//###################################################################################################
+// Decoder thread.
+//###################################################################################################
+
+void InferencePipeline::decode() {
+    pin(m_oOptions.decoderCpu);
+    FrameDecoder::Framing framing = m_oOptions.framing;
+    framing.maxFrameSize = std::max(framing.maxFrameSize, m_uFeatures * sizeof(float));
+    FrameDecoder decoder(framing, [this](std::string_view frame) { onFrame(frame); });
+    uint64_t errors = 0;
+    while (!m_atbStopping.load(std::memory_order_acquire)) {
+        const std::span<const char> bytes = m_fnSource.read(SOURCE_POLL);
+        if (bytes.empty()) continue;
+        // Latency runs from here: the bytes are off the port and in our hands.
+        m_iReceived = steadyNow();
+        decoder.feed(bytes);
+        if (m_fnSource.release && !m_fnSource.release()) {
+            // Overwritten while decoded: neither its records nor a frame it started are used.
+            if (m_uTorn++ == 0) LERROR("Pipeline|source overwrote bytes while they were decoded, records dropped.");
+            m_atuMalformed.fetch_add(m_uClaimed, std::memory_order_relaxed);
+            decoder.reset();
+        } else if (m_uClaimed != 0) {
+            m_srRecords.publish(m_uClaimed);
+            m_atuRecords.fetch_add(m_uClaimed, std::memory_order_relaxed);
+        }
+        m_uClaimed = 0;
+        if (decoder.getErrors() != errors) {
+            m_atuMalformed.fetch_add(decoder.getErrors() - errors, std::memory_order_relaxed);
+            errors = decoder.getErrors();
+        }
+    }
+}
+
+void InferencePipeline::onFrame(std::string_view frame) {
+    if (frame.size() != m_uFeatures * sizeof(float)) {
+        m_atuMalformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const uint64_t sequence = m_uSequence++;
+    char* slot = m_srRecords.claim(m_uClaimed);
+    if (slot == nullptr) {
+        if (m_atuDroppedRecords.fetch_add(1, std::memory_order_relaxed) == 0)
+            LERROR("Pipeline|inference too slow, records dropped.");
+        return;
+    }
+    const RecordHeader header = { sequence, m_iReceived };
+    std::memcpy(slot, &header, sizeof(header));
+    // Decoding is this copy: the bytes are the floats.
+    std::memcpy(slot + sizeof(RecordHeader), frame.data(), frame.size());
+    m_uClaimed++;
+}
+
+//###################################################################################################
+// Inference thread.
+//###################################################################################################
+
+void InferencePipeline::infer() {
+    pin(m_oOptions.inferenceCpu);
+    const size_t stride = m_srRecords.getSlotSize() / sizeof(float);
+    while (!m_atbStopping.load(std::memory_order_acquire)) {
+        // stop() signals the ring; the timeout covers a signal sent before this wait began.
+        if (!m_srRecords.wait(0, SOURCE_POLL)) continue;
+        if (m_oOptions.batchWindow.count() > 0 && m_srRecords.available() < m_oOptions.maxBatch)
+            m_srRecords.wait(m_oOptions.maxBatch - 1, m_oOptions.batchWindow);
+
+        // The batch is the slots themselves, one record per column, up to the ring's end.
+        size_t run;
+        const char* first = m_srRecords.front(run);
+        if (run == 0) continue;
+        const size_t batch = std::min(run, m_oOptions.maxBatch);
+        const float* features = reinterpret_cast<const float*>(first + sizeof(RecordHeader));
+        const ConstMatrixView<float> outputs = m_nnNetwork.feedForward(ConstMatrixView<float>(features, batch, m_uFeatures, stride).transposed());
+        const int64_t now = steadyNow();
+
+        size_t published = 0;
+        for (size_t i = 0; i < batch; i++) {
+            RecordHeader record;
+            std::memcpy(&record, first + i * m_srRecords.getSlotSize(), sizeof(record));
+            const uint64_t latency = uint64_t(std::max<int64_t>(0, now - record.received));
+            recordLatency(latency);
+            char* slot = m_srPredictions.claim();
+            if (slot == nullptr) {
+                m_atuDroppedPredictions.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            const PredictionHeader header = { record.sequence, record.received, int64_t(latency) };
+            std::memcpy(slot, &header, sizeof(header));
+            float* values = reinterpret_cast<float*>(slot + sizeof(PredictionHeader));
+            for (size_t j = 0; j < m_uOutputs; j++) values[j] = outputs(j, i);
+            m_srPredictions.publish();
+            published++;
+        }
+        m_srRecords.release(batch);
+        m_atuPredictions.fetch_add(published, std::memory_order_relaxed);
+        m_atuBatches.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+//###################################################################################################
+// Latency histogram.
+//###################################################################################################
+
+size_t InferencePipeline::bucketOf(uint64_t nanoseconds) {
+    if (nanoseconds < 8) return size_t(nanoseconds);
+    const unsigned exponent = unsigned(std::bit_width(nanoseconds)) - 1;
+    return (exponent - 2) * 8 + size_t((nanoseconds >> (exponent - 3)) & 7);
+}
+
+uint64_t InferencePipeline::bucketLimit(size_t bucket) {
+    if (bucket < 8) return bucket;
+    const unsigned exponent = unsigned(bucket / 8) + 2;
+    return ((8 + bucket % 8 + 1) << (exponent - 3)) - 1;
+}
+
+void InferencePipeline::recordLatency(uint64_t nanoseconds) {
+    m_aLatency[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_atuLatencySum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    if (nanoseconds > m_atuLatencyMax.load(std::memory_order_relaxed)) m_atuLatencyMax.store(nanoseconds, std::memory_order_relaxed);
+}
+
+void InferencePipeline::pin(int cpu) {
+#ifdef LINUX_PLATFORM
+    if (cpu < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) LERROR("Pipeline|could not pin a thread to core %d.", cpu);
+#else
+    (void)cpu;
+#endif
+}
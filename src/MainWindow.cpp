@@ -24,7 +24,7 @@ void MainWindow::on_cbxComPorts_activated(int index) {
 void MainWindow::on_pbConnectSerial_clicked() {
     QString selectedItem = ui->cbxComPorts->currentText();
     if(selectedItem != "") {
-        m_spPort = new SerialPort(selectedItem.toStdString(), PortUtils::Serial::BaudRate::B9600);
+        m_spPort = new SerialPort(selectedItem.toStdString(), PortUtils::Serial::BaudRate::BAUD_9600);
         m_spPort->connect();
     }
 }
@@ -10,7 +10,7 @@
 #endif
 // Uploaded by panchis7u7 ~ Sebastian Madrigal
 
-int main(int argc, char* argv[])
+int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[])
 {
 	#ifdef QT_IS_AVAILABLE
 		QApplication app(argc, argv);
@@ -29,12 +29,12 @@ int main(int argc, char* argv[])
 	for (size_t i = 0; i < 30000; i++)
 	{
 		int index = rand() % 4;
-		nn->train(&entradas[index], &esperado[index]);
+		nn->train(entradas[index], esperado[index]);
 	}
-	std::cout << "0,0: " << nn->feedForward(&entradas[0])->at(0) << std::endl;
-	std::cout << "0,1: " << nn->feedForward(&entradas[1])->at(0) << std::endl;
-	std::cout << "1,0: " << nn->feedForward(&entradas[2])->at(0) << std::endl;
-	std::cout << "1,1: " << nn->feedForward(&entradas[3])->at(0) << std::endl;
+	std::cout << "0,0: " << nn->feedForward(entradas[0]).at(0) << std::endl;
+	std::cout << "0,1: " << nn->feedForward(entradas[1]).at(0) << std::endl;
+	std::cout << "1,0: " << nn->feedForward(entradas[2]).at(0) << std::endl;
+	std::cout << "1,1: " << nn->feedForward(entradas[3]).at(0) << std::endl;
 
 	std::cout << std::endl;
 	std::vector<uint_fast64_t> f1 = {4, 4};
@@ -42,15 +42,15 @@ int main(int argc, char* argv[])
 	for (size_t i = 0; i < 150000; i++)
 	{
 		int index = rand() % 4;
-		nn2->train(&entradas[index], &esperado[index]);
+		nn2->train(entradas[index], esperado[index]);
 	}
-	std::cout << "0,0: " << nn2->feedForward(&entradas[0])->at(0) << std::endl;
-	std::cout << "0,1: " << nn2->feedForward(&entradas[1])->at(0) << std::endl;
-	std::cout << "1,0: " << nn2->feedForward(&entradas[2])->at(0) << std::endl;
-	std::cout << "1,1: " << nn2->feedForward(&entradas[3])->at(0) << std::endl;
+	std::cout << "0,0: " << nn2->feedForward(entradas[0]).at(0) << std::endl;
+	std::cout << "0,1: " << nn2->feedForward(entradas[1]).at(0) << std::endl;
+	std::cout << "1,0: " << nn2->feedForward(entradas[2]).at(0) << std::endl;
+	std::cout << "1,1: " << nn2->feedForward(entradas[3]).at(0) << std::endl;
 
 	std::vector<float> guess{1.0, 1.0};
-	std::cout << nn2->feedForward(&guess)->at(0) << std::endl;
+	std::cout << nn2->feedForward(guess).at(0) << std::endl;
 	nn2->printWeights();
 
 	/*std::list<int> ports = getAvailablePorts();
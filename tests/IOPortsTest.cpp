@@ -0,0 +1,669 @@
+#include <include/DeviceManager.hpp>
+#include <include/EventLoop.hpp>
+#include <include/FrameDecoder.hpp>
+#include <include/SerialCapture.hpp>
+#include <include/SerialPort.hpp>
+#include <include/SpscByteRing.hpp>
+#include <include/BufferQueue.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+    // Polls 'done' for up to a second, the loop runs on its own thread.
+    template <class Done>
+    bool eventually(Done&& done) {
+        for (int i = 0; i < 1000 && !done(); i++) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return done();
+    }
+
+    // Raw pty pair, the slave non-blocking: a local stand-in for a serial device.
+    bool openPty(int& master, int& slave) {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return false;
+        slave = open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        struct termios tty;
+        if (slave < 0 || tcgetattr(slave, &tty) != 0) return false;
+        cfmakeraw(&tty);
+        return tcsetattr(slave, TCSANOW, &tty) == 0;
+    }
+}
+
+TEST(EventLoopFds, IOPorts)
+{
+    EventLoop loop;
+    int fds[2];
+    ASSERT_EQ(pipe2(fds, O_NONBLOCK), 0);
+
+    // Edge triggered: the callback drains, and hears about each new write once.
+    std::atomic<int> bytes{ 0 }, wakeups{ 0 };
+    ASSERT_TRUE(loop.add(fds[0], EventLoop::READABLE | EventLoop::EDGE_TRIGGERED, [&](uint32_t events) {
+        EXPECT_TRUE(events & EventLoop::READABLE);
+        char buffer[16];
+        ssize_t n;
+        while ((n = ::read(fds[0], buffer, sizeof(buffer))) > 0) bytes += n;
+        wakeups++;
+    }));
+    ASSERT_EQ(::write(fds[1], "0123456789abcdefXYZ", 19), 19);
+    EXPECT_TRUE(eventually([&]() { return bytes == 19; }));
+    ASSERT_EQ(::write(fds[1], "more", 4), 4);
+    EXPECT_TRUE(eventually([&]() { return bytes == 23; }));
+    EXPECT_EQ(wakeups, 2);
+
+    // After remove() returns the callback is gone for good.
+    loop.remove(fds[0]);
+    ASSERT_EQ(::write(fds[1], "late", 4), 4);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(bytes, 23);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(EventLoopTimers, IOPorts)
+{
+    EventLoop loop;
+    std::atomic<int> ticks{ 0 }, once{ 0 };
+    const int timer = loop.addTimer(std::chrono::milliseconds(2), [&]() { ticks++; });
+    ASSERT_GE(timer, 0);
+    ASSERT_GE(loop.addTimer(std::chrono::milliseconds(1), [&]() { once++; }, false), 0);
+
+    EXPECT_TRUE(eventually([&]() { return ticks >= 5; }));
+    loop.cancelTimer(timer);
+    const int stopped = ticks;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(ticks, stopped);
+    EXPECT_EQ(once, 1);
+
+    // Tasks from other threads run on the loop thread.
+    bool onLoop = false;
+    loop.runSync([&]() { onLoop = loop.isLoopThread(); });
+    EXPECT_TRUE(onLoop);
+}
+
+TEST(EventLoopStreams, IOPorts)
+{
+    std::string pattern;
+    for (int i = 0; i < 1 << 16; i++) pattern += char('a' + i % 26);
+
+    for (EventLoop::Backend backend : { EventLoop::Backend::EPOLL, EventLoop::Backend::IO_URING }) {
+        EventLoop loop(backend);
+        int master, slave;
+        ASSERT_TRUE(openPty(master, slave));
+
+        // The slave echoes what it reads through write(), the far end checks both ways.
+        std::mutex lock;
+        std::string received;
+        std::atomic<bool> ended{ false };
+        ASSERT_TRUE(loop.addReader(slave, [&](std::span<const char> data) {
+            if (data.empty()) {
+                ended = true;
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                received.append(data.data(), data.size());
+            }
+            loop.write(slave, data);
+        }));
+
+        std::thread writer([&]() {
+            for (size_t sent = 0; sent < pattern.size(); sent += 1000)
+                ASSERT_GT(::write(master, pattern.data() + sent, std::min<size_t>(1000, pattern.size() - sent)), 0);
+        });
+        std::string echoed;
+        char buffer[4096];
+        struct pollfd ready = { master, POLLIN, 0 };
+        while (echoed.size() < pattern.size() && poll(&ready, 1, 2000) > 0) {
+            const ssize_t n = ::read(master, buffer, sizeof(buffer));
+            if (n <= 0) break;
+            echoed.append(buffer, size_t(n));
+        }
+        writer.join();
+        EXPECT_EQ(echoed, pattern);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            EXPECT_EQ(received, pattern);
+        }
+
+        // Hanging up the far end ends the stream, once.
+        close(master);
+        EXPECT_TRUE(eventually([&]() { return ended.load(); }));
+        loop.remove(slave);
+        close(slave);
+    }
+}
+
+TEST(EventLoopReadBuffer, IOPorts)
+{
+    // On epoll the reader's own buffer is read into, no copy in between.
+    EventLoop loop(EventLoop::Backend::EPOLL);
+    int master, slave;
+    ASSERT_TRUE(openPty(master, slave));
+
+    std::vector<char> own(256);
+    std::mutex lock;
+    std::string received;
+    std::atomic<bool> inPlace{ true };
+    ASSERT_TRUE(loop.addReader(slave, [&](std::span<const char> data) {
+        if (data.empty()) return;
+        if (data.data() != own.data()) inPlace = false;
+        std::lock_guard<std::mutex> guard(lock);
+        received.append(data.data(), data.size());
+    }, [&]() { return std::span<char>(own); }));
+
+    ASSERT_EQ(::write(master, "hello", 5), 5);
+    EXPECT_TRUE(eventually([&]() {
+        std::lock_guard<std::mutex> guard(lock);
+        return received == "hello";
+    }));
+    EXPECT_TRUE(inPlace.load());
+
+    loop.remove(slave);
+    close(master);
+    close(slave);
+}
+
+TEST(SerialPortEventLoop, IOPorts)
+{
+    // A pty stands in for the device: what the far end writes shows up in the port's queue,
+    // read by the I/O thread of this very process.
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(grantpt(master), 0);
+    ASSERT_EQ(unlockpt(master), 0);
+    const std::string device = ptsname(master);
+
+    std::string name = PortUtils::shMemPortNameParser(device, "/"), err;
+    BufferQueue::unlink(name);
+    {
+        SerialPort port(device);
+        ASSERT_EQ(port.connect(), 0);
+        BufferQueue reader(1 << 12, name, err);
+        ASSERT_EQ(err, "");
+
+        ASSERT_EQ(::write(master, "sensor frame", 12), 12);
+        std::vector<char> received;
+        ASSERT_TRUE(reader.read(received, std::chrono::seconds(2)));
+        EXPECT_EQ(std::string(received.begin(), received.end()), "sensor frame");
+
+        // After a hang-up, reads give back what is queued, then 0 instead of blocking.
+        close(master);
+        char rest[32];
+        EXPECT_EQ(std::string(rest, port.read(rest, WAIT_FOREVER)), "sensor frame");
+        EXPECT_EQ(port.read(rest, WAIT_FOREVER), 0u);
+        std::string line;
+        EXPECT_FALSE(port.readUntil(line, '\n', WAIT_FOREVER));
+    }
+    BufferQueue::unlink(name);
+}
+
+TEST(SpscByteRingWrap, IOPorts)
+{
+    SpscByteRing ring(10);
+    EXPECT_EQ(ring.capacity(), 16u);
+
+    // Push the positions near the end, so the next message straddles it.
+    char out[16];
+    ASSERT_EQ(ring.write(std::string_view("0123456789ab")), 12u);
+    ASSERT_EQ(ring.read(std::span<char>(out, 12)), 12u);
+    ASSERT_EQ(ring.write(std::string_view("hello\nworld")), 11u);
+    EXPECT_EQ(ring.find('\n'), 5u);
+    EXPECT_EQ(ring.find('d'), 10u);
+    EXPECT_EQ(ring.find('d', 6), 10u);
+    EXPECT_EQ(ring.find('x'), SpscByteRing::npos);
+
+    // Only what fits goes in.
+    EXPECT_EQ(ring.write(std::string_view("0123456789")), 5u);
+    ASSERT_EQ(ring.read(out), 16u);
+    EXPECT_EQ(std::string(out, 16), "hello\nworld01234");
+
+    // A sleeping reader wakes up on the write.
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ring.write(std::string_view("!"));
+    });
+    EXPECT_TRUE(ring.wait(0, std::chrono::seconds(2)));
+    producer.join();
+    EXPECT_FALSE(ring.wait(1, std::chrono::milliseconds(1)));
+
+    // Once closed, what is left is still read, then waits return at once, for good.
+    ring.close();
+    EXPECT_TRUE(ring.wait(0, WAIT_FOREVER));
+    ASSERT_EQ(ring.read(out), 1u);
+    EXPECT_FALSE(ring.wait(0, WAIT_FOREVER));
+    EXPECT_FALSE(ring.wait(0, WAIT_FOREVER));
+    ring.reopen();
+    EXPECT_FALSE(ring.wait(0, std::chrono::milliseconds(1)));
+}
+
+TEST(SerialPortReadWrite, IOPorts)
+{
+    int master, slave;
+    ASSERT_TRUE(openPty(master, slave));
+    const std::string device = ptsname(master);
+    close(slave);
+
+    std::string name = PortUtils::shMemPortNameParser(device, "/");
+    BufferQueue::unlink(name);
+    {
+        SerialPort port(device);
+        ASSERT_EQ(port.connect(), 0);
+
+        // Commands leave through the I/O thread, coalesced.
+        const char* commands[] = { "AT", "+RATE=115200", "\r\n" };
+        for (const char* command : commands) EXPECT_EQ(port.write((void*)command, strlen(command)), strlen(command));
+        std::string sent;
+        char buffer[4096];
+        struct pollfd ready = { master, POLLIN, 0 };
+        while (sent.size() < 16 && poll(&ready, 1, 2000) > 0) {
+            const ssize_t n = ::read(master, buffer, sizeof(buffer));
+            if (n <= 0) break;
+            sent.append(buffer, size_t(n));
+        }
+        EXPECT_EQ(sent, "AT+RATE=115200\r\n");
+
+        // Lines split across device reads come back whole, the rest stays queued.
+        std::string line;
+        EXPECT_FALSE(port.readUntil(line, '\n'));
+        ASSERT_EQ(::write(master, "OK 1", 4), 4);
+        EXPECT_FALSE(port.readUntil(line, '\n', std::chrono::milliseconds(20)));
+        ASSERT_EQ(::write(master, "\nOK 2\npartial", 13), 13);
+        ASSERT_TRUE(port.readUntil(line, '\n', std::chrono::seconds(2)));
+        EXPECT_EQ(line, "OK 1\n");
+        ASSERT_TRUE(port.readUntil(line, '\n', std::chrono::seconds(2)));
+        EXPECT_EQ(line, "OK 2\n");
+        EXPECT_FALSE(port.readUntil(line, '\n', std::chrono::milliseconds(1)));
+        char rest[16];
+        EXPECT_EQ(std::string(rest, port.read(rest, std::chrono::seconds(1))), "partial");
+
+        // Throughput: a far end streaming as fast as the pty goes, read in place.
+        std::string pattern;
+        for (int i = 0; i < 1 << 22; i++) pattern += char('a' + i % 26);
+        std::thread writer([&]() {
+            for (size_t at = 0; at < pattern.size();) {
+                const ssize_t n = ::write(master, pattern.data() + at, std::min<size_t>(4096, pattern.size() - at));
+                if (n <= 0) break;
+                at += size_t(n);
+            }
+        });
+        std::string received;
+        received.reserve(pattern.size());
+        const auto start = std::chrono::steady_clock::now();
+        while (received.size() < pattern.size()) {
+            const size_t n = port.read(buffer, std::chrono::seconds(2));
+            if (n == 0) break;
+            received.append(buffer, n);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        writer.join();
+        EXPECT_TRUE(received == pattern);
+        EXPECT_EQ(port.getOverruns(), 0u);
+        std::printf("SerialPort over pty: %.1f MB/s\n", double(received.size()) / seconds / 1e6);
+    }
+    BufferQueue::unlink(name);
+    close(master);
+}
+
+TEST(FrameDecoderFramings, IOPorts)
+{
+    std::vector<std::string> frames;
+    auto collect = [&](std::string_view frame) { frames.emplace_back(frame); };
+
+    // Delimited: whole lines come out as views of the input, split ones once complete.
+    {
+        const std::string input = "one\ntwo\nthr";
+        bool inPlace = false;
+        FrameDecoder lines({ .kind = FrameDecoder::Framing::DELIMITER, .maxFrameSize = 8 }, [&](std::string_view frame) {
+            inPlace = frame.data() >= input.data() && frame.data() < input.data() + input.size();
+            frames.emplace_back(frame);
+        });
+        EXPECT_EQ(lines.feed(input), 2u);
+        EXPECT_TRUE(inPlace);
+        EXPECT_EQ(lines.feed(std::string_view("ee\n")), 1u);
+        EXPECT_FALSE(inPlace);
+        // Too long for maxFrameSize, whether seen whole or in pieces.
+        EXPECT_EQ(lines.feed(std::string_view("far too long\nfar too")), 0u);
+        EXPECT_EQ(lines.feed(std::string_view(" long\nok\n")), 1u);
+        EXPECT_EQ(lines.getErrors(), 2u);
+        EXPECT_EQ(frames, (std::vector<std::string>{ "one", "two", "three", "ok" }));
+    }
+
+    // Length prefixed, little endian, fed whole and one byte at a time.
+    {
+        frames.clear();
+        FrameDecoder prefixed({ .kind = FrameDecoder::Framing::LENGTH_PREFIX, .lengthBytes = 2, .bigEndian = false }, collect);
+        const std::string stream = std::string("\x05\x00hello\x00\x00\x03\x00" "abc", 14);
+        EXPECT_EQ(prefixed.feed(stream), 3u);
+        for (char byte : stream) prefixed.feed(std::span<const char>(&byte, 1));
+        EXPECT_EQ(frames, (std::vector<std::string>{ "hello", "", "abc", "hello", "", "abc" }));
+    }
+
+    // Only 1, 2, 4 and 8 byte prefixes: anything else decodes nothing and counts errors.
+    for (uint8_t lengthBytes : { 0, 3, 5, 9 }) {
+        frames.clear();
+        FrameDecoder invalid({ .kind = FrameDecoder::Framing::LENGTH_PREFIX, .lengthBytes = lengthBytes }, collect);
+        EXPECT_FALSE(invalid.isValid());
+        EXPECT_EQ(invalid.feed(std::string_view("\x00\x00\x00\x00\x00\x00\x00\x00\x00\x01x", 11)), 0u);
+        EXPECT_EQ(invalid.getErrors(), 1u);
+        EXPECT_TRUE(frames.empty());
+    }
+    {
+        frames.clear();
+        FrameDecoder wide({ .kind = FrameDecoder::Framing::LENGTH_PREFIX, .lengthBytes = 8 }, collect);
+        EXPECT_TRUE(wide.isValid());
+        EXPECT_EQ(wide.feed(std::string_view("\x00\x00\x00\x00\x00\x00\x00\x02hi", 10)), 1u);
+        EXPECT_EQ(frames, (std::vector<std::string>{ "hi" }));
+    }
+
+    // COBS and SLIP survive payloads full of their own delimiters.
+    std::string payload(600, '\0');
+    for (size_t i = 0; i < payload.size(); i++) payload[i] = char(i % 7 == 0 ? 0 : i);
+    payload += std::string("\xC0\xDB\xDC\xDD", 4);
+    for (FrameDecoder::Framing::Kind kind : { FrameDecoder::Framing::COBS, FrameDecoder::Framing::SLIP }) {
+        frames.clear();
+        std::vector<char> wire;
+        for (int i = 0; i < 3; i++) {
+            if (kind == FrameDecoder::Framing::COBS) FrameDecoder::encodeCobs(payload, wire);
+            else FrameDecoder::encodeSlip(payload, wire);
+        }
+        FrameDecoder decoder({ .kind = kind }, collect);
+        // Split at an arbitrary point, inside the second frame.
+        EXPECT_EQ(decoder.feed(std::span<const char>(wire.data(), 700)), 1u);
+        EXPECT_EQ(decoder.feed(std::span<const char>(wire.data() + 700, wire.size() - 700)), 2u);
+        ASSERT_EQ(frames.size(), 3u);
+        for (const std::string& frame : frames) EXPECT_TRUE(frame == payload);
+        EXPECT_EQ(decoder.getErrors(), 0u);
+    }
+
+    // COBS edge cases: empty payload, and runs of exactly 254 non-zero bytes.
+    std::vector<char> wire;
+    FrameDecoder::encodeCobs(std::string_view(""), wire);
+    EXPECT_EQ(wire, (std::vector<char>{ 1, 0 }));
+    frames.clear();
+    FrameDecoder cobs({ .kind = FrameDecoder::Framing::COBS }, collect);
+    const std::string full(254, 'x');
+    wire.clear();
+    FrameDecoder::encodeCobs(full, wire);
+    FrameDecoder::encodeCobs(full + '\0', wire);
+    cobs.feed(wire);
+    EXPECT_EQ(frames, (std::vector<std::string>{ full, full + '\0' }));
+}
+
+TEST(SerialPortConfig, IOPorts)
+{
+    int master, slave;
+    ASSERT_TRUE(openPty(master, slave));
+    const std::string device = ptsname(master);
+
+    // Standard and custom speeds beyond the old B38400 ceiling.
+    std::string err;
+    PortUtils::Serial::PortConfig config;
+    for (uint32_t rate : { 921600u, 3000000u, 250000u }) {
+        config.nComRate = PortUtils::Serial::BaudRate(rate);
+        ASSERT_TRUE(PortUtils::Serial::applyConfig(slave, config, err)) << err;
+        EXPECT_EQ(PortUtils::Serial::getBaudRate(slave), rate);
+    }
+    config.nComBits = 9;
+    EXPECT_FALSE(PortUtils::Serial::applyConfig(slave, config, err));
+    EXPECT_NE(err, "");
+    close(slave);
+
+    // connect() honors the whole PortConfig.
+    std::string name = PortUtils::shMemPortNameParser(device, "/");
+    BufferQueue::unlink(name);
+    {
+        config = { PortUtils::Serial::BAUD_921600, 7, 2, PortUtils::Serial::Parity::Even };
+        SerialPort port(device, config);
+        ASSERT_EQ(port.connect(), 0);
+
+        slave = open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        ASSERT_GE(slave, 0);
+        struct termios tty;
+        ASSERT_EQ(tcgetattr(slave, &tty), 0);
+        // Ptys force CS8 without parity (recent kernels), stop bits and speed stick.
+        EXPECT_TRUE(tty.c_cflag & CSTOPB);
+        EXPECT_FALSE(tty.c_cflag & PARODD);
+        EXPECT_FALSE(tty.c_lflag & ICANON);
+        EXPECT_FALSE(tty.c_lflag & ECHO);
+        EXPECT_EQ(PortUtils::Serial::getBaudRate(slave), 921600u);
+        close(slave);
+    }
+    BufferQueue::unlink(name);
+    close(master);
+}
+
+TEST(SerialPortConnectAsync, IOPorts)
+{
+    // A rack of devices that print a banner once booted, brought up together.
+    constexpr int PORTS = 8;
+    int masters[PORTS];
+    std::vector<std::unique_ptr<SerialPort>> ports;
+    std::vector<std::string> names;
+    for (int i = 0; i < PORTS; i++) {
+        int slave;
+        ASSERT_TRUE(openPty(masters[i], slave));
+        close(slave);
+        names.push_back(PortUtils::shMemPortNameParser(ptsname(masters[i]), "/"));
+        BufferQueue::unlink(names.back());
+        ports.push_back(std::make_unique<SerialPort>(ptsname(masters[i])));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<int>> ready;
+    for (int i = 0; i < PORTS; i++) {
+        // The last one never boots. Odd ones wait for a banner of two lines.
+        const auto timeout = std::chrono::milliseconds(i == PORTS - 1 ? 100 : 2000);
+        ready.push_back(ports[i]->connectAsync(SerialPort::waitForBanner(i % 2 ? "self test ok\r\nREADY\r\n" : "READY\r\n", timeout)));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    for (int i = 0; i < PORTS - 1; i++) {
+        const std::string boot = "boot rom v1\r\nself test ok\r\nREADY\r\nfirst";
+        ASSERT_EQ(::write(masters[i], boot.data(), boot.size()), ssize_t(boot.size()));
+    }
+    for (int i = 0; i < PORTS; i++) EXPECT_EQ(ready[i].get(), i == PORTS - 1 ? -1 : 0);
+    // No fixed stall: the whole rack is up in a fraction of the old 2 s per port.
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+
+    // What followed the banner is the first thing read.
+    char data[16];
+    EXPECT_EQ(std::string(data, ports[0]->read(data, std::chrono::seconds(1))), "first");
+    // A pty has no modem lines.
+    EXPECT_FALSE(SerialPort::dtrReset(std::chrono::milliseconds(1))(*ports[0]));
+
+    ports.clear();
+    for (int i = 0; i < PORTS; i++) {
+        BufferQueue::unlink(names[i]);
+        close(masters[i]);
+    }
+}
+
+TEST(DeviceManagerHotplug, IOPorts)
+{
+    // A fake /dev: links to ptys come and go like USB adapters.
+    char dir[] = "/tmp/devXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    const std::string devices(dir);
+    int masters[2], slave;
+    for (int& master : masters) {
+        ASSERT_TRUE(openPty(master, slave));
+        close(slave);
+    }
+    for (const char* name : { "/ttyFAKE0", "/ttyFAKE1", "/ttyFAKE9" }) BufferQueue::unlink(name);
+    ASSERT_EQ(symlink(ptsname(masters[0]), (devices + "/ttyFAKE0").c_str()), 0);
+
+    std::mutex lock;
+    std::vector<DeviceManager::Event> events;
+    const auto seen = [&](DeviceManager::Event::Type type, const std::string& name) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto& event : events)
+            if (event.type == type && event.path == devices + "/" + name) return true;
+        return false;
+    };
+    {
+        DeviceManager::Options options;
+        options.directory = devices;
+        options.prefixes = { "ttyFAKE" };
+        DeviceManager manager(options);
+        manager.subscribe([&](const DeviceManager::Event& event) {
+            std::lock_guard<std::mutex> guard(lock);
+            events.push_back(event);
+        });
+        std::string err;
+        ASSERT_TRUE(manager.start(err)) << err;
+
+        // There before start(), then plugged in.
+        EXPECT_TRUE(eventually([&]() { return seen(DeviceManager::Event::READY, "ttyFAKE0"); }));
+        ASSERT_EQ(symlink(ptsname(masters[1]), (devices + "/ttyFAKE1").c_str()), 0);
+        EXPECT_TRUE(eventually([&]() { return seen(DeviceManager::Event::READY, "ttyFAKE1"); }));
+        EXPECT_TRUE(seen(DeviceManager::Event::ADDED, "ttyFAKE1"));
+
+        // Opened and configured: it reads what the device sends.
+        std::shared_ptr<SerialPort> port = manager.getPort(devices + "/ttyFAKE1");
+        ASSERT_NE(port, nullptr);
+        ASSERT_EQ(::write(masters[1], "ping", 4), 4);
+        char data[8];
+        EXPECT_EQ(std::string(data, port->read(data, std::chrono::seconds(1))), "ping");
+        port.reset();
+
+        // Not a tty; not a device at all.
+        std::FILE* file = std::fopen((devices + "/ttyFAKE9").c_str(), "w");
+        ASSERT_NE(file, nullptr);
+        std::fclose(file);
+        std::fclose(std::fopen((devices + "/ttyS0").c_str(), "w"));
+        EXPECT_TRUE(eventually([&]() { return seen(DeviceManager::Event::FAILED, "ttyFAKE9"); }));
+        EXPECT_EQ(manager.getPort(devices + "/ttyFAKE9"), nullptr);
+
+        // Unplugged.
+        ASSERT_EQ(unlink((devices + "/ttyFAKE0").c_str()), 0);
+        EXPECT_TRUE(eventually([&]() { return seen(DeviceManager::Event::REMOVED, "ttyFAKE0"); }));
+        EXPECT_EQ(manager.getPort(devices + "/ttyFAKE0"), nullptr);
+        std::vector<std::string> present = manager.getDevices();
+        std::sort(present.begin(), present.end());
+        EXPECT_EQ(present, std::vector<std::string>({ devices + "/ttyFAKE1", devices + "/ttyFAKE9" }));
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto& event : events) EXPECT_EQ(event.path.find("ttyS0"), std::string::npos);
+    }
+
+    std::filesystem::remove_all(devices);
+    for (const char* name : { "/ttyFAKE0", "/ttyFAKE1", "/ttyFAKE9" }) BufferQueue::unlink(name);
+    for (int master : masters) close(master);
+}
+
+TEST(SerialCaptureReplay, IOPorts)
+{
+    char dir[] = "/tmp/captureXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    const std::string file = std::string(dir) + "/port.cap";
+    std::string err;
+
+    // Records come back as written; a record cut short ends the file.
+    {
+        CaptureWriter writer(file, err);
+        ASSERT_TRUE(writer.isOpen()) << err;
+        EXPECT_TRUE(writer.record(std::string_view("first"), 1000));
+        EXPECT_TRUE(writer.record(std::string_view(""), 2000));
+        EXPECT_TRUE(writer.record(std::string_view("third\n"), 3000));
+        writer.flush();
+        EXPECT_EQ(writer.getRecords(), 3u);
+    }
+    ASSERT_EQ(truncate(file.c_str(), std::filesystem::file_size(file) - 2), 0);
+    {
+        CaptureReader reader(file, err);
+        ASSERT_TRUE(reader.isOpen()) << err;
+        SerialCapture::Record record;
+        ASSERT_TRUE(reader.next(record));
+        EXPECT_EQ(record.timestamp, 1000u);
+        EXPECT_EQ(std::string(record.data.data(), record.data.size()), "first");
+        ASSERT_TRUE(reader.next(record));
+        EXPECT_EQ(record.timestamp, 2000u);
+        EXPECT_TRUE(record.data.empty());
+        EXPECT_FALSE(reader.next(record));
+    }
+    CaptureReader bogus("/proc/self/cmdline", err);
+    EXPECT_FALSE(bogus.isOpen());
+
+    // What a port receives, captured...
+    int master, slave;
+    ASSERT_TRUE(openPty(master, slave));
+    close(slave);
+    const std::string name = PortUtils::shMemPortNameParser(ptsname(master), "/");
+    BufferQueue::unlink(name);
+    const char* chunks[] = { "$GPGGA,1*00\r\n", "$GPGGA,2*00\r\n", "$GPGGA,3*00\r\n" };
+    std::string sent;
+    {
+        SerialPort port(ptsname(master));
+        ASSERT_EQ(port.connect(), 0);
+        ASSERT_TRUE(port.startCapture(file, err)) << err;
+        std::string line;
+        for (const char* chunk : chunks) {
+            ASSERT_EQ(::write(master, chunk, strlen(chunk)), ssize_t(strlen(chunk)));
+            sent += chunk;
+            ASSERT_TRUE(port.readUntil(line, '\n', std::chrono::seconds(1)));
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        }
+        port.stopCapture();
+    }
+    BufferQueue::unlink(name);
+
+    CaptureReader reader(file, err);
+    ASSERT_TRUE(reader.isOpen()) << err;
+    std::string captured;
+    uint64_t first = 0, last = 0;
+    SerialCapture::Record record;
+    while (reader.next(record)) {
+        EXPECT_GE(record.timestamp, last);
+        if (first == 0) first = record.timestamp;
+        last = record.timestamp;
+        captured.append(record.data.data(), record.data.size());
+    }
+    EXPECT_EQ(captured, sent);
+    EXPECT_GE(last - first, 60000000u);
+
+    // ...then played back into the port of the code under test, at its own pace and a
+    // hundred times faster.
+    close(master);
+    for (double speed : { 1.0, 100.0 }) {
+        ASSERT_TRUE(openPty(master, slave));
+        close(slave);
+        const std::string replayName = PortUtils::shMemPortNameParser(ptsname(master), "/");
+        BufferQueue::unlink(replayName);
+        {
+            SerialPort port(ptsname(master));
+            ASSERT_EQ(port.connect(), 0);
+            reader.rewind();
+            const auto start = std::chrono::steady_clock::now();
+            EXPECT_EQ(reader.replay(master, speed, err), int64_t(sent.size())) << err;
+            const auto took = std::chrono::steady_clock::now() - start;
+            if (speed == 1.0) EXPECT_GE(took, std::chrono::nanoseconds(last - first));
+            else EXPECT_LT(took, std::chrono::nanoseconds(last - first));
+
+            std::string replayed;
+            char buffer[256];
+            while (replayed.size() < sent.size()) {
+                const size_t n = port.read(buffer, std::chrono::seconds(1));
+                if (n == 0) break;
+                replayed.append(buffer, n);
+            }
+            EXPECT_EQ(replayed, sent);
+        }
+        BufferQueue::unlink(replayName);
+        close(master);
+    }
+    std::filesystem::remove_all(dir);
+}
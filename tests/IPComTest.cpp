@@ -0,0 +1,541 @@
+#include <include/BufferQueue.hpp>
+#include <include/SeqlockRing.hpp>
+#include <include/LockGuard.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <sys/mman.h>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    struct Sample {
+        uint64_t m_uValue;
+        uint64_t m_arrCopies[15];
+    };
+
+    using SampleRing = SeqlockRing<Sample>;
+
+    Sample makeSample(uint64_t value) {
+        Sample sample;
+        sample.m_uValue = value;
+        for (auto& copy : sample.m_arrCopies) copy = value;
+        return sample;
+    }
+
+    // Anonymous shared mapping: survives fork, no name to clean up.
+    SampleRing* mapRing(uint32_t capacity) {
+        void* memory = mmap(nullptr, SampleRing::segmentSize(capacity), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        return memory == MAP_FAILED ? nullptr : new(memory) SampleRing(capacity);
+    }
+
+    void unmapRing(SampleRing* ring, uint32_t capacity) {
+        ring->~SampleRing();
+        munmap(ring, SampleRing::segmentSize(capacity));
+    }
+}
+
+TEST(SeqlockRingOrder, IPCom)
+{
+    SampleRing* ring = mapRing(8);
+    ASSERT_NE(ring, nullptr);
+
+    SampleRing::Cursor first, second;
+    Sample out;
+    EXPECT_FALSE(ring->tryRead(first, out));
+
+    for (uint64_t i = 0; i < 5; i++) ring->write(makeSample(i));
+
+    // Every reader sees every message, in order.
+    for (uint64_t i = 0; i < 5; i++) {
+        ASSERT_TRUE(ring->tryRead(first, out));
+        EXPECT_EQ(out.m_uValue, i);
+    }
+    EXPECT_FALSE(ring->tryRead(first, out));
+    for (uint64_t i = 0; i < 5; i++) {
+        ASSERT_TRUE(ring->tryRead(second, out));
+        EXPECT_EQ(out.m_uValue, i);
+    }
+    EXPECT_EQ(first.m_uDropped, 0u);
+    unmapRing(ring, 8);
+}
+
+TEST(SeqlockRingLapped, IPCom)
+{
+    SampleRing* ring = mapRing(4);
+    ASSERT_NE(ring, nullptr);
+
+    // The writer never blocks: a slow reader skips to the oldest message still held.
+    SampleRing::Cursor cursor;
+    for (uint64_t i = 0; i < 10; i++) ring->write(makeSample(i));
+
+    Sample out;
+    ASSERT_TRUE(ring->tryRead(cursor, out));
+    EXPECT_EQ(out.m_uValue, 6u);
+    EXPECT_EQ(cursor.m_uDropped, 6u);
+    for (uint64_t i = 7; i < 10; i++) {
+        ASSERT_TRUE(ring->tryRead(cursor, out));
+        EXPECT_EQ(out.m_uValue, i);
+    }
+    EXPECT_FALSE(ring->tryRead(cursor, out));
+    unmapRing(ring, 4);
+}
+
+TEST(SeqlockRingCrossProcess, IPCom)
+{
+    // A small ring and a writer in another process force laps and torn copies; every
+    // message handed out must still be whole and strictly increasing.
+    constexpr uint32_t capacity = 4;
+    constexpr uint64_t messages = 200000;
+    SampleRing* ring = mapRing(capacity);
+    ASSERT_NE(ring, nullptr);
+
+    pid_t writer = fork();
+    ASSERT_GE(writer, 0);
+    if (writer == 0) {
+        for (uint64_t i = 1; i <= messages; i++) ring->write(makeSample(i));
+        _exit(0);
+    }
+
+    SampleRing::Cursor cursor;
+    Sample out;
+    uint64_t last = 0, received = 0;
+    bool writerDone = false;
+    while (last < messages) {
+        if (!ring->tryRead(cursor, out)) {
+            // Checked before the final read attempt, so nothing written is missed.
+            if (writerDone) break;
+            writerDone = waitpid(writer, nullptr, WNOHANG) == writer;
+            continue;
+        }
+        for (uint64_t copy : out.m_arrCopies) ASSERT_EQ(copy, out.m_uValue);
+        ASSERT_GT(out.m_uValue, last);
+        last = out.m_uValue;
+        received++;
+    }
+    if (!writerDone) waitpid(writer, nullptr, 0);
+
+    EXPECT_EQ(last, messages);
+    EXPECT_EQ(received + cursor.m_uDropped, messages);
+    unmapRing(ring, capacity);
+}
+
+namespace
+{
+    SharedBufferQueue* mapQueue(size_t capacity) {
+        void* memory = mmap(nullptr, SharedBufferQueue::segmentSize(capacity), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        return memory == MAP_FAILED ? nullptr : new(memory) SharedBufferQueue(capacity);
+    }
+
+    // Message i is i % 251 + 1 bytes, every byte equal to (char)i: tears are visible.
+    std::string patterned(uint64_t i) { return std::string(i % 251 + 1, static_cast<char>(i)); }
+}
+
+TEST(ByteRingVariableRecords, IPCom)
+{
+    SharedBufferQueue* queue = mapQueue(1024);
+    ASSERT_NE(queue, nullptr);
+    EXPECT_EQ(queue->getCapacity(), 1024u);
+    EXPECT_FALSE(queue->write(std::string(queue->getMaxMessageSize() + 1, 'x').data(), queue->getMaxMessageSize() + 1));
+
+    // Several laps of odd-sized records exercise the wrap padding; a reader that keeps up
+    // sees everything, byte for byte.
+    SharedBufferQueue::Cursor cursor;
+    std::vector<char> message;
+    for (uint64_t i = 0; i < 300; i++) {
+        std::string sent = patterned(i);
+        ASSERT_TRUE(queue->write(sent.data(), sent.size()));
+        ASSERT_TRUE(queue->tryRead(cursor, message));
+        EXPECT_EQ(std::string(message.begin(), message.end()), sent);
+        EXPECT_FALSE(queue->tryRead(cursor, message));
+    }
+    EXPECT_EQ(cursor.m_uDropped, 0u);
+    munmap(queue, SharedBufferQueue::segmentSize(1024));
+}
+
+TEST(ByteRingLapped, IPCom)
+{
+    SharedBufferQueue* queue = mapQueue(1024);
+    ASSERT_NE(queue, nullptr);
+
+    // 100 records of 64 bytes (48 payload) cannot all fit: the reader resumes at the tail.
+    SharedBufferQueue::Cursor cursor;
+    const std::string payload(48, 'p');
+    for (int i = 0; i < 100; i++) queue->write(payload.data(), payload.size());
+
+    std::vector<char> message;
+    uint64_t received = 0;
+    while (queue->tryRead(cursor, message)) {
+        EXPECT_EQ(message.size(), payload.size());
+        received++;
+    }
+    EXPECT_EQ(received, 1024u / 64u);
+    EXPECT_EQ(received + cursor.m_uDropped, 100u);
+    munmap(queue, SharedBufferQueue::segmentSize(1024));
+}
+
+TEST(ByteRingCrossProcess, IPCom)
+{
+    constexpr size_t capacity = 4096;
+    constexpr uint64_t messages = 100000;
+    SharedBufferQueue* queue = mapQueue(capacity);
+    ASSERT_NE(queue, nullptr);
+
+    pid_t writer = fork();
+    ASSERT_GE(writer, 0);
+    if (writer == 0) {
+        for (uint64_t i = 0; i < messages; i++) {
+            std::string sent = patterned(i);
+            queue->write(sent.data(), sent.size());
+        }
+        _exit(0);
+    }
+
+    SharedBufferQueue::Cursor cursor;
+    std::vector<char> message;
+    uint64_t received = 0;
+    bool writerDone = false;
+    for (;;) {
+        if (!queue->tryRead(cursor, message)) {
+            if (writerDone) break;
+            writerDone = waitpid(writer, nullptr, WNOHANG) == writer;
+            continue;
+        }
+        const uint64_t seq = cursor.m_uNextSeq - 1;
+        ASSERT_EQ(std::string(message.begin(), message.end()), patterned(seq));
+        received++;
+    }
+
+    EXPECT_EQ(cursor.m_uNextSeq, messages);
+    EXPECT_EQ(received + cursor.m_uDropped, messages);
+    munmap(queue, SharedBufferQueue::segmentSize(capacity));
+}
+
+TEST(ByteRingZeroCopy, IPCom)
+{
+    SharedBufferQueue* queue = mapQueue(1024);
+    ASSERT_NE(queue, nullptr);
+
+    // Reserve the worst case, commit what was produced.
+    std::span<char> room = queue->reserve(200);
+    ASSERT_EQ(room.size(), 200u);
+    std::memcpy(room.data(), "in place", 8);
+    EXPECT_TRUE(queue->commit(8));
+    EXPECT_FALSE(queue->commit(8));
+
+    SharedBufferQueue::Cursor cursor;
+    std::span<const char> record = queue->peek(cursor);
+    EXPECT_EQ(std::string(record.begin(), record.end()), "in place");
+    EXPECT_EQ(record.data(), room.data());
+    EXPECT_TRUE(queue->release(cursor));
+    EXPECT_TRUE(queue->peek(cursor).empty());
+
+    // A record the writer overwrites while the reader holds it is reported torn.
+    queue->write("held", 4);
+    record = queue->peek(cursor);
+    EXPECT_EQ(record.size(), 4u);
+    const std::string filler(100, 'f');
+    for (int i = 0; i < 20; i++) queue->write(filler.data(), filler.size());
+    EXPECT_FALSE(queue->release(cursor));
+
+    std::vector<char> message;
+    ASSERT_TRUE(queue->tryRead(cursor, message));
+    EXPECT_EQ(std::string(message.begin(), message.end()), filler);
+    EXPECT_GT(cursor.m_uDropped, 0u);
+    munmap(queue, SharedBufferQueue::segmentSize(1024));
+}
+
+TEST(ByteRingBlockingRead, IPCom)
+{
+    SharedBufferQueue* queue = mapQueue(4096);
+    ASSERT_NE(queue, nullptr);
+    SharedBufferQueue::Cursor cursor;
+    AdaptiveSpin spin;
+
+    // Nothing published: the wait times out instead of returning early.
+    const auto begin = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue->wait(cursor, std::chrono::milliseconds(20), spin));
+    EXPECT_GE(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(20));
+
+    // A reader asleep on the futex is woken by a writer in another process.
+    pid_t writer = fork();
+    ASSERT_GE(writer, 0);
+    if (writer == 0) {
+        usleep(50000);
+        queue->write("wake", 4);
+        _exit(0);
+    }
+    EXPECT_TRUE(queue->wait(cursor, WAIT_FOREVER, spin));
+    std::vector<char> message;
+    ASSERT_TRUE(queue->tryRead(cursor, message));
+    EXPECT_EQ(std::string(message.begin(), message.end()), "wake");
+    waitpid(writer, nullptr, 0);
+    munmap(queue, SharedBufferQueue::segmentSize(4096));
+}
+
+TEST(ByteRingBatches, IPCom)
+{
+    SharedBufferQueue* queue = mapQueue(1024);
+    ASSERT_NE(queue, nullptr);
+
+    // 20 records fit in one claim; 300 take several and lap a reader that waits.
+    std::vector<std::string> sent;
+    for (uint64_t i = 0; i < 300; i++) sent.push_back(patterned(i % 40));
+    std::vector<std::string_view> views(sent.begin(), sent.end());
+
+    SharedBufferQueue::Cursor cursor;
+    std::vector<std::vector<char>> batch;
+    EXPECT_EQ(queue->writeBatch(std::span(views).first(20)), 20u);
+    ASSERT_EQ(queue->readBatch(cursor, batch, 8), 8u);
+    ASSERT_EQ(queue->readBatch(cursor, batch, 100), 12u);
+    for (size_t i = 0; i < batch.size(); i++) EXPECT_EQ(std::string(batch[i].begin(), batch[i].end()), sent[8 + i]);
+    EXPECT_EQ(queue->readBatch(cursor, batch, 100), 0u);
+
+    EXPECT_EQ(queue->writeBatch(views), views.size());
+    const size_t count = queue->readBatch(cursor, batch, 1000);
+    ASSERT_GT(count, 0u);
+    EXPECT_EQ(count + cursor.m_uDropped, views.size());
+    for (size_t i = 0; i < count; i++) {
+        const uint64_t seq = cursor.m_uNextSeq - count + i;
+        EXPECT_EQ(std::string(batch[i].begin(), batch[i].end()), sent[seq - 20]);
+    }
+
+    // An oversized record ends the batch, the ones before it are published.
+    const std::string tooBig(queue->getMaxMessageSize() + 1, 'x');
+    const std::string_view mixed[] = { "a", "b", tooBig, "c" };
+    EXPECT_EQ(queue->writeBatch(mixed), 2u);
+    ASSERT_EQ(queue->readBatch(cursor, batch, 10), 2u);
+    EXPECT_EQ(std::string(batch[1].begin(), batch[1].end()), "b");
+    munmap(queue, SharedBufferQueue::segmentSize(1024));
+}
+
+TEST(ByteRingConsumerSlots, IPCom)
+{
+    SharedBufferQueue* queue = mapQueue(1024);
+    ASSERT_NE(queue, nullptr);
+
+    SharedBufferQueue::Cursor fast, slow, anonymous;
+    ASSERT_TRUE(queue->registerConsumer(fast));
+    ASSERT_TRUE(queue->registerConsumer(slow));
+    EXPECT_NE(fast.m_iSlot, slow.m_iSlot);
+
+    // 48-byte payloads make 64-byte records, 16 fit. Without backpressure the writer laps
+    // the slow reader and its slot shows the loss.
+    const std::string payload(48, 'p');
+    std::vector<char> message;
+    for (int i = 0; i < 40; i++) {
+        ASSERT_TRUE(queue->write(payload.data(), payload.size()));
+        ASSERT_TRUE(queue->tryRead(fast, message));
+    }
+    while (queue->tryRead(slow, message)) {}
+
+    std::vector<SharedBufferQueue::ConsumerStats> stats = queue->getConsumerStats();
+    ASSERT_EQ(stats.size(), 2u);
+    for (const auto& consumer : stats) {
+        EXPECT_EQ(consumer.m_uLag, 0u);
+        if (consumer.m_uSlot == static_cast<uint32_t>(fast.m_iSlot)) {
+            EXPECT_EQ(consumer.m_uReceived, 40u);
+            EXPECT_EQ(consumer.m_uDropped, 0u);
+            EXPECT_EQ(consumer.m_uHighWater, 64u);
+        } else {
+            EXPECT_EQ(consumer.m_uReceived, 16u);
+            EXPECT_EQ(consumer.m_uDropped, 24u);
+            EXPECT_EQ(consumer.m_uHighWater, 1024u);
+        }
+    }
+
+    // With backpressure the writer stops when the slowest registered reader would be
+    // lapped; anonymous readers do not hold it back.
+    for (int i = 0; i < 16; i++) ASSERT_TRUE(queue->write(payload.data(), payload.size(), std::chrono::milliseconds(0)));
+    EXPECT_FALSE(queue->write(payload.data(), payload.size(), std::chrono::milliseconds(10)));
+    queue->unregisterConsumer(fast);
+    ASSERT_TRUE(queue->tryRead(slow, message));
+    EXPECT_TRUE(queue->write(payload.data(), payload.size(), std::chrono::milliseconds(0)));
+    EXPECT_EQ(slow.m_uDropped, 24u);
+
+    // A producer blocked on a reader in another process resumes when that reader moves.
+    pid_t consumer = fork();
+    ASSERT_GE(consumer, 0);
+    if (consumer == 0) {
+        usleep(50000);
+        std::vector<char> received;
+        queue->tryRead(slow, received);
+        _exit(0);
+    }
+    EXPECT_TRUE(queue->write(payload.data(), payload.size(), WAIT_FOREVER));
+    waitpid(consumer, nullptr, 0);
+    queue->unregisterConsumer(slow);
+    EXPECT_TRUE(queue->getConsumerStats().empty());
+    munmap(queue, SharedBufferQueue::segmentSize(1024));
+}
+
+TEST(ByteRingReaderCrash, IPCom)
+{
+    // Registered readers that die mid-read, or stop reading without dying, must not wedge a
+    // producer that waits for its slowest consumer, nor cost the survivor any message.
+    constexpr uint64_t messages = 20000;
+    SharedBufferQueue* queue = mapQueue(4096);
+    ASSERT_NE(queue, nullptr);
+    queue->setLeaseTimeout(std::chrono::milliseconds(50));
+    auto* ready = new(mmap(nullptr, sizeof(std::atomic<unsigned>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0)) std::atomic<unsigned>(0);
+
+    auto spawn = [&](auto&& body) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            SharedBufferQueue::Cursor cursor;
+            queue->registerConsumer(cursor);
+            ready->fetch_add(1);
+            _exit(body(cursor));
+        }
+        return pid;
+    };
+    auto holdRecords = [&](SharedBufferQueue::Cursor& cursor) {
+        for (;;) {
+            if (queue->peek(cursor).empty()) sched_yield();
+            else queue->release(cursor);
+        }
+        return 0;
+    };
+    pid_t victims[] = { spawn(holdRecords), spawn(holdRecords) };
+    pid_t stalled = spawn([](SharedBufferQueue::Cursor&) { pause(); return 0; });
+    pid_t survivor = spawn([&](SharedBufferQueue::Cursor& cursor) {
+        std::vector<char> message;
+        uint64_t received = 0;
+        while (received < messages) {
+            if (queue->tryRead(cursor, message)) received++;
+            else sched_yield();
+        }
+        return cursor.m_uDropped == 0 ? 0 : 1;
+    });
+    while (ready->load() != 4) usleep(100);
+
+    const std::string payload(100, 'p');
+    for (uint64_t i = 0; i < messages; i++) {
+        if (i == messages / 4 || i == messages / 2) {
+            pid_t victim = victims[i == messages / 2];
+            kill(victim, SIGKILL);
+            waitpid(victim, nullptr, 0);
+        }
+        ASSERT_TRUE(queue->write(payload.data(), payload.size(), std::chrono::seconds(5)));
+    }
+
+    int status = 0;
+    waitpid(survivor, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    kill(stalled, SIGKILL);
+    waitpid(stalled, nullptr, 0);
+    EXPECT_EQ(queue->getEvictedConsumers(), 3u);
+
+    // The dead survivor's slot goes to the next reader once the table is full.
+    std::vector<SharedBufferQueue::Cursor> cursors(SharedBufferQueue::MAX_CONSUMERS);
+    for (auto& cursor : cursors) EXPECT_TRUE(queue->registerConsumer(cursor));
+    munmap(ready, sizeof(std::atomic<unsigned>));
+    munmap(queue, SharedBufferQueue::segmentSize(4096));
+}
+
+TEST(BufferQueueRoundTrip, IPCom)
+{
+    std::string name = "/voxel_test_bq_" + std::to_string(getpid());
+    std::string err;
+    {
+        BufferQueue queue(4096, name, err);
+        ASSERT_EQ(err, "");
+
+        std::vector<char> received;
+        EXPECT_FALSE(queue.try_read(received));
+        EXPECT_FALSE(queue.read(received, std::chrono::milliseconds(1)));
+        EXPECT_TRUE(queue.write("serial bytes"));
+        ASSERT_TRUE(queue.read(received));
+        EXPECT_EQ(std::string(received.begin(), received.end()), "serial bytes");
+        EXPECT_FALSE(queue.try_read(received));
+
+        std::span<char> room = queue.reserve(64);
+        std::memcpy(room.data(), "zero copy", 9);
+        EXPECT_TRUE(queue.commit(9));
+        std::span<const char> record = queue.peek();
+        EXPECT_EQ(std::string(record.begin(), record.end()), "zero copy");
+        EXPECT_TRUE(queue.release());
+    }
+    BufferQueue::unlink(name);
+}
+
+TEST(BufferQueueAttach, IPCom)
+{
+    std::string name = "/voxel_test_attach_" + std::to_string(getpid());
+    std::string err;
+    BufferQueue::unlink(name);
+
+    BufferQueue creator(4096, name, err);
+    ASSERT_EQ(err, "");
+    EXPECT_TRUE(creator.isCreator());
+    EXPECT_TRUE(creator.write("before attach"));
+
+    // A late process asking for another size adopts the creator's ring and leaves the
+    // messages already in it alone.
+    pid_t reader = fork();
+    ASSERT_GE(reader, 0);
+    if (reader == 0) {
+        std::string childErr;
+        BufferQueue attached(1 << 16, name, childErr);
+        std::vector<char> received;
+        const bool ok = childErr.empty() && !attached.isCreator() && attached.getMaxMessageSize() == creator.getMaxMessageSize()
+                        && attached.read(received, std::chrono::milliseconds(100))
+                        && std::string(received.begin(), received.end()) == "before attach"
+                        && attached.read(received, std::chrono::seconds(5))
+                        && std::string(received.begin(), received.end()) == "after attach"
+                        && attached.getDropped() == 0;
+        _exit(ok ? 0 : 1);
+    }
+    usleep(20000);
+    EXPECT_TRUE(creator.write("after attach"));
+
+    int status = 0;
+    waitpid(reader, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Once unlinked the next open starts a fresh queue.
+    BufferQueue::unlink(name);
+    BufferQueue fresh(4096, name, err);
+    EXPECT_TRUE(fresh.isCreator());
+    std::vector<char> received;
+    EXPECT_FALSE(fresh.try_read(received));
+    BufferQueue::unlink(name);
+}
+
+TEST(SpinLockContention, IPCom)
+{
+    struct Shared {
+        SpinLock m_lLock;
+        uint64_t m_uCounter;
+    };
+    auto* shared = new(mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0)) Shared{ SpinLock(256), 0 };
+    ASSERT_TRUE(shared->m_lLock.tryLock());
+    EXPECT_FALSE(shared->m_lLock.tryLock());
+    shared->m_lLock.unLock();
+
+    // Threads and processes contend for the same lock; parked waiters must be woken and
+    // no increment lost.
+    constexpr uint64_t ops = 20000;
+    auto work = [&]() {
+        for (uint64_t i = 0; i < ops; i++) {
+            LockGuard guard(shared->m_lLock);
+            shared->m_uCounter++;
+        }
+    };
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        work();
+        _exit(0);
+    }
+    std::thread first(work), second(work);
+    first.join();
+    second.join();
+    waitpid(child, nullptr, 0);
+    EXPECT_EQ(shared->m_uCounter, 3 * ops);
+    munmap(shared, sizeof(Shared));
+}
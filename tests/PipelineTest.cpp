@@ -0,0 +1,210 @@
+#include <include/InferencePipeline.hpp>
+#include <include/SerialPort.hpp>
+#include <include/BufferQueue.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+TEST(InferencePipelineStream, Pipeline)
+{
+    // A sensor streaming 4 float records, length prefixed, over a pty.
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(grantpt(master), 0);
+    ASSERT_EQ(unlockpt(master), 0);
+    const std::string device = ptsname(master);
+    const std::string name = PortUtils::shMemPortNameParser(device, "/");
+    BufferQueue::unlink(name);
+
+    constexpr size_t FEATURES = 4, OUTPUTS = 2, RECORDS = 2000;
+    std::vector<uint_fast64_t> hidden = { 8 };
+    srand(11);
+    DeepNeuralNetwork<float> network(FEATURES, hidden, OUTPUTS);
+
+    std::vector<float> inputs(RECORDS * FEATURES);
+    for (size_t i = 0; i < inputs.size(); i++) inputs[i] = float(i % 97) / 97.0f - 0.5f;
+    std::vector<InferencePipeline::Prediction> predictions;
+    InferencePipeline::Stats stats;
+    {
+        SerialPort port(device);
+        ASSERT_EQ(port.connect(), 0);
+        InferencePipeline::Options options;
+        options.maxBatch = 64;
+        InferencePipeline pipeline(network, FEATURES, OUTPUTS, InferencePipeline::fromSerialPort(port), options);
+        ASSERT_TRUE(pipeline.start());
+
+        std::string stream;
+        for (size_t i = 0; i < RECORDS; i++) {
+            stream += char(0);
+            stream += char(FEATURES * sizeof(float));
+            stream.append(reinterpret_cast<const char*>(&inputs[i * FEATURES]), FEATURES * sizeof(float));
+            // A record of the wrong size halfway through.
+            if (i == RECORDS / 2) stream.append("\x00\x03" "bad", 5);
+        }
+        for (size_t at = 0; at < stream.size();) {
+            const ssize_t n = ::write(master, stream.data() + at, std::min<size_t>(512, stream.size() - at));
+            ASSERT_GT(n, 0);
+            at += size_t(n);
+        }
+
+        InferencePipeline::Prediction prediction;
+        while (predictions.size() < RECORDS && pipeline.nextPrediction(prediction, std::chrono::seconds(2)))
+            predictions.push_back(prediction);
+        pipeline.stop();
+        stats = pipeline.getStats();
+    }
+    BufferQueue::unlink(name);
+    close(master);
+
+    // Every record, in order, predicted as feedForward predicts it alone.
+    ASSERT_EQ(predictions.size(), RECORDS);
+    for (size_t i = 0; i < RECORDS; i++) {
+        EXPECT_EQ(predictions[i].sequence, i);
+        std::vector<float> record(inputs.begin() + long(i * FEATURES), inputs.begin() + long((i + 1) * FEATURES));
+        const std::vector<float> expected = network.feedForward(record);
+        ASSERT_EQ(predictions[i].outputs.size(), OUTPUTS);
+        for (size_t j = 0; j < OUTPUTS; j++) EXPECT_NEAR(predictions[i].outputs[j], expected[j], 1e-5f);
+        EXPECT_GE(predictions[i].latency.count(), 0);
+    }
+
+    EXPECT_EQ(stats.records, RECORDS);
+    EXPECT_EQ(stats.predictions, RECORDS);
+    EXPECT_EQ(stats.malformed, 1u);
+    EXPECT_EQ(stats.dropped, 0u);
+    EXPECT_GE(stats.batches, 1u);
+    EXPECT_LE(stats.batches, RECORDS);
+    EXPECT_GT(stats.latencyMax.count(), 0);
+    EXPECT_LE(stats.latencyP50, stats.latencyP99);
+    EXPECT_LE(stats.latencyP99, stats.latencyMax);
+}
+
+TEST(InferencePipelineDrops, Pipeline)
+{
+    // Nobody reads the predictions: once their ring is full the rest are dropped, and only
+    // those published are counted as predictions.
+    constexpr size_t FEATURES = 4, OUTPUTS = 2, RECORDS = 200, PER_CALL = 8, DEPTH = 16;
+    std::vector<uint_fast64_t> hidden = { 8 };
+    srand(5);
+    DeepNeuralNetwork<float> network(FEATURES, hidden, OUTPUTS);
+
+    std::string stream;
+    const std::vector<float> record(FEATURES, 0.25f);
+    for (size_t i = 0; i < RECORDS; i++) {
+        stream += char(0);
+        stream += char(FEATURES * sizeof(float));
+        stream.append(reinterpret_cast<const char*>(record.data()), FEATURES * sizeof(float));
+    }
+    const size_t chunk = PER_CALL * (2 + FEATURES * sizeof(float));
+    size_t at = 0;
+    auto source = [&](std::chrono::nanoseconds timeout) {
+        if (at == stream.size()) {
+            std::this_thread::sleep_for(timeout);
+            return std::span<const char>();
+        }
+        const std::span<const char> bytes(stream.data() + at, std::min(chunk, stream.size() - at));
+        at += bytes.size();
+        return bytes;
+    };
+
+    InferencePipeline::Options options;
+    options.queueDepth = DEPTH;
+    InferencePipeline pipeline(network, FEATURES, OUTPUTS, { source }, options);
+    ASSERT_TRUE(pipeline.start());
+    InferencePipeline::Stats stats;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        stats = pipeline.getStats();
+    } while (stats.predictions + stats.dropped < RECORDS && std::chrono::steady_clock::now() < deadline);
+    pipeline.stop();
+    stats = pipeline.getStats();
+
+    size_t published = 0;
+    InferencePipeline::Prediction prediction;
+    while (pipeline.nextPrediction(prediction)) published++;
+    EXPECT_EQ(published, DEPTH);
+    EXPECT_EQ(stats.predictions, published);
+    EXPECT_EQ(stats.predictions + stats.dropped, RECORDS);
+}
+
+TEST(InferencePipelineShape, Pipeline)
+{
+    // Sizes the network does not have would read past its buffers: the pipeline never runs.
+    std::vector<uint_fast64_t> hidden = { 8 };
+    DeepNeuralNetwork<float> network(4, hidden, 2);
+    const InferencePipeline::Source idle = { [](std::chrono::nanoseconds) { return std::span<const char>(); } };
+    InferencePipeline features(network, 5, 2, idle);
+    EXPECT_FALSE(features.start());
+    InferencePipeline outputs(network, 4, 3, idle);
+    EXPECT_FALSE(outputs.start());
+    InferencePipeline::Prediction prediction;
+    EXPECT_FALSE(outputs.nextPrediction(prediction));
+}
+
+TEST(InferencePipelineTornMessage, Pipeline)
+{
+    // A message read in place from shared memory is overwritten while it is decoded: none of
+    // its records may reach the network.
+    constexpr size_t FEATURES = 4, OUTPUTS = 2, RECORDS = 4;
+    std::vector<uint_fast64_t> hidden = { 8 };
+    DeepNeuralNetwork<float> network(FEATURES, hidden, OUTPUTS);
+    auto message = [&](float value) {
+        std::string bytes;
+        const std::vector<float> record(FEATURES, value);
+        for (size_t i = 0; i < RECORDS; i++) {
+            bytes += char(0);
+            bytes += char(FEATURES * sizeof(float));
+            bytes.append(reinterpret_cast<const char*>(record.data()), FEATURES * sizeof(float));
+        }
+        return bytes;
+    };
+
+    std::string name = "/voxel_test_torn_" + std::to_string(getpid()), err;
+    BufferQueue::unlink(name);
+    InferencePipeline::Stats stats;
+    {
+        BufferQueue queue(4096, name, err);
+        ASSERT_EQ(err, "");
+        ASSERT_TRUE(queue.write(message(0.25f)));
+        const InferencePipeline::Source inPlace = InferencePipeline::fromBufferQueue(queue);
+        bool lapped = false;
+        const InferencePipeline::Source source = {
+            [&](std::chrono::nanoseconds timeout) {
+                if (lapped) {
+                    std::this_thread::sleep_for(timeout);
+                    return std::span<const char>();
+                }
+                const std::span<const char> bytes = inPlace.read(timeout);
+                // The writer laps the reader before the decoder is done with the message.
+                const std::string other = message(9.0f);
+                for (int i = 0; i < 200; i++) queue.write(other);
+                lapped = true;
+                return bytes;
+            },
+            inPlace.release
+        };
+        InferencePipeline pipeline(network, FEATURES, OUTPUTS, source);
+        ASSERT_TRUE(pipeline.start());
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        do {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            stats = pipeline.getStats();
+        } while (stats.malformed < RECORDS && std::chrono::steady_clock::now() < deadline);
+        InferencePipeline::Prediction prediction;
+        EXPECT_FALSE(pipeline.nextPrediction(prediction, std::chrono::milliseconds(50)));
+        pipeline.stop();
+        stats = pipeline.getStats();
+    }
+    BufferQueue::unlink(name);
+
+    EXPECT_EQ(stats.records, 0u);
+    EXPECT_EQ(stats.predictions, 0u);
+    EXPECT_EQ(stats.malformed, RECORDS);
+}
@@ -1,5 +1,9 @@
 #include <include/Matrix.hpp>
+#include <include/SparseMatrix.hpp>
+#include <include/NeuralNetwork.hpp>
 #include <gtest/gtest.h>
+#include <type_traits>
+#include <atomic>
 
 TEST(MatrixAllocation, Stack)
 {
@@ -20,20 +24,338 @@ TEST(MatrixVectorStackAllocation, Stack)
 
 TEST(StaticMatrixDotProduct, Operations)
 {
-	voxel::Matrix<float> *src = new voxel::Matrix<float>(2, 2);
-	voxel::Matrix<float> *originalSource = src;
+	voxel::Matrix<float> src(2, 2);
+	float *originalSource = src.getData()[0];
 	voxel::Matrix<float> aOperand(2, 3);
 	voxel::Matrix<float> bOperand(3, 2);
+	aOperand.randomize();
+	bOperand.randomize();
 
-	voxel::Matrix<float>::dot(src, &aOperand, &bOperand);
-	voxel::Matrix<float> *newSoruce = src;
-	EXPECT_TRUE(originalSource == newSoruce);
+	voxel::Matrix<float>::dot(src, aOperand, bOperand);
+	EXPECT_TRUE(originalSource == src.getData()[0]);
 
-	voxel::Matrix<float> *stdMul = voxel::Matrix<float>::dot(&aOperand, &bOperand);
-	float **stdMulData = stdMul->getData();
+	voxel::Matrix<float> stdMul = voxel::Matrix<float>::dot(aOperand, bOperand);
+	float **stdMulData = stdMul.getData();
 
-	src->forEach([&](float data, unsigned row, unsigned column)
-				 { EXPECT_TRUE(data == stdMulData[row][column]); });
+	src.forEach([&](float data, unsigned row, unsigned column)
+				{ EXPECT_TRUE(data == stdMulData[row][column]); });
+}
+
+TEST(MatrixCopy, ValueSemantics)
+{
+	voxel::Matrix<float> original(3, 2);
+	original.randomize();
+
+	voxel::Matrix<float> copy(original);
+	EXPECT_NE(copy.getData()[0], original.getData()[0]);
+	copy.forEach([&](float data, unsigned row, unsigned column)
+				 { EXPECT_EQ(data, original.getData()[row][column]); });
+
+	voxel::Matrix<float> assigned;
+	assigned = original;
+	EXPECT_EQ(assigned.getRows(), 3u);
+	EXPECT_EQ(assigned.getColumns(), 2u);
+	assigned.forEach([&](float data, unsigned row, unsigned column)
+					 { EXPECT_EQ(data, original.getData()[row][column]); });
+}
+
+TEST(MatrixMove, ValueSemantics)
+{
+	static_assert(std::is_nothrow_move_constructible_v<voxel::Matrix<float>>);
+	static_assert(std::is_nothrow_move_assignable_v<voxel::Matrix<float>>);
+
+	voxel::Matrix<float> source(4, 4);
+	float *block = source.getData()[0];
+
+	voxel::Matrix<float> moved(std::move(source));
+	EXPECT_EQ(moved.getData()[0], block);
+	EXPECT_TRUE(source.isEmpty());
+
+	voxel::Matrix<float> assigned;
+	assigned = std::move(moved);
+	EXPECT_EQ(assigned.getData()[0], block);
+	EXPECT_TRUE(moved.isEmpty());
+}
+
+TEST(MatrixTranspose, Operations)
+{
+	voxel::Matrix<float> mat(2, 3);
+	mat.randomize();
+	voxel::Matrix<float> transposed = voxel::Matrix<float>::transpose(mat);
+
+	mat.transpose();
+	EXPECT_EQ(mat.getRows(), 3u);
+	EXPECT_EQ(mat.getColumns(), 2u);
+	mat.forEach([&](float data, unsigned row, unsigned column)
+				{ EXPECT_EQ(data, transposed.getData()[row][column]); });
+}
+
+TEST(MatrixViewSlicing, Views)
+{
+	std::vector<float> block = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+	voxel::ConstMatrixView<float> mat(block.data(), 3, 4);
+
+	voxel::ConstMatrixView<float> row = mat.row(1);
+	EXPECT_EQ(row.getRows(), 1u);
+	EXPECT_EQ(row(0, 2), 7.0f);
+
+	voxel::ConstMatrixView<float> column = mat.column(3);
+	EXPECT_EQ(column.getRows(), 3u);
+	EXPECT_EQ(column(2, 0), 12.0f);
+
+	voxel::ConstMatrixView<float> block2x2 = mat.block(1, 1, 2, 2);
+	EXPECT_FALSE(block2x2.isContiguous());
+	EXPECT_EQ(block2x2(0, 0), 6.0f);
+	EXPECT_EQ(block2x2(1, 1), 11.0f);
+	EXPECT_EQ(block2x2.getData(), block.data() + 5);
+
+	voxel::ConstMatrixView<float> transposed = mat.transposed();
+	EXPECT_EQ(transposed.getRows(), 4u);
+	EXPECT_EQ(transposed(3, 0), 4.0f);
+}
+
+TEST(MatrixViewKernels, Views)
+{
+	voxel::Matrix<float> weights(2, 3);
+	weights.randomize();
+	std::vector<float> input = {0.5f, -1.0f, 2.0f};
+
+	voxel::Matrix<float> fromView = voxel::Matrix<float>::dot(weights, input);
+	voxel::Matrix<float> fromCopy = voxel::Matrix<float>::dot(weights, voxel::Matrix<float>(input));
+	fromView.forEach([&](float data, unsigned row, unsigned column)
+					 { EXPECT_FLOAT_EQ(data, fromCopy.getData()[row][column]); });
+
+	// Writes through a mutable view land in the external buffer.
+	std::vector<float> out(2, 0.0f);
+	voxel::Matrix<float>::dot(voxel::MatrixView<float>(out), weights, input);
+	EXPECT_FLOAT_EQ(out[0], fromCopy.getData()[0][0]);
+	EXPECT_FLOAT_EQ(out[1], fromCopy.getData()[1][0]);
+
+	voxel::Matrix<float> transposed = voxel::Matrix<float>::transpose(weights.view().block(0, 1, 2, 2));
+	EXPECT_EQ(transposed.getRows(), 2u);
+	EXPECT_EQ(transposed.getData()[1][0], weights.getData()[0][2]);
+
+	// A column is added to every column; a column of the wrong height changes nothing.
+	voxel::Matrix<float> batch(2, 3);
+	batch.addColumn(std::vector<float>{1.0f, -2.0f});
+	batch.addColumn(std::vector<float>{1.0f, 1.0f, 1.0f});
+	batch.forEach([&](float data, unsigned row, unsigned)
+				  { EXPECT_FLOAT_EQ(data, row == 0 ? 1.0f : -2.0f); });
+}
+
+TEST(ThreadPoolParallelFor, Parallel)
+{
+	voxel::ThreadPool pool(3);
+	std::vector<std::atomic<int>> hits(10000);
+	pool.parallelFor(0, hits.size(), 64, [&](uint_fast64_t begin, uint_fast64_t end)
+					 {
+		for (uint_fast64_t i = begin; i < end; i++)
+			hits[i]++; });
+
+	for (auto &hit : hits)
+		EXPECT_EQ(hit.load(), 1);
+}
+
+TEST(ParallelMatrixKernels, Parallel)
+{
+	// Large enough to cross every PARALLEL_* threshold.
+	voxel::ThreadPool::instance().resize(3);
+	voxel::Matrix<double> a(300, 200);
+	voxel::Matrix<double> b(200, 310);
+	a.randomize();
+	b.randomize();
 
-	delete src;
-}
\ No newline at end of file
+	voxel::Matrix<double> product = voxel::Matrix<double>::dot(a, b);
+	for (unsigned i = 0; i < a.getRows(); i += 37)
+	{
+		for (unsigned j = 0; j < b.getColumns(); j += 41)
+		{
+			double expected = 0;
+			for (unsigned k = 0; k < a.getColumns(); k++)
+				expected += a.getData()[i][k] * b.getData()[k][j];
+			EXPECT_NEAR(product.getData()[i][j], expected, 1e-9);
+		}
+	}
+
+	voxel::Matrix<double> transposed = voxel::Matrix<double>::transpose(product);
+	product.forEach([&](double data, unsigned row, unsigned column)
+					{ EXPECT_EQ(data, transposed.getData()[column][row]); });
+
+	voxel::Matrix<double> doubled(product);
+	doubled.add(product);
+	doubled.forEach([&](double data, unsigned row, unsigned column)
+					{ EXPECT_EQ(data, 2 * product.getData()[row][column]); });
+	voxel::ThreadPool::instance().resize(std::max(1u, std::thread::hardware_concurrency()) - 1);
+}
+
+template <class T>
+static void expectTransposed(voxel::Matrix<T> &source, voxel::Matrix<T> &transposed)
+{
+	ASSERT_EQ(source.getRows(), transposed.getColumns());
+	ASSERT_EQ(source.getColumns(), transposed.getRows());
+	source.forEach([&](T data, unsigned row, unsigned column)
+				   { ASSERT_EQ(data, transposed.getData()[column][row]); });
+}
+
+TEST(BlockedTranspose, Transpose)
+{
+	// Ragged shapes exercise the SIMD tiles and the scalar edges.
+	for (auto shape : {std::pair<unsigned, unsigned>{1, 1}, {3, 5}, {37, 70}, {129, 67}, {300, 257}})
+	{
+		voxel::Matrix<float> fSource(shape.first, shape.second);
+		fSource.randomize();
+		voxel::Matrix<float> fTransposed = voxel::Matrix<float>::transpose(fSource);
+		expectTransposed(fSource, fTransposed);
+
+		voxel::Matrix<double> dSource(shape.first, shape.second);
+		dSource.randomize();
+		voxel::Matrix<double> dTransposed = voxel::Matrix<double>::transpose(dSource);
+		expectTransposed(dSource, dTransposed);
+	}
+}
+
+TEST(InPlaceTranspose, Transpose)
+{
+	for (unsigned n : {1u, 2u, 7u, 32u, 45u, 301u})
+	{
+		voxel::Matrix<float> original(n, n);
+		original.randomize();
+		voxel::Matrix<float> square(original);
+		float *block = square.getData()[0];
+
+		square.transpose();
+		EXPECT_EQ(square.getData()[0], block);
+		expectTransposed(original, square);
+
+		voxel::Matrix<double> dOriginal(n, n);
+		dOriginal.randomize();
+		voxel::Matrix<double> dSquare(dOriginal);
+		dSquare.transpose();
+		expectTransposed(dOriginal, dSquare);
+	}
+}
+
+TEST(SparseMatrixLayouts, Sparse)
+{
+	voxel::Matrix<float> dense(4, 5);
+	dense.getData()[0][1] = 2.0f;
+	dense.getData()[2][0] = -1.0f;
+	dense.getData()[2][4] = 3.0f;
+	dense.getData()[3][3] = 0.5f;
+
+	auto csr = voxel::SparseMatrix<float>::fromDense(dense, voxel::SparseLayout::CSR);
+	auto csc = csr.toLayout(voxel::SparseLayout::CSC);
+	EXPECT_EQ(csr.getNonZeros(), 4u);
+	EXPECT_EQ(csc.getNonZeros(), 4u);
+	EXPECT_EQ(csc.getOffsets().size(), dense.getColumns() + 1);
+
+	voxel::Matrix<float> fromCsr = csr.toDense();
+	voxel::Matrix<float> fromCsc = csc.toDense();
+	dense.forEach([&](float data, unsigned row, unsigned column)
+				  {
+					  EXPECT_EQ(data, fromCsr.getData()[row][column]);
+					  EXPECT_EQ(data, fromCsc.getData()[row][column]); });
+
+	// Malformed arrays keep the shape and drop the entries: offsets going backwards, or an
+	// index past the inner dimension.
+	using Index = voxel::SparseMatrix<float>::Index;
+	voxel::SparseMatrix<float> backwards(2, 3, voxel::SparseLayout::CSR, std::vector<Index>{0, 3, 2}, std::vector<Index>{0, 1}, std::vector<float>{1.0f, 2.0f});
+	voxel::SparseMatrix<float> outside(2, 3, voxel::SparseLayout::CSR, std::vector<Index>{0, 1, 2}, std::vector<Index>{0, 3}, std::vector<float>{1.0f, 2.0f});
+	for (const auto *malformed : {&backwards, &outside})
+	{
+		EXPECT_EQ(malformed->getNonZeros(), 0u);
+		EXPECT_EQ(malformed->getOffsets().size(), 3u);
+		EXPECT_EQ(malformed->toDense().getColumns(), 3u);
+	}
+}
+
+TEST(SparseMatrixKernels, Sparse)
+{
+	// Large enough for the pooled paths, ~95% zeros like the feature vectors.
+	voxel::ThreadPool::instance().resize(3);
+	voxel::Matrix<double> sparseSource(257, 300);
+	voxel::Matrix<double> dense(300, 64);
+	dense.randomize();
+	for (unsigned i = 0; i < sparseSource.getRows(); i++)
+		for (unsigned j = (i * 7) % 20; j < sparseSource.getColumns(); j += 20)
+			sparseSource.getData()[i][j] = 0.01 * (i + j);
+
+	voxel::Matrix<double> expected = voxel::Matrix<double>::dot(sparseSource, dense);
+	for (auto layout : {voxel::SparseLayout::CSR, voxel::SparseLayout::CSC})
+	{
+		auto sparse = voxel::SparseMatrix<double>::fromDense(sparseSource, layout);
+		voxel::Matrix<double> product = voxel::SparseMatrix<double>::dot(sparse, dense);
+		expected.forEach([&](double data, unsigned row, unsigned column)
+						 { EXPECT_NEAR(data, product.getData()[row][column], 1e-9); });
+
+		// Dense x sparse and the transposed accumulate used for weight updates.
+		voxel::Matrix<double> weights(64, 257);
+		weights.randomize();
+		voxel::Matrix<double> left = voxel::Matrix<double>::dot(weights, sparseSource);
+		voxel::Matrix<double> right = voxel::SparseMatrix<double>::dot(weights, sparse);
+		left.forEach([&](double data, unsigned row, unsigned column)
+					 { EXPECT_NEAR(data, right.getData()[row][column], 1e-9); });
+
+		voxel::Matrix<double> gradient(64, 300);
+		gradient.randomize();
+		voxel::Matrix<double> accumulated(weights);
+		voxel::SparseMatrix<double>::dotTransposed(accumulated, gradient, sparse);
+		voxel::Matrix<double> reference(weights);
+		voxel::Matrix<double>::dot(reference, gradient, sparseSource.view().transposed());
+		reference.forEach([&](double data, unsigned row, unsigned column)
+						  { EXPECT_NEAR(data, accumulated.getData()[row][column], 1e-9); });
+	}
+	voxel::ThreadPool::instance().resize(std::max(1u, std::thread::hardware_concurrency()) - 1);
+}
+
+TEST(BatchedFeedForward, Operations)
+{
+	// Samples side by side as columns: each column comes out as it would alone.
+	std::vector<uint_fast64_t> hidden = {6, 5};
+	srand(3);
+	DeepNeuralNetwork<float> net(3, hidden, 2);
+	const std::vector<float> batch = {0.1f, 0.9f, -0.4f,
+									  0.5f, -0.2f, 0.7f,
+									  -0.8f, 0.3f, 0.0f,
+									  0.2f, 0.6f, -0.1f};
+	// Four samples of three features, one per row; transposed they are the columns.
+	voxel::ConstMatrixView<float> samples(batch.data(), 4, 3);
+	const voxel::Matrix<float> outputs(net.feedForward(samples.transposed()));
+	ASSERT_EQ(outputs.getRows(), 2u);
+	ASSERT_EQ(outputs.getColumns(), 4u);
+	for (unsigned sample = 0; sample < 4; sample++)
+	{
+		std::vector<float> alone = net.feedForward(std::vector<float>(batch.begin() + sample * 3, batch.begin() + sample * 3 + 3));
+		for (unsigned i = 0; i < 2; i++)
+			EXPECT_NEAR(outputs.getData()[i][sample], alone[i], 1e-6f);
+	}
+}
+
+TEST(SparseNetworkInputs, Sparse)
+{
+	// Same seed, same initial weights: sparse and dense inputs must train identically.
+	std::vector<float> input(200, 0.0f);
+	input[3] = 1.0f;
+	input[77] = 0.5f;
+	input[150] = -0.25f;
+	std::vector<float> answer = {1.0f, 0.0f};
+	auto sparseInput = voxel::SparseMatrix<float>::fromVector(input);
+	EXPECT_EQ(sparseInput.getNonZeros(), 3u);
+
+	std::vector<uint_fast64_t> hidden = {16, 8};
+	srand(7);
+	DeepNeuralNetwork<float> denseNet(200, hidden, 2);
+	srand(7);
+	DeepNeuralNetwork<float> sparseNet(200, hidden, 2);
+
+	for (int i = 0; i < 20; i++)
+	{
+		denseNet.train(input, answer);
+		sparseNet.train(sparseInput, answer);
+	}
+	std::vector<float> denseOut = denseNet.feedForward(input);
+	voxel::ConstMatrixView<float> sparseOut = sparseNet.feedForward(sparseInput);
+	ASSERT_EQ(sparseOut.getRows(), denseOut.size());
+	for (unsigned i = 0; i < denseOut.size(); i++)
+		EXPECT_NEAR(denseOut[i], sparseOut(i, 0), 1e-5f);
+}